@@ -3,6 +3,8 @@
 
 #include <iostream>
 
+#include "lsfData/LsfEbfIndex.h"
+
 /**
  * @class Ebf
  *
@@ -11,6 +13,10 @@
  * The data is stored as one continuos string of bytes
  * No attempt is made to verify that the data stored is correctly
  * formated ebf.
+ * An EbfIndex of the contributions can be kept with the data; it is
+ * filled by EbfIndexer and dropped whenever the data is replaced.
+ * The buffer is kept when the data is replaced or cleared and only grows,
+ * so an Ebf reused from event to event stops allocating.
  * $Header: /nfs/slac/g/glast/ground/cvs/lsfData/lsfData/Attic/Ebf.h,v 1.1.4.1 2008/06/26 19:22:00 heather Exp $
  */
 
@@ -20,28 +26,50 @@ namespace lsfData {
     public:
         Ebf();
         Ebf(char *newData,unsigned int dataLength);
+        Ebf(const Ebf &other);
         virtual ~Ebf();
 
+        Ebf& operator=(const Ebf &other);
+
         ///Retrieve pointer to the ebf data.
         char *get(unsigned int &dataLength) const;
 
         ///Store the provided ebf pointer in and delete any previous ones
         void set(char *newData, unsigned int dataLength);
 
+        ///Drop the data and the index, keeping the buffer for the next set()
+        void clear() { m_length=0; m_gemSeq=0; m_index.clear(); };
+
+        ///Bytes the buffer can hold without reallocating
+        unsigned int capacity() const { return m_capacity; };
+
         unsigned int getSequence() const { return m_gemSeq; };
         void setSequence(unsigned int seq) { m_gemSeq = seq;  };
 
+        ///Contribution offsets, empty until an EbfIndexer has been run
+        const EbfIndex& index() const { return m_index; };
+        EbfIndex& index() { return m_index; };
+
+        ///Start of an indexed contribution, 0 for no entry
+        const char *contribution(const EbfIndex::Entry *entry) const {
+          return (entry!=NULL && entry->offset < m_length) ? m_data+entry->offset : NULL;
+        };
+
     private:
         ///Pointer to the ebf data
         char *m_data;
         ///Number of bytes that are stored in data pointer
         unsigned int m_length;
+        ///Size of the buffer, at least m_length
+        unsigned int m_capacity;
         ///Save the GEM sequence number
         unsigned int m_gemSeq;
+        ///Where the contributions are in the data
+        EbfIndex m_index;
     };
 
     //inline stuff for client
-    inline Ebf::Ebf(){ m_data=0; m_length=0;}
+    inline Ebf::Ebf(){ m_data=0; m_length=0; m_capacity=0; m_gemSeq=0;}
 
     inline  char *Ebf::get(unsigned int &dataLength) const{
       dataLength=m_length;
@@ -51,9 +79,27 @@ namespace lsfData {
     inline Ebf::Ebf(char *newData, unsigned int dataLength){
       m_data=NULL;
       m_length=0;
+      m_capacity=0;
+      m_gemSeq=0;
       set(newData,dataLength);
     }
 
+    inline Ebf::Ebf(const Ebf &other){
+      m_data=NULL;
+      m_length=0;
+      m_capacity=0;
+      *this=other;
+    }
+
+    inline Ebf& Ebf::operator=(const Ebf &other){
+      if(&other!=this){
+        set(other.m_data,other.m_length);
+        m_gemSeq=other.m_gemSeq;
+        m_index=other.m_index;
+      }
+      return *this;
+    }
+
     inline Ebf::~Ebf(){
       if(m_data!=NULL)
         delete[] m_data;
@@ -61,12 +107,17 @@ namespace lsfData {
 
 
     inline void Ebf::set(char *newData,unsigned int dataLength){
-      if(m_data!=NULL)
-        delete[] m_data;
-      m_data=NULL;
-      m_data=new char[dataLength];
-      memcpy(m_data,newData,dataLength);
+      if(dataLength>m_capacity){
+        if(m_data!=NULL)
+          delete[] m_data;
+        m_data=NULL;
+        m_data=new char[dataLength];
+        m_capacity=dataLength;
+      }
+      if(dataLength>0)
+        memcpy(m_data,newData,dataLength);
       m_length=dataLength;
+      m_index.clear();
     }
 }// namespace
 #endif
@@ -4,6 +4,19 @@
 #include "eventFile/LSEReader.h"
 #include "eventFile/LPA_Handler.h"
 
+#include "lsfData/LsfEventSource.h"
+#include "lsfData/LsfTimeTone.h"
+#include "lsfData/LsfDatagramInfo.h"
+#include "lsfData/LsfRunInfo.h"
+
+#if defined(__GNUC__)
+#define LSFDATA_DEPRECATED __attribute__((deprecated))
+#elif defined(_MSC_VER)
+#define LSFDATA_DEPRECATED __declspec(deprecated)
+#else
+#define LSFDATA_DEPRECATED
+#endif
+
 namespace eventFile {
 
   class LSE_Context;
@@ -15,14 +28,100 @@ namespace lsfData {
   class LsfCcsds;
   class MetaEvent;
   class LciConfiguration;
+  class SequenceMonitor;
+  class ContextObserver;
+
+  /// The timetones LSFReader converted last.  Timetones change once a
+  /// second while events arrive at kHz rates, so most events reuse them.
+  /// A timetone is known by its seconds and flags: the other fields come
+  /// from the same timetone message and cannot change without them.
+  struct TimeToneCache {
+    TimeToneCache() : valid(false) {}
+    bool     valid;
+    TimeTone current;
+    TimeTone previous;
+  };
+
+  /// The datagram, run and MOOT context LSFReader converted last, with the
+  /// raw context values they came from, and the MetaEvent it was last
+  /// written into.  They only change at datagram and run boundaries.
+  struct ContextCache {
+    ContextCache() : valid(false), meta(0) {}
+    struct Raw {
+      int openAction, openReason, crate, mode, closeAction, closeReason;
+      unsigned int datagrams, modeChanges;
+      int platform, origin;
+      unsigned int groundId, startedAt;
+      unsigned int mootKey;
+    };
+    bool         valid;
+    Raw          raw;
+    DatagramInfo datagram;
+    RunInfo      run;
+    unsigned int mootKey;
+    std::string  mootAlias;
+    const MetaEvent* meta;
+  };
 
-  class LSFReader : public eventFile::LSEReader {
+  /// LSFReader converts the records of an EventSource.  It used to derive
+  /// from eventFile::LSEReader and no longer does (see doc/release.notes):
+  /// the header accessors below are forwarded, and any other LSEReader
+  /// member is reached through lseReader().  Code passing an LSFReader as
+  /// an LSEReader& still compiles, through a deprecated conversion that
+  /// throws if the reader has no file; code passing it as an LSEReader*
+  /// must pass lseReader() instead.
+  class LSFReader {
   public:
-    LSFReader( const std::string& filename ) : eventFile::LSEReader( filename ) {};
-    ~LSFReader() {};
+    /// Read an LSF file.  The reader does not touch the calling thread's
+    /// NUMA settings: to keep the thread reading and the buffers it
+    /// allocates on one node, call Numa::bind before constructing it.  Nor
+    /// does it sample where its buffers are; Numa::account on the decoded
+    /// events does that, at the rate the job chooses.
+    LSFReader( const std::string& filename, FileEventSource::Io io = FileEventSource::StandardIo )
+      : m_source( new FileEventSource( filename, io ) ), m_file( static_cast< FileEventSource* >( m_source ) ),
+        m_ownSource(true), m_monitor(0), m_observer(0) {};
+    /// Convert the records of any event source; the reader does not take ownership
+    explicit LSFReader( EventSource* source )
+      : m_source(source), m_file( dynamic_cast< FileEventSource* >( source ) ),
+        m_ownSource(false), m_monitor(0), m_observer(0) {};
+    ~LSFReader() { if ( m_ownSource ) delete m_source; };
 
     bool read( LsfCcsds&, MetaEvent&, eventFile::EBF_Data& );
 
+    /// Read the native records of the next event without converting them,
+    /// false at end of input; decode() converts them later, if wanted
+    bool readRecord( EventRecord& );
+    /// Convert native records as read() does; the EBF is left in the record
+    void decode( const EventRecord&, LsfCcsds&, MetaEvent& );
+
+    EventSource* source() const { return m_source; }
+    /// the LSEReader reading the file, 0 if the source is not a file
+    eventFile::LSEReader* lseReader() const { return m_file; }
+
+    /// Deprecated, use *lseReader(): for code written when LSFReader was an
+    /// LSEReader; throws std::runtime_error if the source is not a file
+    LSFDATA_DEPRECATED operator eventFile::LSEReader&() const;
+
+    // header summary of the source
+    unsigned long long evtcnt() const { return m_source->evtcnt(); }
+    unsigned int runid() const { return m_source->runid(); }
+    unsigned int begSec() const { return m_source->begSec(); }
+    unsigned int endSec() const { return m_source->endSec(); }
+    unsigned long long begGEM() const { return m_source->begGEM(); }
+    unsigned long long endGEM() const { return m_source->endGEM(); }
+    std::pair< unsigned, unsigned > seqErr( int i ) const { return m_source->seqErr( i ); }
+    std::pair< unsigned, unsigned > dfiErr( int i ) const { return m_source->dfiErr( i ); }
+
+    /// Attach a monitor to be updated with every event read (0 to detach).
+    /// The reader does not take ownership.
+    void setMonitor( SequenceMonitor* monitor ) { m_monitor = monitor; }
+    SequenceMonitor* monitor() const { return m_monitor; }
+
+    /// Attach an observer to be told about run, datagram and mode changes
+    /// (0 to detach).  The reader does not take ownership.
+    void setObserver( ContextObserver* observer ) { m_observer = observer; }
+    ContextObserver* observer() const { return m_observer; }
+
     void transferCcsds( const eventFile::LSE_Context&, LsfCcsds& );
     void transferContext( const eventFile::LSE_Context&, MetaEvent& );
     void transferTime( const eventFile::LSE_Context&, const eventFile::LSE_Info&,     MetaEvent& );
@@ -33,6 +132,26 @@ namespace lsfData {
     void transferInfo( const eventFile::LSE_Context&, const eventFile::LCI_TKR_Info&, MetaEvent& );
     void transferKeys( const eventFile::LPA_Keys&, MetaEvent& );
     void transferKeys( const eventFile::LCI_Keys&, MetaEvent& );
+
+  private:
+    // no copies, the source may be owned
+    LSFReader( const LSFReader& );
+    LSFReader& operator=( const LSFReader& );
+
+    void convert( const eventFile::LSE_Context&, eventFile::LSE_Info::InfoType,
+                  const eventFile::LPA_Info&, const eventFile::LCI_ACD_Info&,
+                  const eventFile::LCI_CAL_Info&, const eventFile::LCI_TKR_Info&,
+                  eventFile::LSE_Keys::KeysType,
+                  const eventFile::LPA_Keys&, const eventFile::LCI_Keys&,
+                  LsfCcsds&, MetaEvent& );
+
+    EventSource*     m_source;
+    FileEventSource* m_file;        // m_source, if it is a file
+    bool             m_ownSource;
+    SequenceMonitor* m_monitor;
+    ContextObserver* m_observer;
+    TimeToneCache    m_tones;
+    ContextCache     m_context;
   };
 };
 
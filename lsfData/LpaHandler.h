@@ -11,6 +11,10 @@
 #ifndef LSFDATA_LPAHANDLER_HH
 #define LSFDATA_LPAHANDLER_HH
 
+#include <algorithm>
+
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfProfile.h"
 
 namespace lsfData {
     // forward declaration of sub-classes
@@ -190,12 +194,30 @@ public:
 
     DgnHandler(const DgnHandler &other)  {
           m_handler = other.m_handler;
-          if (other.m_dgn)
+          if (other.m_dgn) {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
               m_dgn = new DgnRsdV0(*(other.m_dgn));
+          }
            else
               m_dgn = 0;
       } 
 
+    /// deep copy, reusing the RSD already held when there is one
+    DgnHandler& operator=(const DgnHandler &other) {
+          if (&other == this) return *this;
+          m_handler = other.m_handler;
+          if (!other.m_dgn) {
+              delete m_dgn;
+              m_dgn = 0;
+          } else if (m_dgn) {
+              *m_dgn = *(other.m_dgn);
+          } else {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
+              m_dgn = new DgnRsdV0(*(other.m_dgn));
+          }
+          return *this;
+      }
+
    // const char*                     typeName() const;
     ~DgnHandler() { 
        if (m_dgn) {
@@ -223,7 +245,10 @@ public:
 
 
     void setStatus(unsigned int status) {
-        if (!m_dgn) m_dgn = new DgnRsdV0;
+        if (!m_dgn) {
+            LSFDATA_PROFILE_ALLOC(RsdAlloc);
+            m_dgn = new DgnRsdV0;
+        }
         m_dgn->setStatus(status);
     }
 
@@ -368,7 +393,8 @@ public:
     GammaHandler():m_gamma(0) { };
     GammaHandler(const GammaHandler &other)  {
           m_handler = other.m_handler;
-          if (other.m_gamma)
+          if (other.m_gamma) {
+            LSFDATA_PROFILE_ALLOC(RsdAlloc);
             switch(m_handler.version()) {
               case 0:
                 m_gamma = new GammaRsdV0(*(other.m_gamma));
@@ -383,14 +409,27 @@ public:
                 m_gamma = new GammaRsdV3(*(other.m_gamma));
                 break;
               default:
-                std:: cout << "No valid version for GammaRsd found, set to NULL"
-                           << std::endl;
+                Diagnostics::report( Diagnostics::UncopiedGammaRsd, m_handler.version() );
                 m_gamma = 0;
             }
-          else 
+          } else 
               m_gamma = 0;
       } 
 
+    /// deep copy, reusing the RSD already held when it has the same version
+    GammaHandler& operator=(const GammaHandler &other) {
+          if (&other == this) return *this;
+          if (m_gamma && other.m_gamma && m_handler.version() == other.m_handler.version()) {
+              m_handler = other.m_handler;
+              *m_gamma = *(other.m_gamma);
+          } else {
+              GammaHandler copy(other);
+              std::swap(m_handler, copy.m_handler);
+              std::swap(m_gamma, copy.m_gamma);
+          }
+          return *this;
+      }
+
     ~GammaHandler() { 
        if (m_gamma) {
            delete m_gamma;
@@ -415,7 +454,8 @@ public:
     }
     void setStatus(unsigned int status, unsigned int stage,
                    unsigned int energyValid, int energyInLeus) {
-            if (!m_gamma)
+            if (!m_gamma) {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
               switch(m_handler.version()) {
               case 0:
                 m_gamma = new GammaRsdV0;
@@ -431,10 +471,10 @@ public:
                 break;
               default:
                 m_gamma = 0;
-                std::cout << "Gamma version invalid, not setting GammaRsd"
-                          << std::endl;
+                Diagnostics::report( Diagnostics::InvalidGammaVersion, m_handler.version() );
                 return;
               }
+            }
             m_gamma->setStatus(status, stage, energyValid, energyInLeus);
         }
 
@@ -506,11 +546,29 @@ public:
 
     HipHandler(const HipHandler &other)  {
           m_handler = other.m_handler;
-          if (other.m_hip)
+          if (other.m_hip) {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
               m_hip = new HipRsdV0(*(other.m_hip));
+          }
           else
               m_hip = 0;
       } 
+
+    /// deep copy, reusing the RSD already held when there is one
+    HipHandler& operator=(const HipHandler &other) {
+          if (&other == this) return *this;
+          m_handler = other.m_handler;
+          if (!other.m_hip) {
+              delete m_hip;
+              m_hip = 0;
+          } else if (m_hip) {
+              *m_hip = *(other.m_hip);
+          } else {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
+              m_hip = new HipRsdV0(*(other.m_hip));
+          }
+          return *this;
+      }
     ~HipHandler() { 
        if (m_hip) {
            delete m_hip;
@@ -534,7 +592,10 @@ public:
     }
 
     void setStatus(unsigned int status) {
-        if (!m_hip) m_hip = new HipRsdV0;
+        if (!m_hip) {
+            LSFDATA_PROFILE_ALLOC(RsdAlloc);
+            m_hip = new HipRsdV0;
+        }
         m_hip->setStatus(status);
     }
     //void setRsd(const HipRsdV0* hip) { m_hip = hip; }
@@ -607,11 +668,29 @@ public:
 
     MipHandler(const MipHandler &other)  {
           m_handler = other.m_handler;
-          if (other.m_mip)
+          if (other.m_mip) {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
               m_mip = new MipRsdV0(*(other.m_mip));
+          }
           else
               m_mip = 0;
       } 
+
+    /// deep copy, reusing the RSD already held when there is one
+    MipHandler& operator=(const MipHandler &other) {
+          if (&other == this) return *this;
+          m_handler = other.m_handler;
+          if (!other.m_mip) {
+              delete m_mip;
+              m_mip = 0;
+          } else if (m_mip) {
+              *m_mip = *(other.m_mip);
+          } else {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
+              m_mip = new MipRsdV0(*(other.m_mip));
+          }
+          return *this;
+      }
     ~MipHandler() { 
        if (m_mip) {
            delete m_mip;
@@ -639,7 +718,10 @@ public:
     const LpaHandler& lpaHandler() const { return m_handler; }
 
     void setStatus(unsigned int status) {
-        if (!m_mip) m_mip = new MipRsdV0;
+        if (!m_mip) {
+            LSFDATA_PROFILE_ALLOC(RsdAlloc);
+            m_mip = new MipRsdV0;
+        }
         m_mip->setStatus(status);
     }
     const MipRsdV0* rsd() const { return m_mip; }
@@ -684,11 +766,29 @@ public:
 
     PassthruHandler(const PassthruHandler &other)  {
           m_handler = other.m_handler;
-          if (other.m_pass)
+          if (other.m_pass) {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
               m_pass = new PassthruRsdV0(*(other.m_pass));
+          }
           else
               m_pass = 0;
       } 
+
+    /// deep copy, reusing the RSD already held when there is one
+    PassthruHandler& operator=(const PassthruHandler &other) {
+          if (&other == this) return *this;
+          m_handler = other.m_handler;
+          if (!other.m_pass) {
+              delete m_pass;
+              m_pass = 0;
+          } else if (m_pass) {
+              *m_pass = *(other.m_pass);
+          } else {
+              LSFDATA_PROFILE_ALLOC(RsdAlloc);
+              m_pass = new PassthruRsdV0(*(other.m_pass));
+          }
+          return *this;
+      }
     ~PassthruHandler() { 
        if (m_pass) {
            delete m_pass;
@@ -712,7 +812,10 @@ public:
     }
 
     void setStatus(unsigned int status) {
-        if (!m_pass) m_pass = new PassthruRsdV0;
+        if (!m_pass) {
+            LSFDATA_PROFILE_ALLOC(RsdAlloc);
+            m_pass = new PassthruRsdV0;
+        }
         m_pass->setStatus(status);
     }
     //void setRsd(const PassthruRsdV0* pass) { m_pass = pass; }
@@ -0,0 +1,150 @@
+#ifndef LSFDATA_ATOMIC_H
+#define LSFDATA_ATOMIC_H 1
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/** @file LsfAtomic.h
+* @brief Word-sized atomic operations for counters shared between threads
+*
+* lsfData still has to build with pre-C++11 compilers, so this wraps the
+* gcc builtins (__atomic where available, __sync otherwise) and the win32
+* Interlocked family.  Only 32-bit quantities and pointers are supported,
+* since those are lock-free on every platform we build for, including i386.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  namespace atomic {
+
+#if defined(__ATOMIC_ACQUIRE)
+
+    /// read a value published by another thread
+    inline unsigned int load( const volatile unsigned int& v ) {
+      return __atomic_load_n( &v, __ATOMIC_ACQUIRE );
+    }
+
+    /// publish a value to other threads
+    inline void store( volatile unsigned int& v, unsigned int x ) {
+      __atomic_store_n( &v, x, __ATOMIC_RELEASE );
+    }
+
+    /// add to a value shared by several writers, returns the new value
+    inline unsigned int add( volatile unsigned int& v, unsigned int d ) {
+      return __atomic_add_fetch( &v, d, __ATOMIC_ACQ_REL );
+    }
+
+    /// replace v by desired if it still holds expected
+    inline bool cas( volatile unsigned int& v, unsigned int expected, unsigned int desired ) {
+      return __atomic_compare_exchange_n( &v, &expected, desired, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+    }
+
+    /// full memory barrier
+    inline void fence() {
+      __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    }
+
+    /// read a pointer published by another thread
+    template< class T > inline T* load( T* const volatile& p ) {
+      return __atomic_load_n( &p, __ATOMIC_ACQUIRE );
+    }
+
+    /// publish a pointer to other threads
+    template< class T > inline void store( T* volatile& p, T* x ) {
+      __atomic_store_n( &p, x, __ATOMIC_RELEASE );
+    }
+
+#elif defined(__GNUC__)
+
+    inline unsigned int load( const volatile unsigned int& v ) {
+      unsigned int x = v;
+      __sync_synchronize();
+      return x;
+    }
+
+    inline void store( volatile unsigned int& v, unsigned int x ) {
+      __sync_synchronize();
+      v = x;
+    }
+
+    inline unsigned int add( volatile unsigned int& v, unsigned int d ) {
+      return __sync_add_and_fetch( &v, d );
+    }
+
+    inline bool cas( volatile unsigned int& v, unsigned int expected, unsigned int desired ) {
+      return __sync_bool_compare_and_swap( &v, expected, desired );
+    }
+
+    inline void fence() {
+      __sync_synchronize();
+    }
+
+    template< class T > inline T* load( T* const volatile& p ) {
+      T* x = p;
+      __sync_synchronize();
+      return x;
+    }
+
+    template< class T > inline void store( T* volatile& p, T* x ) {
+      __sync_synchronize();
+      p = x;
+    }
+
+#elif defined(_WIN32)
+
+    inline unsigned int load( const volatile unsigned int& v ) {
+      unsigned int x = v;
+      MemoryBarrier();
+      return x;
+    }
+
+    inline void store( volatile unsigned int& v, unsigned int x ) {
+      MemoryBarrier();
+      v = x;
+    }
+
+    inline unsigned int add( volatile unsigned int& v, unsigned int d ) {
+      return static_cast< unsigned int >( InterlockedExchangeAdd( reinterpret_cast< volatile LONG* >( &v ),
+                                                                   static_cast< LONG >( d ) ) ) + d;
+    }
+
+    inline bool cas( volatile unsigned int& v, unsigned int expected, unsigned int desired ) {
+      return static_cast< unsigned int >( InterlockedCompareExchange( reinterpret_cast< volatile LONG* >( &v ),
+                                                                      static_cast< LONG >( desired ),
+                                                                      static_cast< LONG >( expected ) ) ) == expected;
+    }
+
+    inline void fence() {
+      MemoryBarrier();
+    }
+
+    template< class T > inline T* load( T* const volatile& p ) {
+      T* x = p;
+      MemoryBarrier();
+      return x;
+    }
+
+    template< class T > inline void store( T* volatile& p, T* x ) {
+      MemoryBarrier();
+      p = x;
+    }
+
+#else
+#error "lsfData/LsfAtomic.h: no atomic primitives for this compiler"
+#endif
+
+    /// increment a counter that has exactly one writer; cheaper than add()
+    /// because it needs no locked instruction
+    inline void bump( volatile unsigned int& v, unsigned int d = 1 ) {
+      store( v, v + d );
+    }
+
+  }
+
+}
+
+#endif    // LSFDATA_ATOMIC_H
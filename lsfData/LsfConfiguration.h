@@ -38,6 +38,12 @@ namespace lsfData {
       return 0;
     }
 
+    /// copy other into this one if they are of the same type, so an
+    /// existing clone can be reused; false if they are not
+    virtual bool assign( const Configuration& /*other*/ ) {
+      return false;
+    }
+
     virtual void clear() {
     }
 
@@ -89,6 +95,13 @@ namespace lsfData {
       return new LpaConfiguration(*this);
     }
 
+    virtual bool assign( const Configuration& other ) {
+      const LpaConfiguration* o = other.castToLpaConfig();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
+
     virtual void clear() {
         m_hardwareKey = 0;
         m_softwareKey = 0;
@@ -475,6 +488,13 @@ namespace lsfData {
 
     virtual Configuration* clone() const { return new LciAcdConfiguration( *this ); };
 
+    virtual bool assign( const Configuration& other ) {
+      const LciAcdConfiguration* o = other.castToLciAcdConfig();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
+
 
     /// What type of configuration is this?
     virtual enums::Lsf::RunType type() const { return enums::Lsf::AcdLCI; }    
@@ -574,11 +594,12 @@ namespace lsfData {
      class CalTrigger {
      public:
 
-        CalTrigger() : m_le(0), m_he(0) {};
+        CalTrigger() : m_le(0), m_lowTrgEna(0), m_he(0), m_highTrgEna(0) {};
         CalTrigger(unsigned short le, unsigned short ITE,
                    unsigned short he, unsigned short hTE) 
         : m_le(le), m_lowTrgEna(ITE), m_he(he), m_highTrgEna(hTE) {};
-        CalTrigger(const CalTrigger& cal) : m_le(cal.le()), m_he(cal.he()) {}
+        CalTrigger(const CalTrigger& cal) : m_le(cal.le()), m_lowTrgEna(cal.lowTrgEna()),
+                                            m_he(cal.he()), m_highTrgEna(cal.highTrgEna()) {}
 
         ~CalTrigger() { }
 
@@ -704,6 +725,13 @@ namespace lsfData {
 
     virtual Configuration* clone() const { return new LciCalConfiguration( *this ); };
 
+    virtual bool assign( const Configuration& other ) {
+      const LciCalConfiguration* o = other.castToLciCalConfig();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
+
     /// What type of configuration is this?
     virtual enums::Lsf::RunType type() const { return enums::Lsf::CalLCI; }    
 
@@ -891,6 +919,13 @@ namespace lsfData {
 
     virtual Configuration* clone() const { return new LciTkrConfiguration( *this ); };
 
+    virtual bool assign( const Configuration& other ) {
+      const LciTkrConfiguration* o = other.castToLciTkrConfig();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
+
     /// What type of configuration is this?
     virtual enums::Lsf::RunType type() const { return enums::Lsf::TkrLCI; }    
 
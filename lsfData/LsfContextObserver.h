@@ -0,0 +1,45 @@
+#ifndef LSFDATA_CONTEXTOBSERVER_H
+#define LSFDATA_CONTEXTOBSERVER_H 1
+
+/** @class ContextObserver
+* @brief Callbacks for run, datagram and mode boundaries seen by an LSFReader
+*
+* The run and datagram parts of the event context only change at run and
+* datagram boundaries.  LSFReader already compares each event's context to
+* the previous one to avoid reconverting it, and tells an attached
+* ContextObserver when something changed, so that consumers do not need
+* their own per-event comparisons.
+*
+* Each hook is called from LSFReader::read, after the MetaEvent has been
+* filled with the new values and before the type-specific information is
+* transferred:
+*  - onNewRun:      the run id, start time, platform or origin changed
+*                   (always called for the first event)
+*  - onNewDatagram: a new run, or the datagram counter changed
+*  - onModeChange:  the mode change counter changed within a run
+*
+* For an event that starts a run the hooks are called in that order.
+* The default implementations do nothing.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class RunInfo;
+  class DatagramInfo;
+
+  class ContextObserver {
+
+  public:
+
+    virtual ~ContextObserver() {}
+
+    virtual void onNewRun( const RunInfo& ) {}
+    virtual void onNewDatagram( const DatagramInfo& ) {}
+    virtual void onModeChange( const DatagramInfo& ) {}
+  };
+
+}
+
+#endif    // LSFDATA_CONTEXTOBSERVER_H
@@ -0,0 +1,117 @@
+#ifndef LSFDATA_DECOMPRESSOR_H
+#define LSFDATA_DECOMPRESSOR_H 1
+
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "lsfData/LsfPayloadCodec.h"
+
+namespace eventFile {
+  class EBF_Data;
+}
+
+/** @class Decompressor
+* @brief Expands compressed event payloads on a pool of worker threads
+*
+* The reading thread push()es each event's payload with its compression
+* level as it is read, and pop()s expanded payloads in the same order.  In
+* between, up to `depth` events are expanded by the worker threads with
+* the application's PayloadCodec.  Payloads with a compression level of
+* zero or less are not compressed and are passed through as they are.
+*
+* Input and output buffers are kept in a ring of `depth` slots and reused,
+* and pop() swaps the expanded payload into the caller's vector, handing
+* the caller's old buffer back to the ring.  In steady state nothing is
+* allocated.
+*
+* push() blocks while `depth` events are waiting to be popped, so a thread
+* that does both must pop before it gets that far ahead (see full()).
+* One thread pushes and one pops, possibly the same.  With zero threads,
+* or on Windows, the payload is expanded in push().
+*
+* Given a NUMA node, the workers run on that node's CPUs only and take new
+* pages from its memory, so the expanded payloads they write land there
+* (see Numa).
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class Decompressor {
+
+  public:
+
+    enum Status { Empty = 0,      ///< nothing was pending
+                  Decompressed,   ///< expanded by the codec
+                  PassedThrough,  ///< not compressed, copied as is
+                  Failed };       ///< the codec rejected the payload; out is empty
+
+    Decompressor( const PayloadCodec& codec, unsigned int threads, unsigned int depth = 256,
+                  int node = -1 );
+    ~Decompressor();
+
+    /// queue a payload for expansion
+    void push( const char* data, unsigned int length, int level );
+    /// queue the payload of an EBF_Data, e.g. with MetaEvent::compressionLevel()
+    void push( const eventFile::EBF_Data& ebf, int level );
+
+    /// wait for the oldest queued payload and swap it into out
+    Status pop( std::vector< char >& out );
+
+    /// payloads pushed but not popped yet
+    unsigned int pending() const;
+    /// true if push() would block
+    inline bool full() const { return pending() >= m_depth; }
+
+    inline unsigned int threads() const { return static_cast< unsigned int >( m_threads.size() ); }
+    inline unsigned int depth() const { return m_depth; }
+
+  private:
+
+    struct Slot {
+      Slot() : level(0), status(Empty), done(false) {}
+      std::vector< char > in;
+      std::vector< char > out;
+      int                 level;
+      Status              status;
+      bool                done;
+    };
+
+    // no copies, threads point back at the pool
+    Decompressor( const Decompressor& );
+    Decompressor& operator=( const Decompressor& );
+
+    void expand( Slot& slot ) const;
+
+    const PayloadCodec&  m_codec;
+    unsigned int         m_depth;
+    int                  m_node;
+    std::vector< Slot* > m_slots;
+
+    // sequence numbers, slot = sequence % depth
+    unsigned long long   m_head;    // oldest not popped
+    unsigned long long   m_claim;   // next to hand to a worker
+    unsigned long long   m_tail;    // next to push
+    bool                 m_quit;
+
+#ifndef _WIN32
+    static void* run( void* arg );
+    void work();
+
+    std::vector< pthread_t > m_threads;
+    mutable pthread_mutex_t  m_mutex;
+    pthread_cond_t           m_work;    // something to expand, or quit
+    pthread_cond_t           m_done;    // a slot has been expanded
+    pthread_cond_t           m_space;   // a slot has been popped
+#else
+    std::vector< int >       m_threads;
+#endif
+  };
+
+}
+
+#endif    // LSFDATA_DECOMPRESSOR_H
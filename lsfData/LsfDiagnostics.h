@@ -0,0 +1,63 @@
+#ifndef LSFDATA_DIAGNOSTICS_H
+#define LSFDATA_DIAGNOSTICS_H 1
+
+#include <iostream>
+
+/** @class Diagnostics
+* @brief Counting, rate-limited sink for decode anomalies
+*
+* Anomalies found while converting events (an unknown GammaRsd version, for
+* instance) used to be written to std::cout with std::endl once per event,
+* which on a corrupt or newer-format file flushes stdout millions of times.
+* They are now reported here instead: every occurrence is counted, but
+* only the first logLimit() occurrences of each class are logged, followed
+* by one line each time the count reaches a power of two.
+*
+* The counters are shared by all readers in the process and can be
+* queried at the end of a job with count() or summary().
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class Diagnostics {
+
+  public:
+
+    enum Anomaly { NoGammaRsd = 0,       // LPA_Handler carried no GammaRsd we know
+                   InvalidGammaVersion,  // GammaHandler::setStatus with unknown version
+                   UncopiedGammaRsd,     // GammaHandler copy of an unknown version
+                   AnomalyCnt };
+
+    /// count one occurrence, logging it if the rate limit allows
+    static void report( Anomaly what, unsigned int version );
+
+    /// number of occurrences since the start of the job (or the last reset)
+    static unsigned int count( Anomaly what );
+
+    /// total number of occurrences of all anomalies
+    static unsigned int total();
+
+    /// zero all the counters
+    static void reset();
+
+    /// number of occurrences of each class logged before throttling (default 10)
+    static void setLogLimit( unsigned int limit );
+    static unsigned int logLimit();
+
+    /// where log lines go, std::cout by default; 0 silences logging.  Log
+    /// lines are written one at a time from any thread, and none is written
+    /// to the old stream once this returns
+    static void setStream( std::ostream* s );
+
+    /// short name of an anomaly class
+    static const char* name( Anomaly what );
+
+    /// write the non-zero counters, one per line
+    static void summary( std::ostream& s );
+  };
+
+}
+
+#endif    // LSFDATA_DIAGNOSTICS_H
@@ -0,0 +1,111 @@
+#ifndef LSFDATA_EBFINDEX_H
+#define LSFDATA_EBFINDEX_H 1
+
+/** @class EbfIndex
+* @brief Offsets of the contributions of an EBF event
+*
+* One entry per contribution: its kind, LATp source, byte offset from the
+* start of the EBF data and length.  Lookups of the GEM, ACD, GLT, OSW or
+* the TEM of a given tower are constant time, so code that needs a single
+* sub-detector can go straight to it instead of iterating the event.
+*
+* The index holds no LDF types.  It is filled in one pass over the event by
+* EbfIndexer (LsfEbfIndexer.h), which needs the LDF iterators, and is kept
+* with the data by Ebf.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class EbfIndex {
+
+  public:
+
+    enum Kind { UDF = 0, OSW, GLT, GEM, ACD, TEM, KindCnt };
+
+    enum { MAX_TOWERS = 16,
+           MAX_ENTRIES = 32 };    // 16 TEMs, GEM, ACD, GLT, OSW and room to spare
+
+    struct Entry {
+      unsigned int  offset;    // bytes from the start of the EBF data
+      unsigned int  length;    // bytes, as the contribution header gives it
+      unsigned char kind;      // a Kind
+      unsigned char source;    // LATp source id
+    };
+
+    EbfIndex() { clear(); }
+
+    /// forget all entries; the index is then not built
+    inline void clear() {
+      m_size = 0;
+      m_built = false;
+      for ( int i=0; i<KindCnt; i++ ) m_kind[i] = NONE;
+      for ( int i=0; i<MAX_TOWERS; i++ ) m_tem[i] = NONE;
+    }
+
+    /// record a contribution; false if the table is full.  For TEMs the
+    /// source is the tower number.
+    inline bool add( Kind kind, unsigned int source, unsigned int offset, unsigned int length ) {
+      if ( m_size >= MAX_ENTRIES || kind >= KindCnt ) return false;
+      Entry& e = m_entries[m_size];
+      e.offset = offset;
+      e.length = length;
+      e.kind = static_cast< unsigned char >( kind );
+      e.source = static_cast< unsigned char >( source );
+      // lookups return the first contribution of a kind
+      if ( m_kind[kind] == NONE ) m_kind[kind] = static_cast< unsigned char >( m_size );
+      if ( kind == TEM && source < MAX_TOWERS && m_tem[source] == NONE ) {
+        m_tem[source] = static_cast< unsigned char >( m_size );
+      }
+      m_size++;
+      return true;
+    }
+
+    /// mark the index as describing the whole event
+    inline void setBuilt( bool built = true ) { m_built = built; }
+
+    /// true once an indexer has been over the event
+    inline bool built() const { return m_built; }
+
+    inline unsigned int size() const { return m_size; }
+    inline const Entry& entry( unsigned int i ) const { return m_entries[i]; }
+
+    /// first contribution of the given kind, 0 if there is none
+    inline const Entry* find( Kind kind ) const {
+      return ( kind < KindCnt && m_kind[kind] != NONE ) ? &m_entries[m_kind[kind]] : 0;
+    }
+
+    inline const Entry* gem() const { return find( GEM ); }
+    inline const Entry* acd() const { return find( ACD ); }
+    inline const Entry* glt() const { return find( GLT ); }
+    inline const Entry* osw() const { return find( OSW ); }
+
+    /// TEM contribution of a tower, 0 if the tower did not contribute
+    inline const Entry* tem( unsigned int tower ) const {
+      return ( tower < MAX_TOWERS && m_tem[tower] != NONE ) ? &m_entries[m_tem[tower]] : 0;
+    }
+
+    /// bit i set if tower i contributed
+    inline unsigned int towers() const {
+      unsigned int mask = 0;
+      for ( unsigned int i=0; i<MAX_TOWERS; i++ ) {
+        if ( m_tem[i] != NONE ) mask |= 1u << i;
+      }
+      return mask;
+    }
+
+  private:
+
+    enum { NONE = 0xFF };
+
+    Entry         m_entries[MAX_ENTRIES];
+    unsigned int  m_size;
+    bool          m_built;
+    unsigned char m_kind[KindCnt];
+    unsigned char m_tem[MAX_TOWERS];
+  };
+
+}
+
+#endif    // LSFDATA_EBFINDEX_H
@@ -0,0 +1,117 @@
+#ifndef LSFDATA_EBFINDEXER_H
+#define LSFDATA_EBFINDEXER_H 1
+
+#include "lsfData/LsfEbfIndex.h"
+#include "lsfData/Ebf.h"
+
+#include "LATp.h"
+#include "EBFevent.h"
+#include "EBFcontribution.h"
+#include "EBFeventIterator.h"
+#include "EBFcontributionIterator.h"
+
+/** @class EbfIndexer
+* @brief Fills an EbfIndex in one pass over an EBF event
+*
+* Walks the contributions with the LDF EBFcontributionIterator and records
+* where each one is, without looking inside any of them: TEMs are not split
+* into their CAL, TKR, diagnostic and error parts, so indexing costs a few
+* reads per contribution.  Contributions the iterator skips (packet errors)
+* are not indexed.
+*
+* This header needs the LDF package, which the lsfData library itself does
+* not link; it is for programs that already use the LDF iterators.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class EbfIndexer : public EBFeventIterator {
+
+  public:
+
+    /// index the EBF events in [data, data+length); false if any error was reported
+    static bool build( const char* data, unsigned int length, EbfIndex& index ) {
+      index.clear();
+      if ( data == 0 || length == 0 ) return false;
+      EbfIndexer indexer( data, index );
+      indexer.iterate( reinterpret_cast< EBFevent* >( const_cast< char* >( data ) ),
+                       reinterpret_cast< EBFevent* >( const_cast< char* >( data + length ) ) );
+      index.setBuilt();
+      return indexer.m_contributions.errors() == 0 && indexer.m_errors == 0;
+    }
+
+    /// index the data held by ebf, keeping the result in ebf.index()
+    static bool build( Ebf& ebf ) {
+      unsigned int length = 0;
+      const char* data = ebf.get( length );
+      return build( data, length, ebf.index() );
+    }
+
+    virtual ~EbfIndexer() {}
+
+    virtual int handleError( EBFevent* /*evt*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+      m_errors++;
+      return code;
+    }
+
+    virtual int process( EBFevent* event ) {
+      m_contributions.iterate( event );
+      return 0;
+    }
+
+  private:
+
+    class Contributions : public EBFcontributionIterator {
+    public:
+      Contributions( const char* base, EbfIndex& index )
+        : EBFcontributionIterator(), m_base( base ), m_index( index ), m_errors( 0 ) {}
+      virtual ~Contributions() {}
+
+      unsigned int errors() const { return m_errors; }
+
+      virtual int handleError( EBFevent* /*event*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+        m_errors++;
+        return code;
+      }
+      virtual int handleError( EBFcontribution* /*contribution*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+        m_errors++;
+        return code;
+      }
+
+      virtual int UDF( EBFevent*, EBFcontribution* c ) { return add( EbfIndex::UDF, c ); }
+      virtual int OSW( EBFevent*, OSWcontribution* c ) { return add( EbfIndex::OSW, c ); }
+      virtual int GLT( EBFevent*, GLTcontribution* c ) { return add( EbfIndex::GLT, c ); }
+      virtual int GEM( EBFevent*, GEMcontribution* c ) { return add( EbfIndex::GEM, c ); }
+      virtual int ACD( EBFevent*, AEMcontribution* c ) { return add( EbfIndex::ACD, c ); }
+      virtual int TEM( EBFevent*, TEMcontribution* c ) { return add( EbfIndex::TEM, c ); }
+
+    private:
+
+      int add( EbfIndex::Kind kind, EBFcontribution* c ) {
+        const unsigned int offset = static_cast< unsigned int >( reinterpret_cast< const char* >( c ) - m_base );
+        // a full table is not an error in the event, later lookups just miss
+        m_index.add( kind, LATPcellHeader::source( c->header() ), offset, c->length() );
+        return 0;
+      }
+
+      const char*       m_base;
+      EbfIndex&         m_index;
+      mutable unsigned  m_errors;
+    };
+
+    EbfIndexer( const char* base, EbfIndex& index )
+      : EBFeventIterator(), m_contributions( base, index ), m_errors( 0 ) {}
+
+    // no copies
+    EbfIndexer( const EbfIndexer& );
+    EbfIndexer& operator=( const EbfIndexer& );
+
+    Contributions    m_contributions;
+    mutable unsigned m_errors;
+  };
+
+}
+
+#endif    // LSFDATA_EBFINDEXER_H
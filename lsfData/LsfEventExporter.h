@@ -0,0 +1,113 @@
+#ifndef LSFDATA_EVENTEXPORTER_H
+#define LSFDATA_EVENTEXPORTER_H 1
+
+#include <string>
+#include <vector>
+
+#include "lsfData/LsfTextBuffer.h"
+
+/** @class EventExporter
+* @brief Streams per-event metadata as JSON Lines or CSV
+*
+* Writes one line per event built from an LsfCcsds and a MetaEvent: the
+* CCSDS header, run, datagram, scalers, time, configuration, keys and the
+* five LPA handlers.  The columns written, and their order, can be chosen
+* by name; by default all are written.  Values that do not apply to an
+* event (the LPA keys of an LCI event, the RSD status of a handler that has
+* none, ...) are written as null in JSON and as an empty CSV field, and so
+* are times that are not finite numbers.
+*
+* Lines are rendered into the caller's TextBuffer, so exporting does not
+* allocate per event.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class LsfCcsds;
+  class MetaEvent;
+
+  class EventExporter {
+
+  public:
+
+    enum Format { JsonLines = 0, Csv };
+
+    enum Column {
+      // CCSDS
+      Scid = 0, Apid, Utc,
+      // RunInfo
+      GroundId, StartTime, Platform, DataOrigin, DataTransferId,
+      // DatagramInfo
+      OpenAction, OpenReason, Crate, Mode, CloseAction, CloseReason, Datagrams, ModeChanges,
+      // GemScalers
+      Elapsed, Livetime, Prescaled, Discarded, Sequence, Deadzone,
+      // Time
+      TimeTicks, HackHacks, HackTicks,
+      CurrentSecs, CurrentHacks, CurrentTicks, CurrentIncomplete, CurrentFlywheeling, CurrentFlags,
+      PreviousSecs, PreviousHacks, PreviousTicks, PreviousIncomplete, PreviousFlywheeling, PreviousFlags,
+      // MetaEvent
+      MootKey, MootAlias, CompressionLevel, CompressedSize,
+      // Configuration
+      RunType, SoftwareKey, HardwareKey, WriteCfg, ReadCfg, Period, CfgFlags,
+      Injected, Threshold, Delay, ChannelSingle, ChannelAll, ChannelLatc,
+      BiasDac, HoldDelay, HitmapDelay, Range, Veto, VetoVernier, HighDiscrim,
+      Uld, FirstRange, CalibGain, HighCalEna, HighRngEna, HighGain, LowCalEna, LowRngEna, LowGain,
+      TriggerLe, LowTrgEna, TriggerHe, HighTrgEna,
+      SplitLow, SplitHigh,
+      // LsfKeys
+      KeysType, LatcMaster, LatcIgnore, Sbs, LpaDb, LciScript,
+      // handlers
+      GammaState, GammaPrescaler, GammaVersion, GammaStatus, GammaStage, GammaEnergyValid, GammaEnergyInLeus,
+      MipState, MipPrescaler, MipVersion, MipStatus,
+      HipState, HipPrescaler, HipVersion, HipStatus,
+      DgnState, DgnPrescaler, DgnVersion, DgnStatus,
+      PassthruState, PassthruPrescaler, PassthruVersion, PassthruStatus,
+      ColumnCnt };
+
+    EventExporter( TextBuffer& out, Format format = JsonLines );
+
+    /// write all columns, in enum order
+    void selectAll();
+
+    /// write the given columns, in the given order
+    void select( const std::vector< Column >& columns );
+
+    /// comma separated column names; false, and nothing changed, if a name is unknown
+    bool select( const std::string& names );
+
+    const std::vector< Column >& columns() const { return m_columns; }
+
+    /// write the CSV header line; nothing for JSON Lines
+    void header();
+
+    /// write one event
+    void write( const LsfCcsds& ccsds, const MetaEvent& meta );
+
+    /// number of events written
+    unsigned long long events() const { return m_events; }
+
+    static const char* columnName( Column column );
+
+    /// look up a column by name
+    static bool column( const std::string& name, Column& column );
+
+  private:
+
+    struct Value;
+    struct Parts;
+
+    static void value( Column column, const Parts& p, Value& v );
+    void emit( const Value& v );
+    void quoted( const std::string& s );
+
+    TextBuffer&           m_out;
+    Format                m_format;
+    std::vector< Column > m_columns;
+    unsigned long long    m_events;
+  };
+
+}
+
+#endif    // LSFDATA_EVENTEXPORTER_H
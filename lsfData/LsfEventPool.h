@@ -0,0 +1,100 @@
+#ifndef LSFDATA_EVENTPOOL_H
+#define LSFDATA_EVENTPOOL_H 1
+
+#include <vector>
+
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+#include "lsfData/Ebf.h"
+
+/** @class EventPool
+* @brief Recycles event objects so that buffering events does not allocate
+*
+* Applications that hold events for a while -- reordering, coincidence
+* windows, look-ahead -- would otherwise construct and destroy a MetaEvent,
+* an LsfCcsds and an Ebf for every event, along with the configuration,
+* keys, handlers and payload buffer hanging off them.  The pool hands out
+* QueuedEvent triples and takes them back, clear()ing them but keeping what
+* they allocated: an Ebf keeps its buffer and a MetaEvent keeps its
+* configuration, keys and handlers aside for the next event of the same
+* type.  Once the pool holds as many events as are in use at the peak, and
+* each has seen the largest payload, events cost nothing on the allocator.
+*
+* Given a NUMA node, the events are created in memory placed on that node
+* (Numa::allocate), a block of them at a time, whichever thread touches
+* them first.
+*
+* The pool owns every event it created; events not released when it is
+* destroyed are deleted with it.  It is not thread safe: to pass events
+* between threads use an EventQueue, which recycles its slots the same way.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  /// One event's worth of lsfData objects, reused from event to event
+  struct QueuedEvent {
+    /// back to the default state, keeping buffers and cloned objects
+    void clear() {
+      ccsds.clear();
+      meta.clear();
+      ebf.clear();
+    }
+
+    LsfCcsds  ccsds;
+    MetaEvent meta;
+    Ebf       ebf;
+  };
+
+  class EventPool {
+
+  public:
+
+    /// start with n events ready, placed on node if it is not -1
+    explicit EventPool( unsigned int n = 0, int node = -1 );
+    ~EventPool();
+
+    /// a cleared event, recycled if one is available
+    QueuedEvent* acquire();
+    /// give an event from acquire() back; it is cleared here
+    void release( QueuedEvent* event );
+
+    /// make sure at least n events are ready to be acquired without
+    /// allocating, creating more if fewer are free
+    void reserve( unsigned int n );
+
+    /// events created so far, in use or not
+    inline unsigned int created() const { return static_cast< unsigned int >( m_all.size() ); }
+    /// events ready to be acquired
+    inline unsigned int available() const { return static_cast< unsigned int >( m_free.size() ); }
+    /// events acquired and not released yet
+    inline unsigned int inUse() const { return created() - available(); }
+    /// the NUMA node the events are placed on, -1 for none
+    inline int node() const { return m_node; }
+
+  private:
+
+    // no copies, the events are owned
+    EventPool( const EventPool& );
+    EventPool& operator=( const EventPool& );
+
+    enum { BLOCK = 64 };   // events per node-local block
+
+    /// create n more events, all free
+    void grow( unsigned int n );
+
+    struct Block {
+      void*  base;
+      size_t size;
+    };
+
+    std::vector< QueuedEvent* > m_all;
+    std::vector< QueuedEvent* > m_free;
+    std::vector< Block >        m_blocks;
+    int                         m_node;
+  };
+
+}
+
+#endif    // LSFDATA_EVENTPOOL_H
@@ -0,0 +1,218 @@
+#ifndef LSFDATA_EVENTQUEUE_H
+#define LSFDATA_EVENTQUEUE_H 1
+
+#include <new>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "lsfData/LsfAtomic.h"
+#include "lsfData/LsfEventPool.h"
+#include "lsfData/LsfNuma.h"
+
+/** @class EventQueue
+* @brief A bounded lock-free queue of reusable event slots between threads
+*
+* The queue owns `capacity` QueuedEvent slots, allocated once.  A producer
+* (typically a thread running an LSFReader) acquire()s a free slot, fills
+* it and publish()es it; a consumer take()s a published slot, works on it
+* and recycle()s it.  Any number of threads may produce and consume.
+*
+* Free and published slots travel through two bounded multi-producer
+* multi-consumer rings (the sequence-numbered cell array of D. Vyukov),
+* where each operation is a single compare-and-swap on a ring index and no
+* lock is ever taken.  Since there are only as many slots as ring cells,
+* pushing never fails.  Backpressure is natural: when consumers fall
+* behind, acquire() waits for a recycled slot.
+*
+* The blocking calls spin briefly, yield the processor for a while, and
+* then park the thread on a condition variable, which publish(), recycle(),
+* cancel() and close() signal when a thread is parked.  Those signals are
+* sent without a barrier, so one can be missed; a parked thread therefore
+* also wakes every millisecond to look again.  On win32 the threads keep
+* yielding instead.
+*
+* After close(), acquire() returns 0 at once, and take() returns 0 once
+* every slot acquired by a producer has been published and taken, so
+* close() may race with producers still filling their last events and
+* consumers still drain them all.  Each slot carries its own in-flight
+* mark, on a cache line of its own, set by acquire() and cleared by
+* publish() or cancel(); take() only looks at the marks once the queue is
+* closed and empty, so producers never share a counter.  A producer that acquires a
+* slot and then has nothing to put in it must give it back with cancel(),
+* or take() waits for it forever.  Slots still held by a thread when the
+* queue is destroyed are deleted with it.
+*
+* Given a NUMA node, the slots and both rings are placed on that node
+* (Numa::allocate), so a reader and its consumers bound there (Numa::bind)
+* share them without crossing the interconnect.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  /// Bounded MPMC ring of pointers; capacity is a power of two below 2^31,
+  /// the cells are placed on node unless it is -1
+  template < class T >
+  class MpmcRing {
+
+  public:
+
+    explicit MpmcRing( unsigned int capacity, int node = -1 )
+      : m_cells( static_cast< Cell* >( Numa::allocate( capacity * sizeof(Cell), node ) ) ),
+        m_mask( capacity - 1 ), m_node(node), m_enqueue(0), m_dequeue(0) {
+      if ( !m_cells ) throw std::bad_alloc();
+      for ( unsigned int i=0; i<capacity; i++ ) {
+        m_cells[i].seq = i;
+        m_cells[i].data = 0;
+      }
+    }
+    ~MpmcRing() { Numa::release( m_cells, ( m_mask + 1 ) * sizeof(Cell), m_node ); }
+
+    /// false if the ring is full
+    bool push( T* x ) {
+      unsigned int pos = atomic::load( m_enqueue );
+      Cell* cell;
+      while ( true ) {
+        cell = &m_cells[ pos & m_mask ];
+        const int dif = static_cast< int >( atomic::load( cell->seq ) - pos );
+        if ( dif == 0 ) {
+          if ( atomic::cas( m_enqueue, pos, pos + 1 ) ) break;
+          pos = atomic::load( m_enqueue );
+        } else if ( dif < 0 ) {
+          return false;
+        } else {
+          pos = atomic::load( m_enqueue );
+        }
+      }
+      cell->data = x;
+      atomic::store( cell->seq, pos + 1 );
+      return true;
+    }
+
+    /// 0 if the ring is empty
+    T* pop() {
+      unsigned int pos = atomic::load( m_dequeue );
+      Cell* cell;
+      while ( true ) {
+        cell = &m_cells[ pos & m_mask ];
+        const int dif = static_cast< int >( atomic::load( cell->seq ) - ( pos + 1 ) );
+        if ( dif == 0 ) {
+          if ( atomic::cas( m_dequeue, pos, pos + 1 ) ) break;
+          pos = atomic::load( m_dequeue );
+        } else if ( dif < 0 ) {
+          return 0;
+        } else {
+          pos = atomic::load( m_dequeue );
+        }
+      }
+      T* x = cell->data;
+      atomic::store( cell->seq, pos + m_mask + 1 );
+      return x;
+    }
+
+  private:
+
+    // no copies, the cells are owned
+    MpmcRing( const MpmcRing& );
+    MpmcRing& operator=( const MpmcRing& );
+
+    struct Cell {
+      volatile unsigned int seq;
+      T*                    data;
+    };
+
+    // keep the two indices on separate cache lines
+    Cell*                 m_cells;
+    unsigned int          m_mask;
+    int                   m_node;
+    char                  m_pad0[64];
+    volatile unsigned int m_enqueue;
+    char                  m_pad1[64];
+    volatile unsigned int m_dequeue;
+    char                  m_pad2[64];
+  };
+
+  class EventQueue {
+
+  public:
+
+    /// capacity is rounded up to a power of two; slots and rings are
+    /// placed on node if it is not -1
+    explicit EventQueue( unsigned int capacity, int node = -1 );
+    ~EventQueue();
+
+    /// a free slot, waiting for one if necessary; 0 after close()
+    QueuedEvent* acquire();
+    /// a free slot, or 0 if there is none right now or after close()
+    QueuedEvent* tryAcquire();
+    /// hand a filled slot to the consumers
+    void publish( QueuedEvent* event );
+    /// give back an acquired slot without publishing it
+    void cancel( QueuedEvent* event );
+
+    /// the next published event, waiting if necessary; 0 once closed and drained
+    QueuedEvent* take();
+    /// the next published event, or 0 if there is none right now
+    QueuedEvent* tryTake();
+    /// give a taken slot back for reuse
+    void recycle( QueuedEvent* event );
+
+    /// no more events will be published
+    void close();
+    inline bool closed() const { return atomic::load( m_closed ) != 0; }
+
+    inline unsigned int capacity() const { return static_cast< unsigned int >( m_slots.size() ); }
+    /// the NUMA node of the slots, -1 for none
+    inline int node() const { return m_node; }
+
+  private:
+
+    // no copies, the slots are owned
+    EventQueue( const EventQueue& );
+    EventQueue& operator=( const EventQueue& );
+
+    static unsigned int roundUp( unsigned int n );
+
+    /// a slot's in-flight mark, alone on its cache line
+    struct Mark {
+      volatile unsigned int acquired;
+      char                  pad[60];
+    };
+    inline Mark& mark( const QueuedEvent* event ) const { return m_marks[ event - m_block ]; }
+
+    /// a free slot, marked as in flight; 0 after close()
+    QueuedEvent* obtain( bool wait );
+    /// true if a producer holds a slot it has not published or cancelled
+    bool inFlight() const;
+
+#ifndef _WIN32
+    /// wait for a signal on cond, for a millisecond at most; whileOpen
+    /// returns at once if the queue is closed
+    void park( volatile unsigned int& parked, pthread_cond_t& cond, bool whileOpen );
+    /// signal cond if a thread is parked on it
+    void wake( volatile unsigned int& parked, pthread_cond_t& cond );
+#endif
+
+    std::vector< QueuedEvent* > m_slots;
+    QueuedEvent*                m_block;      // the slots
+    Mark*                       m_marks;      // one per slot
+    int                         m_node;
+    MpmcRing< QueuedEvent >     m_free;
+    MpmcRing< QueuedEvent >     m_full;
+    volatile unsigned int       m_closed;
+    volatile unsigned int       m_takers;     // consumers parked
+    volatile unsigned int       m_acquirers;  // producers parked
+#ifndef _WIN32
+    pthread_mutex_t             m_mutex;
+    pthread_cond_t              m_published;  // a slot published, or closed
+    pthread_cond_t              m_freed;      // a slot recycled, or closed
+#endif
+  };
+
+}
+
+#endif    // LSFDATA_EVENTQUEUE_H
@@ -0,0 +1,223 @@
+#ifndef LSFDATA_EVENTRANGE_H
+#define LSFDATA_EVENTRANGE_H 1
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "lsfData/LsfEventSource.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+
+/** @class EventRange
+* @brief An input range over the events of an LSFReader
+*
+* Instead of a read() loop with three out-parameters,
+*
+*   lsfData::EventRange events( reader );
+*   events.filter( isLpa ).take( 1000 );
+*   for ( lsfData::EventRange::iterator it = events.begin(); it != events.end(); ++it ) {
+*     const lsfData::EventSlot& e = *it;
+*     ... e.ccsds(), e.meta(), e.ebf() ...
+*   }
+*
+* The range owns the storage the events are read into; a dereferenced
+* iterator refers to it and stays valid until the iterator is advanced.
+* Like the reader underneath, the range is single pass.
+*
+* Adaptors configure the range and return it, so they can be chained:
+*  - filter( RecordPredicate ) looks at the native records before they are
+*    converted; events it rejects are never decoded into lsfData objects.
+*  - filter( EventPredicate ) looks at the converted CCSDS and MetaEvent.
+*  - filter( const EventFilter& ) can do either, or both.
+*  - take( n ) ends the range after n accepted events, without reading
+*    further from the source.
+*  - chunk( n ) iterates over batches of up to n accepted events instead.
+*
+* Filters apply in the order they were added, record filters all before
+* event filters.  Events rejected by a record filter are not seen by the
+* reader's SequenceMonitor or ContextObserver.  Errors from the reader
+* (std::runtime_error) propagate out of begin() and operator++.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class LSFReader;
+
+  /// Storage for one event of an EventRange: the native records and the
+  /// lsfData objects converted from them
+  class EventSlot {
+
+  public:
+
+    EventSlot() {}
+
+    inline const LsfCcsds& ccsds() const { return m_ccsds; }
+    inline const MetaEvent& meta() const { return m_meta; }
+    inline const eventFile::EBF_Data& ebf() const { return m_record.ebf; }
+    inline const EventRecord& record() const { return m_record; }
+
+  private:
+
+    friend class EventRange;
+
+    // slots are reused, never copied
+    EventSlot( const EventSlot& );
+    EventSlot& operator=( const EventSlot& );
+
+    EventRecord m_record;
+    LsfCcsds    m_ccsds;
+    MetaEvent   m_meta;
+  };
+
+  /// A filter for EventRange; the default accepts everything
+  class EventFilter {
+
+  public:
+
+    virtual ~EventFilter() {}
+
+    /// called before the event is decoded
+    virtual bool acceptRecord( const EventRecord& ) const { return true; }
+
+    /// called after the event is decoded
+    virtual bool acceptEvent( const LsfCcsds&, const MetaEvent& ) const { return true; }
+  };
+
+  class EventRange {
+
+  public:
+
+    typedef bool (*RecordPredicate)( const EventRecord& );
+    typedef bool (*EventPredicate)( const LsfCcsds&, const MetaEvent& );
+
+    /// An input iterator over the accepted events
+    class iterator {
+    public:
+      typedef std::input_iterator_tag iterator_category;
+      typedef EventSlot               value_type;
+      typedef std::ptrdiff_t          difference_type;
+      typedef const EventSlot*        pointer;
+      typedef const EventSlot&        reference;
+
+      iterator() : m_range(0) {}
+      inline reference operator*() const { return *m_range->m_slots[0]; }
+      inline pointer operator->() const { return m_range->m_slots[0]; }
+      inline iterator& operator++() { if ( !m_range->next( *m_range->m_slots[0] ) ) m_range = 0; return *this; }
+      inline bool operator==( const iterator& o ) const { return m_range == o.m_range; }
+      inline bool operator!=( const iterator& o ) const { return m_range != o.m_range; }
+    private:
+      friend class EventRange;
+      explicit iterator( EventRange* r ) : m_range(r) {}
+      EventRange* m_range;
+    };
+
+    /// A batch of accepted events, valid until the next batch is read
+    class Chunk {
+    public:
+      inline size_t size() const { return m_size; }
+      inline bool empty() const { return m_size == 0; }
+      inline const EventSlot& operator[]( size_t i ) const { return *m_slots[i]; }
+    private:
+      friend class EventRange;
+      Chunk( EventSlot* const* slots, size_t n ) : m_slots(slots), m_size(n) {}
+      EventSlot* const* m_slots;
+      size_t            m_size;
+    };
+
+    /// An input range over the chunks of an EventRange, see chunk()
+    class ChunkRange {
+    public:
+      class iterator {
+      public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Chunk                   value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef const Chunk*            pointer;
+        typedef const Chunk&            reference;
+
+        iterator() : m_range(0), m_chunk(0,0), m_n(0) {}
+        inline reference operator*() const { return m_chunk; }
+        inline pointer operator->() const { return &m_chunk; }
+        inline iterator& operator++() { fill(); return *this; }
+        inline bool operator==( const iterator& o ) const { return m_range == o.m_range; }
+        inline bool operator!=( const iterator& o ) const { return m_range != o.m_range; }
+      private:
+        friend class ChunkRange;
+        iterator( EventRange* r, size_t n ) : m_range(r), m_chunk(0,0), m_n(n) { fill(); }
+        void fill() {
+          m_chunk = Chunk( &m_range->m_slots[0], m_range->nextChunk( m_n ) );
+          if ( m_chunk.empty() ) m_range = 0;
+        }
+        EventRange* m_range;
+        Chunk       m_chunk;
+        size_t      m_n;
+      };
+
+      inline iterator begin() const { return iterator( m_range, m_n ); }
+      inline iterator end() const { return iterator(); }
+    private:
+      friend class EventRange;
+      ChunkRange( EventRange* r, size_t n ) : m_range(r), m_n(n) {}
+      EventRange* m_range;
+      size_t      m_n;
+    };
+
+    /// events of reader, which must outlive the range
+    explicit EventRange( LSFReader& reader );
+    ~EventRange();
+
+    // adaptors
+    EventRange& filter( RecordPredicate pred );
+    EventRange& filter( EventPredicate pred );
+    /// the filter is not copied and must outlive the range
+    EventRange& filter( const EventFilter& f );
+    EventRange& take( unsigned long long n );
+
+    /// batches of up to n accepted events; n is at least 1
+    ChunkRange chunk( size_t n );
+
+    /// reads the first event on the first call; later calls return an
+    /// iterator to the current event
+    iterator begin();
+    inline iterator end() const { return iterator(); }
+
+    /// events handed out so far
+    inline unsigned long long taken() const { return m_taken; }
+    /// events read from the reader but rejected, decoded or not
+    inline unsigned long long skipped() const { return m_skipped; }
+    /// events rejected before decoding
+    inline unsigned long long skippedRaw() const { return m_skippedRaw; }
+
+  private:
+
+    friend class iterator;
+    friend class ChunkRange;
+    friend class ChunkRange::iterator;
+
+    // not copyable; iterators point back at the range
+    EventRange( const EventRange& );
+    EventRange& operator=( const EventRange& );
+
+    /// read the next accepted event into slot, false at the end
+    bool next( EventSlot& slot );
+    /// read up to n accepted events into the first slots, returns how many
+    size_t nextChunk( size_t n );
+
+    LSFReader&                        m_reader;
+    std::vector< const EventFilter* > m_filters;
+    std::vector< EventFilter* >       m_owned;
+    std::vector< EventSlot* >         m_slots;
+    unsigned long long                m_limit;
+    unsigned long long                m_taken;
+    unsigned long long                m_skipped;
+    unsigned long long                m_skippedRaw;
+    bool                              m_started;
+    bool                              m_done;
+  };
+
+}
+
+#endif    // LSFDATA_EVENTRANGE_H
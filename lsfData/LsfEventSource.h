@@ -0,0 +1,213 @@
+#ifndef LSFDATA_EVENTSOURCE_H
+#define LSFDATA_EVENTSOURCE_H 1
+
+#include <string>
+#include <utility>
+
+#include "eventFile/LSEReader.h"
+#include "eventFile/LSE_Context.h"
+#include "eventFile/LSE_Info.h"
+#include "eventFile/LSE_Keys.h"
+#include "eventFile/EBF_Data.h"
+
+#include "lsfData/LsfReadAhead.h"
+
+/** @class EventSource
+* @brief Source of raw LSE records consumed by LSFReader
+*
+* LSFReader converts the native eventFile records into lsfData objects; an
+* EventSource supplies those records together with the file-header summary.
+* FileEventSource reads them from an LSF file through eventFile::LSEReader,
+* MemoryEventSource replays records already held in memory.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  /// one event's worth of native records
+  struct EventRecord {
+    eventFile::LSE_Context        ctx;
+    eventFile::EBF_Data           ebf;
+    eventFile::LSE_Info::InfoType infotype;
+    eventFile::LPA_Info           pinfo;
+    eventFile::LCI_ACD_Info       ainfo;
+    eventFile::LCI_CAL_Info       cinfo;
+    eventFile::LCI_TKR_Info       tinfo;
+    eventFile::LSE_Keys::KeysType ktype;
+    eventFile::LPA_Keys           pakeys;
+    eventFile::LCI_Keys           cikeys;
+  };
+
+  class EventSource {
+
+  public:
+
+    virtual ~EventSource() {}
+
+    /// fill the native records of the next event, false at end of input
+    virtual bool read( eventFile::LSE_Context&        ctx,
+                       eventFile::EBF_Data&           ebf,
+                       eventFile::LSE_Info::InfoType& infotype,
+                       eventFile::LPA_Info&           pinfo,
+                       eventFile::LCI_ACD_Info&       ainfo,
+                       eventFile::LCI_CAL_Info&       cinfo,
+                       eventFile::LCI_TKR_Info&       tinfo,
+                       eventFile::LSE_Keys::KeysType& ktype,
+                       eventFile::LPA_Keys&           pakeys,
+                       eventFile::LCI_Keys&           cikeys ) = 0;
+
+    /// as above, into one record
+    bool readRecord( EventRecord& rec ) {
+      return read( rec.ctx, rec.ebf, rec.infotype, rec.pinfo, rec.ainfo, rec.cinfo, rec.tinfo,
+                   rec.ktype, rec.pakeys, rec.cikeys );
+    }
+
+    /// true if skip() moves without reading; by default it reads and drops
+    virtual bool canSeek() const { return false; }
+
+    /// pass over the next n events, returns how many were passed (fewer at
+    /// end of input); reads and drops them unless the source can seek
+    virtual unsigned long long skip( unsigned long long n ) {
+      EventRecord rec;
+      unsigned long long i = 0;
+      while ( i < n && readRecord( rec ) ) i++;
+      return i;
+    }
+
+    /// where the next event starts, to give to seek(); -1 if the source
+    /// cannot tell, which is the default
+    virtual long long tell() const { return -1; }
+    /// move to a position given by tell(), false if the source cannot
+    virtual bool seek( long long ) { return false; }
+
+    // header summary; begSec and endSec are whole seconds of CCSDS packet
+    // time (LSE_Context::ccsds.utc, LsfCcsds::getUtc()), as the LSE header
+    // counts them, not event (GEM) time
+    virtual unsigned long long evtcnt() const = 0;
+    virtual unsigned int runid() const = 0;
+    virtual unsigned int begSec() const = 0;
+    virtual unsigned int endSec() const = 0;
+    virtual unsigned long long begGEM() const = 0;
+    virtual unsigned long long endGEM() const = 0;
+
+    /// (apid, count) of sequence / DFI errors for the i-th header slot
+    virtual std::pair< unsigned, unsigned > seqErr( int i ) const = 0;
+    virtual std::pair< unsigned, unsigned > dfiErr( int i ) const = 0;
+  };
+
+  /** @class FileEventSource
+  * @brief EventSource reading an LSF file with eventFile::LSEReader
+  *
+  * With ReadAheadIo a ReadAhead keeps kernel reads in flight ahead of
+  * LSEReader.  StreamingIo is meant for one-pass bulk scans: it keeps two
+  * windows in flight and releases what has been read from the page cache.
+  * Both follow LSEReader's position in the file after every event.  Not
+  * every eventFile release has LSEReader::tell(); it is used only when
+  * LSFDATA_LSE_SEEK is defined.  Otherwise the position is estimated from
+  * the events read, the header's event count and the file size, and kept
+  * a window behind to keep StreamingIo from releasing what LSEReader has
+  * yet to read.  If read-ahead is not available the source quietly falls back
+  * to StandardIo.
+  *
+  * The source cannot skip() without reading, but with LSFDATA_LSE_SEEK it
+  * can tell() and seek() through LSEReader, to positions recorded earlier
+  * (see RunCatalog::Entry).
+  */
+  class FileEventSource : public EventSource, public eventFile::LSEReader {
+
+  public:
+
+    /// how the file is read
+    enum Io { StandardIo = 0,  ///< LSEReader's own reads only
+              ReadAheadIo,     ///< plus asynchronous read-ahead, see ReadAhead
+              StreamingIo      ///< read-ahead two windows deep, dropping behind
+    };
+
+    FileEventSource( const std::string& filename, Io io = StandardIo )
+      : eventFile::LSEReader( filename ), m_io(io), m_readAhead(0), m_events(0) {
+      if ( io == ReadAheadIo ) {
+        m_readAhead = new ReadAhead( filename );
+      } else if ( io == StreamingIo ) {
+        m_readAhead = new ReadAhead( filename, ReadAhead::DEFAULT_WINDOW, 2, true );
+      }
+      if ( m_readAhead ) {
+        if ( !m_readAhead->active() ) {
+          delete m_readAhead;
+          m_readAhead = 0;
+          m_io = StandardIo;
+        }
+      }
+    }
+    virtual ~FileEventSource() { delete m_readAhead; }
+
+    /// the I/O actually in use
+    Io io() const { return m_io; }
+
+    /// the read-ahead, 0 with StandardIo
+    const ReadAhead* readAhead() const { return m_readAhead; }
+
+    virtual bool read( eventFile::LSE_Context&        ctx,
+                       eventFile::EBF_Data&           ebf,
+                       eventFile::LSE_Info::InfoType& infotype,
+                       eventFile::LPA_Info&           pinfo,
+                       eventFile::LCI_ACD_Info&       ainfo,
+                       eventFile::LCI_CAL_Info&       cinfo,
+                       eventFile::LCI_TKR_Info&       tinfo,
+                       eventFile::LSE_Keys::KeysType& ktype,
+                       eventFile::LPA_Keys&           pakeys,
+                       eventFile::LCI_Keys&           cikeys ) {
+      const bool ok = eventFile::LSEReader::read( ctx, ebf, infotype, pinfo, ainfo, cinfo, tinfo,
+                                                  ktype, pakeys, cikeys );
+      if ( ok && m_readAhead ) {
+        m_events++;
+        m_readAhead->advance( position() );
+      }
+      return ok;
+    }
+
+#ifdef LSFDATA_LSE_SEEK
+    virtual long long tell() const { return static_cast< long long >( eventFile::LSEReader::tell() ); }
+    virtual bool seek( long long position ) {
+      if ( position < 0 ) return false;
+      eventFile::LSEReader::seek( static_cast< off_t >( position ) );
+      return true;
+    }
+#endif
+
+    virtual unsigned long long evtcnt() const { return eventFile::LSEReader::evtcnt(); }
+    virtual unsigned int runid() const { return eventFile::LSEReader::runid(); }
+    virtual unsigned int begSec() const { return eventFile::LSEReader::begSec(); }
+    virtual unsigned int endSec() const { return eventFile::LSEReader::endSec(); }
+    virtual unsigned long long begGEM() const { return eventFile::LSEReader::begGEM(); }
+    virtual unsigned long long endGEM() const { return eventFile::LSEReader::endGEM(); }
+    virtual std::pair< unsigned, unsigned > seqErr( int i ) const { return eventFile::LSEReader::seqErr( i ); }
+    virtual std::pair< unsigned, unsigned > dfiErr( int i ) const { return eventFile::LSEReader::dfiErr( i ); }
+
+  private:
+
+    // no copies, the read-ahead is owned
+    FileEventSource( const FileEventSource& );
+    FileEventSource& operator=( const FileEventSource& );
+
+    /// how far LSEReader has got into the file, at most
+    unsigned long long position() const {
+#ifdef LSFDATA_LSE_SEEK
+      return static_cast< unsigned long long >( eventFile::LSEReader::tell() );
+#else
+      const unsigned long long n = eventFile::LSEReader::evtcnt();
+      if ( n == 0 ) return 0;
+      const double at = static_cast< double >( m_readAhead->size() ) * m_events / n;
+      const double behind = at - m_readAhead->window();
+      return behind > 0. ? static_cast< unsigned long long >( behind ) : 0;
+#endif
+    }
+
+    Io                 m_io;
+    ReadAhead*         m_readAhead;
+    unsigned long long m_events;      // read so far
+  };
+
+}
+
+#endif    // LSFDATA_EVENTSOURCE_H
@@ -0,0 +1,138 @@
+#ifndef LSFDATA_EXPOSUREBINNER_H
+#define LSFDATA_EXPOSUREBINNER_H 1
+
+#include <cmath>
+#include <vector>
+
+#include "lsfData/LsfGemScalers.h"
+#include "lsfData/LsfMetaEvent.h"
+
+/** @class ExposureBinner
+* @brief Accumulates livetime and deadtime counts into fixed time bins
+*
+* Events are add()ed in time order with their GEM scalers.  The livetime,
+* elapsed, deadzone and discarded counts gained between two consecutive
+* events are spread over the interval between their times, so a bin
+* boundary falling between the two events splits the counts in
+* proportion.  Livetime and elapsed time are counted in ticks of the
+* 20 MHz LAT clock and kept in seconds; deadzone and discarded are event
+* counts, fractional where an interval was split.
+*
+* The scalers are taken to wrap at 2^bits, so a counter smaller than the
+* one before has rolled over.  An interval whose elapsed count does not
+* agree with the event times to within a second -- scalers reset at a new
+* run, or a jump in the data -- is not binned and is counted in
+* rejected(); restart() does the same explicitly.
+*
+* Bins are held from the earliest to the latest one touched, at most
+* maxBins of them.  An event whose time would stretch them further -- a
+* zero or garbled time among real ones -- is not binned or counted at all,
+* and the interval runs from the event before it to the event after it;
+* such events are counted in outside().  The first event sets where the
+* bins start.
+*
+* Bins are aligned on origin, so binners of the same width and origin can
+* be filled by separate threads or from separate files and merge()d.  A
+* binner only knows the intervals between the events it was given; to
+* lose nothing where the event stream was split, start each part with
+* restart( time, scalers ) of the last event of the part before, which
+* begins the first interval there without counting that event twice.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class ExposureBinner {
+
+  public:
+
+    struct Bin {
+      Bin() : livetime(0.), elapsed(0.), deadzone(0.), discarded(0.), events(0) {}
+      double             livetime;   ///< seconds
+      double             elapsed;    ///< seconds
+      double             deadzone;   ///< events lost in the deadzone
+      double             discarded;  ///< events discarded
+      unsigned long long events;     ///< events with their time in the bin
+    };
+
+    enum { MAX_BINS = 1 << 20 };
+
+    /// bins of width seconds, the first starting at origin, for scalers
+    /// wrapping at 2^bits, and at most maxBins of them
+    ExposureBinner( double width = 30., double origin = 0., unsigned int bits = 64,
+                    unsigned int maxBins = MAX_BINS );
+
+    /// one event, in time order
+    void add( double time, const GemScalers& scalers );
+    /// one event, at Time::met()
+    inline void add( const MetaEvent& meta ) { add( meta.time().met(), meta.scalers() ); }
+
+    /// forget the previous event, so the next one starts a new interval
+    inline void restart() { m_havePrevious = false; }
+    /// start the next interval at an event added elsewhere, without
+    /// binning or counting it here
+    inline void restart( double time, const GemScalers& scalers ) {
+      m_havePrevious = true;
+      m_time = time;
+      m_scalers = scalers;
+    }
+
+    /// add the bins of other; false, with nothing added, if the widths or
+    /// origins differ
+    bool merge( const ExposureBinner& other );
+
+    /// drop all bins and counts
+    void clear();
+
+    /// bins from the earliest to the latest touched, including empty ones between
+    inline size_t size() const { return m_bins.size(); }
+    inline const Bin& operator[]( size_t i ) const { return m_bins[i]; }
+    /// start time of bin i
+    inline double start( size_t i ) const { return m_origin + ( m_first + static_cast< long long >( i ) ) * m_width; }
+
+    /// sum over all bins
+    Bin total() const;
+
+    inline double width() const { return m_width; }
+    inline double origin() const { return m_origin; }
+    /// intervals binned, and those left out as inconsistent
+    inline unsigned long long intervals() const { return m_intervals; }
+    inline unsigned long long rejected() const { return m_rejected; }
+    /// events ignored for lying too far from the bins
+    inline unsigned long long outside() const { return m_outside; }
+
+  private:
+
+    /// index of the bin holding time t, as a double so it cannot overflow
+    inline double index( double t ) const { return std::floor( ( t - m_origin ) / m_width ); }
+    /// index of the bin holding time t
+    inline long long binOf( double t ) const { return static_cast< long long >( index( t ) ); }
+    /// true if the bins with indices a to b can be held with the current ones
+    bool fits( double a, double b ) const;
+    /// the bin with index b, created if needed
+    Bin& bin( long long b );
+    /// counter difference allowing for rollover
+    inline unsigned long long delta( unsigned long long now, unsigned long long before ) const {
+      return ( now - before ) & m_mask;
+    }
+
+    double             m_width;
+    double             m_origin;
+    unsigned long long m_mask;
+    unsigned int       m_maxBins;
+    std::vector< Bin > m_bins;
+    long long          m_first;       // index of m_bins[0]
+
+    bool               m_havePrevious;
+    double             m_time;
+    GemScalers         m_scalers;
+
+    unsigned long long m_intervals;
+    unsigned long long m_rejected;
+    unsigned long long m_outside;
+  };
+
+}
+
+#endif    // LSFDATA_EXPOSUREBINNER_H
@@ -0,0 +1,71 @@
+#ifndef LSFDATA_FORMATTER_H
+#define LSFDATA_FORMATTER_H 1
+
+#include <string>
+
+#include "lsfData/LsfTextBuffer.h"
+#include "lsfData/LsfConfiguration.h"
+
+/** @class Formatter
+* @brief Renders lsfData objects into a TextBuffer
+*
+* Each format() produces exactly the bytes the object's print() writes to
+* stdout, including the quirks of the existing dumps (LpaKeys prints SBS
+* and LPA_DB in bare hex because LsfKeys::print leaves std::cout in hex,
+* the CAL and TKR channel lines carry no prefix), so buffered and printf
+* dumps can be compared byte for byte.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class LsfCcsds;
+  class RunInfo;
+  class DatagramInfo;
+  class GemScalers;
+  class GemTime;
+  class Time;
+  class LsfKeys;
+  class LpaKeys;
+  class LciKeys;
+  class LpaHandler;
+
+  class Formatter {
+
+  public:
+
+    static void format( TextBuffer& b, const LsfCcsds& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const RunInfo& obj );
+    static void format( TextBuffer& b, const DatagramInfo& obj );
+    static void format( TextBuffer& b, const GemScalers& obj );
+    static void format( TextBuffer& b, const GemTime& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const Time& obj );
+
+    /// dispatches on the concrete configuration type, as the virtual print()
+    static void format( TextBuffer& b, const Configuration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LpaConfiguration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciConfiguration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciAcdConfiguration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciCalConfiguration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciTkrConfiguration& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const Channel& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciAcdConfiguration::AcdTrigger& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciCalConfiguration::CalTrigger& obj, const std::string& str = "" );
+
+    /// dispatches on the concrete keys type, as the virtual print()
+    static void format( TextBuffer& b, const LsfKeys& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LpaKeys& obj, const std::string& str = "" );
+    static void format( TextBuffer& b, const LciKeys& obj, const std::string& str = "" );
+
+    static void format( TextBuffer& b, const LpaHandler& obj, const std::string& str = "" );
+
+  private:
+
+    /// "<str> <name> = "
+    static TextBuffer& field( TextBuffer& b, const std::string& str, const char* name );
+  };
+
+}
+
+#endif    // LSFDATA_FORMATTER_H
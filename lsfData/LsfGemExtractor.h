@@ -0,0 +1,206 @@
+#ifndef LSFDATA_GEMEXTRACTOR_H
+#define LSFDATA_GEMEXTRACTOR_H 1
+
+#include "eventFile/EBF_Data.h"
+
+#include "lsfData/LsfGemSummary.h"
+#include "lsfData/LsfEbfIndex.h"
+#include "lsfData/Ebf.h"
+
+#include "eventSummary.h"
+#include "EBFevent.h"
+#include "GEMcontribution.h"
+#include "EBFeventIterator.h"
+#include "EBFcontributionIterator.h"
+
+/** @class GemExtractor
+* @brief Unpacks only the GEM contribution of EBF events
+*
+* Finds the GEM contribution and copies its fields into a GemSummary.  If
+* the event already has an EbfIndex the GEM is looked up there; otherwise
+* the contributions are walked with the LDF iterators only up to the GEM,
+* which normally comes first, and the walk ends there: the handlers of the
+* LDF iterators end the iteration by returning non-zero.  The ACD and TEM
+* contributions are never decoded, which is what makes this much cheaper
+* than a full LATcomponentIterator pass for jobs that only need trigger
+* information.
+*
+* A GEM contribution is only unpacked if all of it, as laid out by
+* GEMcontribution and as long as its header says, lies inside the data,
+* so a truncated payload is reported as having no GEM.
+*
+* Like EbfIndexer this header needs the LDF package.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class GemExtractor {
+
+  public:
+
+    /// unpack the GEM contribution found through index; false if there is
+    /// none or it does not fit in the data
+    static bool extract( const char* data, unsigned int length, const EbfIndex& index, GemSummary& gem ) {
+      gem.clear();
+      const EbfIndex::Entry* e = index.gem();
+      if ( data == 0 || e == 0 || !fits( e->offset, e->length, length ) ) return false;
+      unpack( *reinterpret_cast< GEMcontribution* >( const_cast< char* >( data + e->offset ) ), gem );
+      return true;
+    }
+
+    /// unpack the first GEM contribution in [data, data+length), walking
+    /// the contributions only up to it
+    static bool extract( const char* data, unsigned int length, GemSummary& gem ) {
+      gem.clear();
+      if ( data == 0 || length == 0 ) return false;
+      Finder finder;
+      finder.iterate( reinterpret_cast< EBFevent* >( const_cast< char* >( data ) ),
+                      reinterpret_cast< EBFevent* >( const_cast< char* >( data + length ) ) );
+      GEMcontribution* g = finder.gem();
+      if ( g == 0 ) return false;
+      const char* at = reinterpret_cast< const char* >( g );
+      if ( at < data || !fits( static_cast< unsigned int >( at - data ), g->length(), length ) ) return false;
+      unpack( *g, gem );
+      return true;
+    }
+
+    /// unpack the GEM contribution of an Ebf, through its index if it has one
+    static bool extract( const Ebf& ebf, GemSummary& gem ) {
+      unsigned int length = 0;
+      const char* data = ebf.get( length );
+      if ( ebf.index().built() ) return extract( data, length, ebf.index(), gem );
+      return extract( data, length, gem );
+    }
+
+    /// unpack the GEM contribution of an EBF_Data
+    static bool extract( const eventFile::EBF_Data& ebf, GemSummary& gem ) {
+      return extract( reinterpret_cast< const char* >( ebf.start() ), static_cast< unsigned int >( ebf.size() ), gem );
+    }
+
+    /// unpack n events into gems[0..n); returns how many had a GEM contribution
+    static unsigned int extract( Ebf* const* events, unsigned int n, GemSummary* gems ) {
+      unsigned int found = 0;
+      for ( unsigned int i=0; i<n; i++ ) {
+        if ( events[i] && extract( *events[i], gems[i] ) ) found++;
+        else gems[i].clear();
+      }
+      return found;
+    }
+
+    /// as above for EBF_Data
+    static unsigned int extract( const eventFile::EBF_Data* events, unsigned int n, GemSummary* gems ) {
+      unsigned int found = 0;
+      for ( unsigned int i=0; i<n; i++ ) {
+        if ( extract( events[i], gems[i] ) ) found++;
+      }
+      return found;
+    }
+
+    /// copy the fields of a GEM contribution, as handed out by the LDF iterators
+    static void unpack( GEMcontribution& g, GemSummary& gem ) {
+      gem.roiVector        = g.roiVector();
+      gem.tkrVector        = g.tkrVector();
+      gem.calHEvector      = g.calHEvector();
+      gem.calLEvector      = g.calLEvector();
+      gem.cnoVector        = g.cnoVector();
+      gem.conditionSummary = g.conditionSummary();
+      gem.missed           = g.missed();
+
+      const GEMtileList* tl = g.tileList();
+      gem.tileXZM = tl->XZM();
+      gem.tileXZP = tl->XZP();
+      gem.tileYZM = tl->YZM();
+      gem.tileYZP = tl->YZP();
+      gem.tileXY  = tl->XY();
+      gem.tileRBN = tl->RBN();
+      gem.tileNA  = tl->NA();
+
+      gem.liveTime  = g.liveTime();
+      gem.prescaled = g.prescaled();
+      gem.discarded = g.discarded();
+
+      gem.condArrTime     = g.condArrTime().datum();
+      gem.condArrExternal = g.condArrTime().external();
+      gem.condArrCno      = g.condArrTime().cno();
+      gem.condArrCalHE    = g.condArrTime().calHE();
+      gem.condArrCalLE    = g.condArrTime().calLE();
+      gem.condArrTkr      = g.condArrTime().tkr();
+      gem.condArrRoi      = g.condArrTime().roi();
+
+      gem.triggerTime = g.triggerTime();
+      GEMonePPStime opt = g.onePPStime();
+      gem.onePPSseconds  = opt.seconds();
+      gem.onePPStimebase = opt.timebase();
+      gem.deltaWindowOpenTime = g.deltaWindowOpenTime();
+      gem.deltaEventTime      = g.deltaEventTime();
+
+      gem.eventNumber = EventSummary::eventNumber( g.summary() );
+      gem.tag         = EventSummary::tag( g.summary() );
+      gem.valid = true;
+    }
+
+  private:
+
+    /// a GEM contribution at offset, length bytes long by its header, lies
+    /// within size bytes of data
+    static bool fits( unsigned int offset, unsigned int length, unsigned int size ) {
+      if ( offset > size ) return false;
+      const unsigned int room = size - offset;
+      return sizeof(GEMcontribution) <= room && length <= room;
+    }
+
+    /// walks the events of the data and stops at the first GEM contribution
+    class Finder : public EBFeventIterator {
+    public:
+      enum { FOUND = 1 };   // ends the iteration
+
+      Finder() : EBFeventIterator() {}
+      virtual ~Finder() {}
+
+      GEMcontribution* gem() const { return m_contributions.gem; }
+
+      virtual int handleError( EBFevent* /*evt*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+        return code;
+      }
+      virtual int process( EBFevent* event ) {
+        m_contributions.iterate( event );
+        return m_contributions.gem ? FOUND : 0;
+      }
+
+    private:
+
+      class Contributions : public EBFcontributionIterator {
+      public:
+        Contributions() : EBFcontributionIterator(), gem( 0 ) {}
+        virtual ~Contributions() {}
+
+        virtual int handleError( EBFevent* /*event*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+          return code;
+        }
+        virtual int handleError( EBFcontribution* /*contribution*/, unsigned code, unsigned /*p1*/ = 0, unsigned /*p2*/ = 0 ) const {
+          return code;
+        }
+
+        virtual int UDF( EBFevent*, EBFcontribution* ) { return 0; }
+        virtual int OSW( EBFevent*, OSWcontribution* ) { return 0; }
+        virtual int GLT( EBFevent*, GLTcontribution* ) { return 0; }
+        virtual int GEM( EBFevent*, GEMcontribution* c ) { gem = c; return FOUND; }
+        virtual int ACD( EBFevent*, AEMcontribution* ) { return 0; }
+        virtual int TEM( EBFevent*, TEMcontribution* ) { return 0; }
+
+        GEMcontribution* gem;
+      };
+
+      // no copies
+      Finder( const Finder& );
+      Finder& operator=( const Finder& );
+
+      Contributions m_contributions;
+    };
+  };
+
+}
+
+#endif    // LSFDATA_GEMEXTRACTOR_H
@@ -0,0 +1,87 @@
+#ifndef LSFDATA_GEMSUMMARY_H
+#define LSFDATA_GEMSUMMARY_H 1
+
+/** @class GemSummary
+* @brief The GEM contribution of an EBF event, unpacked into plain fields
+*
+* Holds what MyGEMcontribution::dump in LDFdump prints: the trigger
+* vectors and condition summary, the tile list, the livetime, prescaled and
+* discarded counters, the condition arrival times, the trigger and one-PPS
+* times, plus the event number and tag of the contribution's event summary.
+* Filled by GemExtractor (LsfGemExtractor.h); valid is false when the event
+* had no GEM contribution.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  struct GemSummary {
+
+    GemSummary() { clear(); }
+
+    void clear() {
+      roiVector = tkrVector = calHEvector = calLEvector = cnoVector = 0;
+      conditionSummary = missed = 0;
+      tileXZM = tileXZP = tileYZM = tileYZP = tileRBN = tileNA = 0;
+      tileXY = 0;
+      liveTime = prescaled = discarded = 0;
+      condArrTime = 0;
+      condArrExternal = condArrCno = condArrCalHE = condArrCalLE = condArrTkr = condArrRoi = 0;
+      triggerTime = 0;
+      onePPSseconds = onePPStimebase = 0;
+      deltaWindowOpenTime = deltaEventTime = 0;
+      eventNumber = 0;
+      tag = 0;
+      valid = false;
+    }
+
+    // trigger
+    unsigned short roiVector;
+    unsigned short tkrVector;
+    unsigned short calHEvector;
+    unsigned short calLEvector;
+    unsigned short cnoVector;
+    unsigned char  conditionSummary;
+    unsigned char  missed;
+
+    // tile list
+    unsigned short tileXZM;
+    unsigned short tileXZP;
+    unsigned short tileYZM;
+    unsigned short tileYZP;
+    unsigned short tileRBN;
+    unsigned short tileNA;
+    unsigned int   tileXY;
+
+    // counters
+    unsigned int   liveTime;
+    unsigned int   prescaled;
+    unsigned int   discarded;
+
+    // condition arrival times, raw and per condition
+    unsigned int   condArrTime;
+    unsigned char  condArrExternal;
+    unsigned char  condArrCno;
+    unsigned char  condArrCalHE;
+    unsigned char  condArrCalLE;
+    unsigned char  condArrTkr;
+    unsigned char  condArrRoi;
+
+    // times
+    unsigned int   triggerTime;
+    unsigned int   onePPSseconds;
+    unsigned int   onePPStimebase;
+    unsigned short deltaWindowOpenTime;
+    unsigned short deltaEventTime;
+
+    // event summary of the contribution
+    unsigned int   eventNumber;
+    unsigned char  tag;
+
+    bool           valid;
+  };
+
+}
+
+#endif    // LSFDATA_GEMSUMMARY_H
@@ -74,6 +74,8 @@ namespace lsfData {
     }
 
     virtual LsfKeys* clone() const = 0;
+    /// copy other into this one if they are of the same type; false if not
+    virtual bool assign( const LsfKeys& /*other*/ ) { return false; }
     virtual enums::Lsf::KeysType type() const = 0;
     virtual const LpaKeys* castToLpaKeys() const { return 0; };
     virtual const LciKeys* castToLciKeys() const { return 0; };
@@ -132,6 +134,12 @@ namespace lsfData {
     }
     
     virtual LsfKeys*                   clone() const { return new LpaKeys( *this ); };
+    virtual bool                       assign( const LsfKeys& other ) {
+      const LpaKeys* o = other.castToLpaKeys();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
     virtual const LpaKeys*  castToLpaKeys() const { return this; };
     virtual enums::Lsf::KeysType        type() const { return enums::Lsf::LpaKeys; };
 
@@ -184,6 +192,12 @@ namespace lsfData {
     }
 
     virtual LsfKeys*                   clone() const { return new LciKeys( *this ); };
+    virtual bool                       assign( const LsfKeys& other ) {
+      const LciKeys* o = other.castToLciKeys();
+      if ( o == 0 ) return false;
+      *this = *o;
+      return true;
+    }
     virtual enums::Lsf::KeysType        type() const { return enums::Lsf::LciKeys; };
     virtual const LciKeys*  castToLciKeys() const { return this; };
 
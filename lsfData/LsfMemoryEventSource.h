@@ -0,0 +1,88 @@
+#ifndef LSFDATA_MEMORYEVENTSOURCE_H
+#define LSFDATA_MEMORYEVENTSOURCE_H 1
+
+#include <vector>
+
+#include "lsfData/LsfEventSource.h"
+
+/** @class MemoryEventSource
+* @brief EventSource replaying pre-decoded LSE records from memory
+*
+* Records are appended with add() and handed out in order by read(); only
+* the info and keys matching the record's types are copied.  rewind()
+* restarts the replay, so the same records can drive LSFReader repeatedly
+* to measure the conversion into lsfData objects without any file I/O.
+* The header summary is derived from the first and last record; begSec and
+* endSec come from their packet time, ctx.ccsds.utc, the clock of the LSE
+* header.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class MemoryEventSource : public EventSource {
+
+  public:
+
+    typedef EventRecord Record;
+
+    MemoryEventSource( unsigned int runid = 0 ) : m_runid(runid), m_next(0) {}
+    virtual ~MemoryEventSource() {}
+
+    /// append a copy of one event
+    void add( const Record& rec ) { m_records.push_back( rec ); }
+
+    /// restart the replay at the first record
+    void rewind() { m_next = 0; }
+
+    /// drop all records
+    void clear() { m_records.clear(); m_next = 0; }
+
+    /// index of the next record read() will return
+    unsigned long long position() const { return m_next; }
+
+    const std::vector< Record >& records() const { return m_records; }
+
+    virtual bool read( eventFile::LSE_Context&        ctx,
+                       eventFile::EBF_Data&           ebf,
+                       eventFile::LSE_Info::InfoType& infotype,
+                       eventFile::LPA_Info&           pinfo,
+                       eventFile::LCI_ACD_Info&       ainfo,
+                       eventFile::LCI_CAL_Info&       cinfo,
+                       eventFile::LCI_TKR_Info&       tinfo,
+                       eventFile::LSE_Keys::KeysType& ktype,
+                       eventFile::LPA_Keys&           pakeys,
+                       eventFile::LCI_Keys&           cikeys );
+
+    virtual bool canSeek() const { return true; }
+
+    /// moves the replay position, nothing is copied
+    virtual unsigned long long skip( unsigned long long n ) {
+      const unsigned long long left = m_records.size() - m_next;
+      if ( n > left ) n = left;
+      m_next += static_cast< size_t >( n );
+      return n;
+    }
+
+    virtual unsigned long long evtcnt() const { return m_records.size(); }
+    virtual unsigned int runid() const { return m_runid; }
+    virtual unsigned int begSec() const;
+    virtual unsigned int endSec() const;
+    virtual unsigned long long begGEM() const;
+    virtual unsigned long long endGEM() const;
+
+    /// no error summary is kept for replayed records
+    virtual std::pair< unsigned, unsigned > seqErr( int ) const { return std::make_pair( 0u, 0u ); }
+    virtual std::pair< unsigned, unsigned > dfiErr( int ) const { return std::make_pair( 0u, 0u ); }
+
+  private:
+
+    std::vector< Record > m_records;
+    unsigned int          m_runid;
+    size_t                m_next;
+  };
+
+}
+
+#endif    // LSFDATA_MEMORYEVENTSOURCE_H
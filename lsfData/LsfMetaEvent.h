@@ -2,6 +2,7 @@
 #define LSFDATA_METAEVENT_H 1
 
 #include <iostream>
+#include <algorithm>
 //#include <map>
 
 #include "lsfData/LsfTime.h"
@@ -11,6 +12,7 @@
 #include "lsfData/LsfConfiguration.h"
 #include "lsfData/LsfKeys.h"
 #include "lsfData/LpaHandler.h"
+#include "lsfData/LsfProfile.h"
 
 /** @class MetaEvent
 *
@@ -36,6 +38,8 @@ namespace lsfData {
        m_keys(keys.clone()),
        m_ktype(keys.type()),
        m_gamma(0), m_pass(0), m_mip(0), m_hip(0), m_dgn(0), m_lpaHandler(0),
+       m_spareConfig(0), m_spareKeys(0), m_spareGamma(0), m_sparePass(0),
+       m_spareMip(0), m_spareHip(0), m_spareDgn(0), m_spareLpaHandler(0),
        m_mootKey(LSF_INVALID_UINT),
        m_mootAlias(""), m_compressionLevel(LSF_UNDEFINED),
        m_compressedSize(LSF_UNDEFINED) {
@@ -48,6 +52,8 @@ namespace lsfData {
        m_keys(0),
        m_ktype(enums::Lsf::NoKeysType),
        m_gamma(0), m_pass(0), m_mip(0), m_hip(0), m_dgn(0), m_lpaHandler(0),
+       m_spareConfig(0), m_spareKeys(0), m_spareGamma(0), m_sparePass(0),
+       m_spareMip(0), m_spareHip(0), m_spareDgn(0), m_spareLpaHandler(0),
        m_mootKey(LSF_INVALID_UINT),
        m_mootAlias(""),m_compressionLevel(LSF_UNDEFINED),
        m_compressedSize(LSF_UNDEFINED) {
@@ -60,6 +66,11 @@ namespace lsfData {
        m_time(other.time()),
        m_config(0),
        m_type(enums::Lsf::NoRunType),
+       m_keys(0),
+       m_ktype(enums::Lsf::NoKeysType),
+       m_gamma(0), m_pass(0), m_mip(0), m_hip(0), m_dgn(0), m_lpaHandler(0),
+       m_spareConfig(0), m_spareKeys(0), m_spareGamma(0), m_sparePass(0),
+       m_spareMip(0), m_spareHip(0), m_spareDgn(0), m_spareLpaHandler(0),
        m_compressionLevel(other.compressionLevel()),
        m_compressedSize(other.compressedSize()) {
       if ( other.configuration() != 0 ) {
@@ -108,48 +119,43 @@ namespace lsfData {
           delete m_lpaHandler;
           m_lpaHandler = 0;
       }
+      delete m_spareConfig;
+      delete m_spareKeys;
+      delete m_spareGamma;
+      delete m_sparePass;
+      delete m_spareMip;
+      delete m_spareHip;
+      delete m_spareDgn;
+      delete m_spareLpaHandler;
+    }
 
+    /// deep copy
+    MetaEvent& operator=( const MetaEvent& other ) {
+      if ( &other != this ) {
+        MetaEvent copy( other );
+        swap( copy );
+      }
+      return *this;
     }
 
+    /// reset to the default state; the configuration, keys and handlers
+    /// are kept aside and reused by the next set*() or add*Handler() of
+    /// the same type, so an event cleared and refilled does not allocate
     inline void clear() {
-       if (m_config) {
-            delete m_config;
-            m_config = 0;
-        }
-       if (m_keys) {
-	 delete m_keys;
-	 m_keys = 0;
-       }
+        park( m_config, m_spareConfig );
+        park( m_keys, m_spareKeys );
         m_run.clear();
         m_datagram.clear();
         m_scalers.clear();
         m_time.clear();      
         m_type = enums::Lsf::NoRunType;
 	m_ktype = enums::Lsf::NoKeysType;
-      if (m_gamma) {
-          delete m_gamma;
-          m_gamma = 0;
-      }
-      if (m_mip) {
-          delete m_mip;
-          m_mip = 0;
-      }
-      if (m_hip) {
-          delete m_hip;
-          m_hip = 0;
-      }
-      if (m_dgn) {
-          delete m_dgn;
-          m_dgn = 0;
-      }
-      if (m_pass) {
-          delete m_pass;
-          m_pass = 0;
-      }
-      if (m_lpaHandler) {
-          delete m_lpaHandler;
-          m_lpaHandler = 0;
-      }
+      park( m_gamma, m_spareGamma );
+      park( m_mip, m_spareMip );
+      park( m_hip, m_spareHip );
+      park( m_dgn, m_spareDgn );
+      park( m_pass, m_sparePass );
+      park( m_lpaHandler, m_spareLpaHandler );
       m_mootKey = LSF_INVALID_UINT;
       m_mootAlias = "";
 
@@ -206,12 +212,8 @@ namespace lsfData {
       m_datagram = datagram;
       m_scalers = scalers;
       m_time = time;
-      if(m_config) delete m_config;
-      m_config = configuration.clone();
-      m_type = configuration.type();
-      if(m_keys) delete m_keys;
-      m_keys = keys.clone();
-      m_ktype = keys.type();
+      setConfiguration( configuration );
+      setKeys( keys );
     }
 
     // set the individual data members
@@ -220,14 +222,30 @@ namespace lsfData {
     inline void setDatagram( const DatagramInfo& val) { m_datagram = val; };
     inline void setScalers( const GemScalers& val) { m_scalers = val; };
     inline void setTime( const Time& val) { m_time = val; }; 
+    /// set only the timetones, leaving the event time alone
+    inline void setTimeTones( const TimeTone& current, const TimeTone& previous ) {
+      m_time.setCurrent( current );
+      m_time.setPrevious( previous );
+    }
+    /// set only the event time, leaving the timetones alone
+    inline void setEventTime( const GemTime& timeHack, unsigned int timeTicks ) {
+      m_time.setGemTime( timeHack );
+      m_time.setTimeTicks( timeTicks );
+    }
     inline void setConfiguration( const Configuration& configuration ) {
-      if (m_config) delete m_config;
-      m_config = configuration.clone();
+      LSFDATA_PROFILE_SCOPE(CloneConfig);
+      if ( !reuse( m_config, m_spareConfig, configuration ) ) {
+        LSFDATA_PROFILE_ALLOC(ConfigAlloc);
+        m_config = configuration.clone();
+      }
       m_type = configuration.type();
     }
     inline void setKeys( const LsfKeys& keys ) {
-      if (m_keys) delete m_keys;
-      m_keys = keys.clone();
+      LSFDATA_PROFILE_SCOPE(CloneKeys);
+      if ( !reuse( m_keys, m_spareKeys, keys ) ) {
+        LSFDATA_PROFILE_ALLOC(KeysAlloc);
+        m_keys = keys.clone();
+      }
       m_ktype = keys.type();
     }
 
@@ -243,25 +261,84 @@ namespace lsfData {
     inline void setCompressedSize(int size) { m_compressedSize = size; }
 
 void addGammaHandler(const GammaHandler& gamma) {
-    m_gamma = new lsfData::GammaHandler(gamma);
+    add( m_gamma, m_spareGamma, gamma );
 }
 void addDgnHandler(const DgnHandler& dgn) {
-    m_dgn = new lsfData::DgnHandler(dgn);
+    add( m_dgn, m_spareDgn, dgn );
 }
 void addPassthruHandler(const PassthruHandler& pass) {
-    m_pass = new lsfData::PassthruHandler(pass);
+    add( m_pass, m_sparePass, pass );
 }
 void addMipHandler(const MipHandler& mip) {
-    m_mip = new lsfData::MipHandler(mip);
+    add( m_mip, m_spareMip, mip );
 }
 void addHipHandler(const HipHandler& hip) {
-    m_hip = new lsfData::HipHandler(hip);
+    add( m_hip, m_spareHip, hip );
 }
 void addLpaHandler(const LpaHandler& lpa) {
-    m_lpaHandler = new lsfData::LpaHandler(lpa);
+    add( m_lpaHandler, m_spareLpaHandler, lpa );
 }
+
+    /// exchange contents with other; only pointers change hands, nothing is cloned
+    inline void swap( MetaEvent& other ) {
+      std::swap( m_run, other.m_run );
+      std::swap( m_datagram, other.m_datagram );
+      std::swap( m_scalers, other.m_scalers );
+      std::swap( m_time, other.m_time );
+      std::swap( m_config, other.m_config );
+      std::swap( m_type, other.m_type );
+      std::swap( m_keys, other.m_keys );
+      std::swap( m_ktype, other.m_ktype );
+      std::swap( m_gamma, other.m_gamma );
+      std::swap( m_pass, other.m_pass );
+      std::swap( m_mip, other.m_mip );
+      std::swap( m_hip, other.m_hip );
+      std::swap( m_dgn, other.m_dgn );
+      std::swap( m_lpaHandler, other.m_lpaHandler );
+      std::swap( m_mootKey, other.m_mootKey );
+      m_mootAlias.swap( other.m_mootAlias );
+      std::swap( m_compressionLevel, other.m_compressionLevel );
+      std::swap( m_compressedSize, other.m_compressedSize );
+    }
     
   private:
+
+    /// move an object out of use, keeping it for later
+    template < class T > static void park( T*& used, T*& spare ) {
+      if ( used == 0 ) return;
+      if ( spare == 0 ) spare = used;
+      else delete used;
+      used = 0;
+    }
+
+    /// copy value into the object in use or the spare one, if either has
+    /// the same type; false if a new clone is needed
+    template < class T > static bool reuse( T*& used, T*& spare, const T& value ) {
+      if ( used != 0 ) {
+        if ( used->assign( value ) ) return true;
+        park( used, spare );
+      }
+      if ( spare != 0 && spare->assign( value ) ) {
+        used = spare;
+        spare = 0;
+        return true;
+      }
+      return false;
+    }
+
+    /// copy a handler into the one in use, the spare one or a new one
+    template < class H > static void add( H*& used, H*& spare, const H& value ) {
+      if ( used == 0 && spare != 0 ) {
+        used = spare;
+        spare = 0;
+      }
+      if ( used != 0 ) {
+        *used = value;
+        return;
+      }
+      LSFDATA_PROFILE_ALLOC(HandlerAlloc);
+      used = new H( value );
+    }
     
     /// 
     RunInfo m_run;
@@ -282,6 +359,16 @@ void addLpaHandler(const LpaHandler& lpa) {
     DgnHandler *m_dgn;
     LpaHandler *m_lpaHandler;
 
+    // taken out of use by clear(), reused by the setters
+    Configuration   *m_spareConfig;
+    LsfKeys         *m_spareKeys;
+    GammaHandler    *m_spareGamma;
+    PassthruHandler *m_sparePass;
+    MipHandler      *m_spareMip;
+    HipHandler      *m_spareHip;
+    DgnHandler      *m_spareDgn;
+    LpaHandler      *m_spareLpaHandler;
+
     unsigned int m_mootKey;
     std::string  m_mootAlias;
 
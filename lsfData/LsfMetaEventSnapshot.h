@@ -0,0 +1,90 @@
+#ifndef LSFDATA_METAEVENTSNAPSHOT_H
+#define LSFDATA_METAEVENTSNAPSHOT_H 1
+
+#include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfAtomic.h"
+
+/** @class MetaEventSnapshot
+* @brief A shared, immutable MetaEvent
+*
+* One decoded event often feeds several consumers, possibly on different
+* threads.  Copying a MetaEvent clones its configuration, keys and every
+* handler; copying a MetaEventSnapshot only bumps an atomic reference
+* count, and the last copy to go deletes the event.
+*
+* adopt() takes the contents of a freshly decoded MetaEvent without cloning
+* anything and leaves it empty, ready for the reader to fill with the next
+* event.  The constructor from a const MetaEvent makes one deep copy.
+*
+* The event can only be reached through const references, so any number of
+* threads can read it at once without locking.  A single snapshot handle,
+* like a std::string, must not be assigned in one thread while another
+* copies it; each thread should hold its own copy.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class MetaEventSnapshot {
+
+  public:
+
+    /// a null snapshot
+    MetaEventSnapshot() : m_shared(0) {}
+
+    /// share a deep copy of meta
+    explicit MetaEventSnapshot( const MetaEvent& meta ) : m_shared( new Shared( meta ) ) {}
+
+    MetaEventSnapshot( const MetaEventSnapshot& other ) : m_shared( other.m_shared ) { retain(); }
+
+    ~MetaEventSnapshot() { release(); }
+
+    MetaEventSnapshot& operator=( const MetaEventSnapshot& other ) {
+      if ( m_shared != other.m_shared ) {
+        release();
+        m_shared = other.m_shared;
+        retain();
+      }
+      return *this;
+    }
+
+    /// share the contents of meta, leaving meta empty
+    static MetaEventSnapshot adopt( MetaEvent& meta ) {
+      MetaEventSnapshot snap;
+      snap.m_shared = new Shared;
+      snap.m_shared->meta.swap( meta );
+      return snap;
+    }
+
+    inline bool valid() const { return m_shared != 0; }
+    inline const MetaEvent* get() const { return m_shared ? &m_shared->meta : 0; }
+    inline const MetaEvent& operator*() const { return m_shared->meta; }
+    inline const MetaEvent* operator->() const { return &m_shared->meta; }
+
+    /// handles sharing the event, 0 for a null snapshot
+    inline unsigned int useCount() const { return m_shared ? atomic::load( m_shared->refs ) : 0; }
+
+    /// drop this handle's reference
+    inline void reset() { release(); m_shared = 0; }
+
+  private:
+
+    struct Shared {
+      Shared() : refs(1) {}
+      explicit Shared( const MetaEvent& m ) : refs(1), meta(m) {}
+      volatile unsigned int refs;
+      MetaEvent             meta;
+    };
+
+    inline void retain() { if ( m_shared ) atomic::add( m_shared->refs, 1 ); }
+    inline void release() {
+      if ( m_shared && atomic::add( m_shared->refs, ~0u ) == 0 ) delete m_shared;
+    }
+
+    Shared* m_shared;
+  };
+
+}
+
+#endif    // LSFDATA_METAEVENTSNAPSHOT_H
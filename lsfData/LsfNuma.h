@@ -0,0 +1,90 @@
+#ifndef LSFDATA_NUMA_H
+#define LSFDATA_NUMA_H 1
+
+#include <cstddef>
+#include <vector>
+
+/** @class Numa
+* @brief NUMA node binding and placement counters for readers and workers
+*
+* On multi-socket nodes an event decoded on one socket and processed on the
+* other pays the interconnect on every access.  Linux places a page on the
+* node of the thread that first touches it, but that only covers fresh
+* pages: the heap hands out memory that other threads may already have
+* touched on another node.  So a node is given explicitly:
+*  - a thread that will read events binds itself with bind( node ), CPUs
+*    and memory policy, before opening the file; LSFReader leaves the
+*    thread's settings alone, as the binding is for the rest of the
+*    thread's life;
+*  - EventPool and EventQueue given a node allocate their events from
+*    allocate( n, node ), whose pages are placed on the node whoever
+*    touches them first;
+*  - the Decompressor given a node binds its workers the same way.
+* The buffers an event grows later (payload, cloned configuration) come
+* from the heap of the thread that fills it, so the filling thread should
+* be bound as well; with bind() fresh heap pages go to its node, but heap
+* memory it reuses stays where it was first touched.
+*
+* account() checks where a buffer actually is against where the calling
+* thread runs and counts local, remote and unknown accesses, so the
+* placement can be verified on a live job; it costs a system call, so it is
+* meant for sampling, not for every event.  Nothing in lsfData calls it:
+* the job samples the buffers it cares about itself.
+*
+* Everything is read from /sys and plain system calls, without libnuma.
+* Off Linux, or on a kernel without NUMA, there is one node, binding does
+* nothing and returns false, and every access counts as unknown.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class Numa {
+
+  public:
+
+    struct Counters {
+      unsigned int local;    // buffer on the node the thread runs on
+      unsigned int remote;   // buffer on another node
+      unsigned int unknown;  // placement could not be determined
+    };
+
+    /// number of NUMA nodes, at least 1
+    static int nodes();
+
+    /// the CPUs of a node; false if the node is unknown
+    static bool cpus( int node, std::vector< int >& cpus );
+
+    /// run the calling thread on the CPUs of node only; false if that failed
+    static bool bindThread( int node );
+
+    /// new pages of the calling thread go to node if it has free memory
+    /// (a preferred policy); -1 goes back to the default; false if that failed
+    static bool bindMemory( int node );
+
+    /// bindThread( node ) and bindMemory( node )
+    static bool bind( int node );
+
+    /// n bytes placed on node, page aligned; with node -1 or off Linux
+    /// plain heap memory; 0 if out of memory
+    static void* allocate( size_t n, int node );
+    /// return memory from allocate(), with the same n and node
+    static void release( void* p, size_t n, int node );
+
+    /// node of the CPU the calling thread is running on, -1 if unknown
+    static int currentNode();
+
+    /// node holding the page at p, -1 if unknown or not yet touched
+    static int nodeOf( const void* p );
+
+    /// count an access by this thread to the buffer at p
+    static void account( const void* p );
+
+    static void counters( Counters& c );
+    static void resetCounters();
+  };
+
+}
+
+#endif    // LSFDATA_NUMA_H
@@ -0,0 +1,243 @@
+#ifndef LSFDATA_PACKEDMETAEVENT_H
+#define LSFDATA_PACKEDMETAEVENT_H 1
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "lsfData/LsfGemScalers.h"
+#include "lsfData/LsfTime.h"
+#include "lsfData/LsfRunInfo.h"
+#include "lsfData/LsfDatagramInfo.h"
+#include "lsfData/LsfBufferArena.h"
+
+/** @class PackedMetaEvent
+* @brief The per-event fields of a MetaEvent in two cache lines
+*
+* A MetaEvent keeps its configuration, keys and each handler (and each
+* handler's RSD) in separate heap objects, stores enums and flags as full
+* ints and carries the MOOT alias as a std::string.  Scanning an array of
+* them touches a dozen cache lines per event.
+*
+* PackedMetaEvent holds only what per-event scans usually need -- the GEM
+* scalers, the trigger time and both timetones, and the state and
+* prescaler of each filter handler as bytes -- in 128 bytes.  Everything
+* else stays in a cold side record (see PackedEventArray).
+*
+* The handler state and prescaler bytes are the enum values truncated to
+* a byte, for selecting events; the exact values are kept in the cold
+* handler summaries.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class MetaEvent;
+  class Configuration;
+  class LsfKeys;
+
+  struct PackedMetaEvent {
+
+    /// filter handlers, in the order of the state and prescaler bytes
+    enum Handler { Gamma = 0, Mip, Hip, Dgn, Passthru, HandlerCnt };
+
+    // GEM scalers
+    unsigned long long elapsed;
+    unsigned long long livetime;
+    unsigned long long prescaled;
+    unsigned long long discarded;
+    unsigned long long sequence;
+    unsigned long long deadzone;
+
+    // trigger time
+    unsigned int  timeTicks;
+    unsigned int  hackHacks;
+    unsigned int  hackTicks;
+
+    // current and previous timetones
+    unsigned int  currentSecs;
+    unsigned int  currentHacks;
+    unsigned int  currentTicks;
+    unsigned int  currentIncomplete;
+    unsigned int  currentFlywheeling;
+    unsigned int  previousSecs;
+    unsigned int  previousHacks;
+    unsigned int  previousTicks;
+    unsigned int  previousIncomplete;
+    unsigned int  previousFlywheeling;
+    unsigned char currentFlags;
+    unsigned char previousFlags;
+
+    // bit (1 << Handler) set if the event has that handler
+    unsigned char handlers;
+    unsigned char state[HandlerCnt];
+    unsigned char prescaler[HandlerCnt];
+
+    // enums::Lsf::RunType and enums::Lsf::KeysType
+    unsigned char runType;
+    unsigned char keysType;
+
+    // index of the cold record
+    unsigned int  cold;
+
+    unsigned char pad[8];
+
+    /// fill from a MetaEvent; cold is left alone
+    void pack( const MetaEvent& meta );
+
+    inline bool has( Handler h ) const { return ( handlers & ( 1u << h ) ) != 0; }
+
+    inline GemScalers scalers() const {
+      return GemScalers( elapsed, livetime, prescaled, discarded, sequence, deadzone );
+    }
+
+    inline Time time() const {
+      return Time( TimeTone( currentIncomplete, currentSecs, currentFlywheeling, currentFlags,
+                             GemTime( currentHacks, currentTicks ) ),
+                   TimeTone( previousIncomplete, previousSecs, previousFlywheeling, previousFlags,
+                             GemTime( previousHacks, previousTicks ) ),
+                   GemTime( hackHacks, hackTicks ), timeTicks );
+    }
+  };
+
+  /** @class PackedContext
+  * @brief What the events of a run share: run, configuration, keys and MOOT
+  *
+  * A PackedEventArray keeps one of these for each stretch of events with
+  * the same context, rather than one per event.
+  */
+
+  struct PackedContext {
+    RunInfo        run;
+    Configuration* configuration;   // owned by the array, 0 if none
+    LsfKeys*       keys;            // owned by the array, 0 if none
+    unsigned int   mootKey;
+    std::string    mootAlias;
+  };
+
+  /** @class PackedHandler
+  * @brief The summary of one handler of an event
+  *
+  * The LpaHandler fields with the exact state and prescaler, and the
+  * status words of its RSD when it has one.
+  */
+
+  struct PackedHandler {
+    unsigned int  masterKey;
+    unsigned int  cfgKey;
+    unsigned int  cfgId;
+    unsigned int  version;
+    unsigned int  prescaleFactor;
+    int           state;
+    int           prescaler;
+    int           id;
+    unsigned int  status;
+    unsigned int  stage;
+    unsigned int  energyValid;
+    int           energyInLeus;
+    unsigned char has;
+    unsigned char rsd;
+  };
+
+  /** @class PackedColdEvent
+  * @brief The per-event fields a PackedMetaEvent leaves out
+  */
+
+  struct PackedColdEvent {
+
+    /// bit in handlers for the generic LpaHandler, after the filter handlers
+    enum { Lpa = PackedMetaEvent::HandlerCnt };
+
+    DatagramInfo  datagram;
+    int           compressionLevel;
+    int           compressedSize;
+    unsigned int  context;          // index of the PackedContext
+    unsigned int  handler;          // index of the first PackedHandler
+    unsigned char handlers;         // handlers present, in PackedHandler order
+  };
+
+  /** @class PackedEventArray
+  * @brief A growable array of events split into hot and cold parts
+  *
+  * The hot PackedMetaEvent records are contiguous and aligned on 64-byte
+  * boundaries, so a scan over them reads two cache lines per event and
+  * nothing else.  The rest of each event is kept in a parallel
+  * PackedColdEvent -- datagram and compression -- with a PackedHandler
+  * summary for each handler it has.  The run, configuration, keys and MOOT
+  * key and alias are stored once in a PackedContext and shared by all the
+  * events that follow with the same values, so appending an event
+  * allocates nothing once the vectors have grown.  unpack() puts the parts
+  * back together.
+  *
+  * With BufferArena::HugePages the hot records are kept on 2 MB pages
+  * where the system allows it (see BufferArena), which saves TLB misses
+  * when scanning very large arrays.
+  */
+
+  class PackedEventArray {
+
+  public:
+
+    enum { ALIGNMENT = 64 };
+
+    explicit PackedEventArray( BufferArena::Pages pages = BufferArena::SmallPages );
+    ~PackedEventArray();
+
+    /// append an event
+    void push_back( const MetaEvent& meta );
+
+    /// forget all events, keeping the hot storage
+    void clear();
+
+    void reserve( size_t n );
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    /// hot fields of event i
+    inline const PackedMetaEvent& operator[]( size_t i ) const { return m_hot[i]; }
+
+    /// contiguous hot records, [begin(), begin()+size())
+    inline const PackedMetaEvent* begin() const { return m_hot; }
+
+    /// cold fields of event i
+    inline const PackedColdEvent& cold( size_t i ) const { return m_cold[ m_hot[i].cold ]; }
+
+    /// run, configuration, keys and MOOT context of event i
+    inline const PackedContext& context( size_t i ) const { return m_contexts[ cold(i).context ]; }
+
+    /// number of distinct contexts stored
+    inline size_t contexts() const { return m_contexts.size(); }
+
+    /// rebuild the full MetaEvent of event i
+    void unpack( size_t i, MetaEvent& meta ) const;
+
+    /// true if the hot records are on huge pages
+    inline bool hugePages() const { return m_huge; }
+
+  private:
+
+    // no copies
+    PackedEventArray( const PackedEventArray& );
+    PackedEventArray& operator=( const PackedEventArray& );
+
+    void release();
+
+    /// index of the context of meta, adding one if it differs from the last
+    unsigned int context( const MetaEvent& meta );
+
+    char*                          m_raw;
+    PackedMetaEvent*               m_hot;
+    size_t                         m_size;
+    size_t                         m_capacity;
+    BufferArena::Pages             m_pages;
+    bool                           m_huge;
+    std::vector< PackedColdEvent > m_cold;
+    std::vector< PackedHandler >   m_handlers;
+    std::vector< PackedContext >   m_contexts;
+  };
+
+}
+
+#endif    // LSFDATA_PACKEDMETAEVENT_H
@@ -0,0 +1,37 @@
+#ifndef LSFDATA_PAYLOADCODEC_H
+#define LSFDATA_PAYLOADCODEC_H 1
+
+#include <vector>
+
+/** @class PayloadCodec
+* @brief Expands a compressed event payload
+*
+* MetaEvent::compressionLevel() and compressedSize() describe how an LPA
+* or LCI event's EBF payload was compressed on board; lsfData does not
+* depend on the flight software that implements the compression, so the
+* algorithm is supplied by the application through this interface and run
+* by a Decompressor.
+*
+* decompress() is called concurrently from the Decompressor's worker
+* threads and must not modify shared state.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class PayloadCodec {
+
+  public:
+
+    virtual ~PayloadCodec() {}
+
+    /// replace the contents of out with the expansion of [data, data+length),
+    /// compressed at the given level; false if the payload is corrupt
+    virtual bool decompress( const char* data, unsigned int length, int level,
+                             std::vector< char >& out ) const = 0;
+  };
+
+}
+
+#endif    // LSFDATA_PAYLOADCODEC_H
@@ -0,0 +1,100 @@
+#ifndef LSFDATA_PROFILE_H
+#define LSFDATA_PROFILE_H 1
+
+#include <iostream>
+
+/** @class Profile
+* @brief Optional per-stage timers and allocation counters for LSFReader
+*
+* Compile lsfData and its clients with -DLSFDATA_PROFILE to time each
+* stage of LSFReader::read with the CPU time-stamp counter and to count the
+* heap allocations made while filling a MetaEvent.  Without the flag the
+* LSFDATA_PROFILE_* macros expand to nothing and the read path is
+* unchanged.
+*
+* Some of the stages and allocation sites are in the inline MetaEvent and
+* handler code, so the library and the code using it must be built with
+* the same setting: a program mixing the two has two versions of those
+* inline functions, and which one runs is up to the linker.
+*
+* Each thread accumulates into its own block, so recording needs no
+* locking; snapshot() sums the blocks of all threads.  Values read while
+* other threads are still recording are approximate.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class Profile {
+
+  public:
+
+    enum Stage { Read = 0,          // all of LSFReader::read
+                 BaseRead,          // EventSource::read
+                 TransferCcsds,
+                 TransferContext,
+                 TransferTime,
+                 TransferHandlers,  // the LPA_Handler loop in transferInfo
+                 CloneConfig,       // MetaEvent::setConfiguration
+                 CloneKeys,         // MetaEvent::setKeys
+                 StageCnt };
+
+    enum Alloc { ConfigAlloc = 0,   // Configuration::clone
+                 KeysAlloc,         // LsfKeys::clone
+                 HandlerAlloc,      // MetaEvent::add*Handler
+                 RsdAlloc,          // handler setStatus creating its RSD
+                 AllocCnt };
+
+    struct Snapshot {
+      unsigned long long calls[StageCnt];
+      unsigned long long ticks[StageCnt];
+      unsigned long long allocs[AllocCnt];
+      unsigned int       threads;          // threads that recorded anything
+      double             ticksPerSecond;
+    };
+
+    /// true if the library was built with LSFDATA_PROFILE
+    static bool enabled();
+
+    /// current value of the time-stamp counter
+    static unsigned long long ticks();
+
+    /// sum of the counters of all threads
+    static void snapshot( Snapshot& snap );
+
+    /// zero the counters of all threads
+    static void reset();
+
+    static const char* stageName( Stage stage );
+    static const char* allocName( Alloc alloc );
+
+    /// one line per stage with calls, total and mean time
+    static void print( const Snapshot& snap, std::ostream& s );
+
+    // used by the macros below
+    static void record( Stage stage, unsigned long long ticks );
+    static void count( Alloc alloc );
+  };
+
+  /// Times the enclosing scope as one call of a stage
+  class ProfileScope {
+  public:
+    ProfileScope( Profile::Stage stage ) : m_stage(stage), m_start(Profile::ticks()) {}
+    ~ProfileScope() { Profile::record( m_stage, Profile::ticks() - m_start ); }
+  private:
+    Profile::Stage     m_stage;
+    unsigned long long m_start;
+  };
+
+}
+
+#ifdef LSFDATA_PROFILE
+#define LSFDATA_PROFILE_SCOPE(stage) lsfData::ProfileScope lsfDataProfile_##stage( lsfData::Profile::stage )
+#define LSFDATA_PROFILE_ALLOC(alloc) lsfData::Profile::count( lsfData::Profile::alloc )
+#else
+#define LSFDATA_PROFILE_SCOPE(stage)
+#define LSFDATA_PROFILE_ALLOC(alloc)
+#endif
+
+#endif    // LSFDATA_PROFILE_H
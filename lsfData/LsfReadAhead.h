@@ -0,0 +1,98 @@
+#ifndef LSFDATA_READAHEAD_H
+#define LSFDATA_READAHEAD_H 1
+
+#include <cstddef>
+#include <string>
+
+/** @class ReadAhead
+* @brief Keeps kernel reads in flight ahead of an LSF file's reader
+*
+* eventFile::LSEReader reads and parses the file itself, in small
+* synchronous reads, so a reader thread waits on the device whenever it
+* runs past the kernel's own read-ahead.  ReadAhead opens the file a second
+* time and, as the reader advances, asks the kernel (posix_fadvise
+* WILLNEED) to start reading the next `depth` windows of `window` bytes.
+* Those requests are asynchronous: the reader never blocks on them, and
+* by the time LSEReader gets there the data is in the page cache.  Many
+* files can be read concurrently this way from one thread each without
+* any extra I/O threads.  These are hints to the kernel's own read-ahead,
+* not an asynchronous I/O interface; how much they gain depends on the
+* device and on how cold the cache is (bench_lsfData reads each file cold
+* with each FileEventSource::Io).
+*
+* For one-pass scans the reader can also drop behind itself: with
+* dropBehind the windows wholly before the reader's offset are released
+* from the page cache (POSIX_FADV_DONTNEED), and the rest of what it
+* consumed when the ReadAhead goes away.  A scan then streams the file
+* through a few windows of cache instead of evicting everything else on
+* the node.  The page cache is shared, so released pages are gone for
+* every process: another job reading the same file at the same time reads
+* them again from the device.  Use dropBehind only for files nobody else
+* is reading.  Nothing past the last offset given is released.
+* advance() must not be given an offset past the reader's actual one.
+*
+* Where posix_fadvise is not available, or the file cannot be opened,
+* active() is false and advance() does nothing, leaving the plain reads.
+*
+* The file name may contain $(VAR) environment references, expanded as
+* LSEReader expands them.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class ReadAhead {
+
+  public:
+
+    enum { DEFAULT_WINDOW = 8 << 20, DEFAULT_DEPTH = 4 };
+
+    ReadAhead( const std::string& filename,
+               size_t window = DEFAULT_WINDOW, unsigned int depth = DEFAULT_DEPTH,
+               bool dropBehind = false );
+    ~ReadAhead();
+
+    /// true if hints are being issued
+    inline bool active() const { return m_fd >= 0; }
+
+    /// file size in bytes, 0 if unknown
+    inline unsigned long long size() const { return m_size; }
+
+    /// bytes per hint
+    inline size_t window() const { return m_window; }
+
+    /// the reader has consumed the file up to offset; requests reads up to
+    /// depth windows past it and, with dropBehind, releases the windows
+    /// before it
+    void advance( unsigned long long offset );
+
+    /// windows requested so far
+    inline unsigned long long requested() const { return m_requested; }
+
+    /// bytes released from the page cache so far
+    inline unsigned long long dropped() const { return m_dropped; }
+
+    /// expand $(VAR) references in a file name
+    static std::string expand( const std::string& filename );
+
+  private:
+
+    // no copies, the descriptor is owned
+    ReadAhead( const ReadAhead& );
+    ReadAhead& operator=( const ReadAhead& );
+
+    int                m_fd;
+    unsigned long long m_size;
+    size_t             m_window;
+    unsigned int       m_depth;
+    bool               m_dropBehind;
+    unsigned long long m_ahead;       // hints issued up to here
+    unsigned long long m_requested;
+    unsigned long long m_dropped;     // released up to here
+    unsigned long long m_offset;      // consumed up to here
+  };
+
+}
+
+#endif    // LSFDATA_READAHEAD_H
@@ -0,0 +1,135 @@
+#ifndef LSFDATA_RUNCATALOG_H
+#define LSFDATA_RUNCATALOG_H 1
+
+#include <map>
+#include <string>
+#include <vector>
+
+/** @class RunCatalog
+* @brief Sorted index of the header summaries of many LSF files
+*
+* Finding the files that hold a run or a stretch of mission elapsed time
+* would otherwise mean opening every file to look at runid(), begSec(),
+* endSec() and friends.  The catalog does that once: refresh() lists a
+* directory, reads the header of every new or changed file on a few
+* threads, and keeps one fixed-size Entry per file.  An EventSource is
+* opened per file; if it can tell() its position (a FileEventSource with
+* LSFDATA_LSE_SEEK) its events are read once to record up to MARKS
+* positions spread over the file, otherwise no event is read.  save() and load() keep the catalog
+* on disk between jobs, so the next refresh() only looks at files whose
+* size or modification time changed, and drops files that are gone.
+*
+* Entries are kept sorted by begSec, with the running maximum of endSec
+* beside them, and a second index orders them by run.  covering() and
+* forRun() are then binary searches followed by a walk over the matching
+* entries only.
+*
+* Files whose header cannot be read are counted in failed() and left out,
+* so the next refresh() tries them again.  The catalog is not thread
+* safe; the threads are internal to refresh() and add().  On Windows
+* there are none: the threads argument is ignored and the headers are
+* read one after the other.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class EventSource;
+
+  class RunCatalog {
+
+  public:
+
+    /// positions kept per file
+    enum { MARKS = 16 };
+
+    /// the header summary of one file, and where in it to seek
+    struct Entry {
+      unsigned long long begGEM;
+      unsigned long long endGEM;
+      unsigned long long evtcnt;
+      unsigned long long size;     ///< file size when scanned
+      long long          mtime;    ///< modification time when scanned
+      long long          markAt[MARKS];   ///< EventSource::tell() before a marked event
+      unsigned int       markSec[MARKS];  ///< packet time of that event, in whole seconds
+      unsigned int       marks;    ///< marks kept, in file order; 0 if the source cannot tell()
+      unsigned int       file;     ///< index of the name, see file()
+      unsigned int       runid;
+      unsigned int       begSec;
+      unsigned int       endSec;
+    };
+
+    /// opens the source whose header is catalogued; must be callable from
+    /// several threads at once
+    class Opener {
+    public:
+      virtual ~Opener() {}
+      /// a new source on the file, or 0; may throw
+      virtual EventSource* open( const std::string& filename ) const;
+    };
+
+    /// files are opened as FileEventSource unless another opener is given;
+    /// the catalog does not take ownership of it
+    RunCatalog( const Opener* opener = 0 );
+    ~RunCatalog() {}
+
+    /// bring the catalog up to date with the files in directory ending in
+    /// suffix; returns the number of headers read
+    unsigned int refresh( const std::string& directory, unsigned int threads = 4,
+                          const std::string& suffix = ".lsf" );
+    /// catalog these files, re-reading any already known; returns the
+    /// number of headers read
+    unsigned int add( const std::vector< std::string >& filenames, unsigned int threads = 4 );
+    /// forget a file; false if it was not catalogued
+    bool remove( const std::string& filename );
+    void clear();
+
+    /// write the catalog to a file, false on failure; it is written to
+    /// filename.tmp and renamed, so an existing catalog is either kept
+    /// whole or replaced whole
+    bool save( const std::string& filename ) const;
+    /// replace the catalog by one written by save(); false, and an empty
+    /// catalog, if the file is missing or not a catalog
+    bool load( const std::string& filename );
+
+    /// entries overlapping [t0, t1] (in seconds, as begSec/endSec), in begSec order
+    void covering( unsigned int t0, unsigned int t1, std::vector< const Entry* >& out ) const;
+    /// entries of one run, in begSec order
+    void forRun( unsigned int runid, std::vector< const Entry* >& out ) const;
+
+    /// all entries, in begSec order
+    inline const std::vector< Entry >& entries() const { return m_entries; }
+    inline size_t size() const { return m_entries.size(); }
+    inline const std::string& file( const Entry& entry ) const { return m_files[ entry.file ]; }
+
+    /// headers that could not be read by the last refresh() or add()
+    inline unsigned int failed() const { return m_failed; }
+
+  private:
+
+    // no copies, a catalog can be large
+    RunCatalog( const RunCatalog& );
+    RunCatalog& operator=( const RunCatalog& );
+
+    typedef std::map< std::string, Entry > Table;
+
+    /// the current entries by file name
+    void table( Table& t ) const;
+    /// read the headers of files into t, dropping the unreadable ones;
+    /// returns the number read
+    unsigned int scan( const std::vector< std::string >& files, unsigned int threads, Table& t );
+    /// replace the catalog by t, rebuilding the name table and both orders
+    void rebuild( const Table& t );
+
+    const Opener*               m_opener;
+    std::vector< std::string >  m_files;
+    std::vector< Entry >        m_entries;  // by begSec, endSec
+    std::vector< unsigned int > m_maxEnd;   // max endSec of m_entries[0..i]
+    std::vector< unsigned int > m_byRun;    // indices into m_entries by runid, begSec
+    unsigned int                m_failed;
+  };
+
+}
+
+#endif    // LSFDATA_RUNCATALOG_H
@@ -0,0 +1,151 @@
+#ifndef LSFDATA_SEQUENCEMONITOR_H
+#define LSFDATA_SEQUENCEMONITOR_H 1
+
+#include "lsfData/LsfAtomic.h"
+
+/** @class SequenceMonitor
+* @brief Incremental per-APID GEM sequence and datagram gap monitor
+*
+* The LSF header only carries end-of-file sequence and DFI error totals.
+* A SequenceMonitor attached to an LSFReader is updated as each event is
+* read, so a monitoring thread can sample the counters while the file is
+* still being decoded.
+*
+* For every CCSDS apid the monitor remembers the GEM sequence number and
+* the datagram counter of the previous event and flags:
+*  - SequenceGap:      the sequence jumped forward by more than one
+*  - SequenceBackward: the sequence repeated or went backwards
+*  - DatagramGap:      the datagram counter jumped forward by more than one
+*
+* The datagram counter belongs to the EPU that sent the event, so it is
+* always followed per apid.  The GEM sequence counts every trigger of the
+* LAT, and the EPUs share the events between them: when one stream carries
+* the events of several EPU apids, each apid on its own sees the sequence
+* numbers of the other EPUs as gaps.  PerApid assumes each apid carries a
+* complete sequence; Merged follows one sequence across all apids and
+* charges a gap to the apid of the event where it was seen.
+*
+* The counters have a single writer (the reading thread) and are published
+* with release stores, so sampling them never takes a lock.  The most recent
+* MAX_GAPS gaps are kept in a ring, each entry guarded by a sequence stamp
+* so that a reader never returns a half-written record.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class LsfCcsds;
+  class MetaEvent;
+
+  class SequenceMonitor {
+
+  public:
+
+    enum { MAX_APIDS = 2048,  // CCSDS apids are 11 bits wide
+           MAX_GAPS  = 256 };
+
+    enum GapType { SequenceGap = 0, SequenceBackward, DatagramGap, GapTypeCnt };
+
+    /// which events the GEM sequence is followed over
+    enum Sequence { PerApid = 0, Merged };
+
+    /// Where a gap was seen
+    struct Gap {
+      unsigned int       apid;
+      unsigned int       type;      // a GapType
+      unsigned long long expected;  // sequence (or datagram) expected next
+      unsigned long long found;     // sequence (or datagram) actually read
+      unsigned long long event;     // ordinal of the event in the stream, from 0
+      unsigned int       datagram;  // datagram counter of the event
+      double             utc;       // CCSDS packet time of the event
+    };
+
+    explicit SequenceMonitor( Sequence sequence = PerApid );
+    ~SequenceMonitor() {}
+
+    /// forget everything seen so far
+    void reset();
+
+    /// account for the next event read from the stream
+    void update( const LsfCcsds& ccsds, const MetaEvent& meta );
+
+    // the following may be called from any thread at any time
+
+    /// number of events seen on this apid
+    inline unsigned int events( unsigned int apid ) const {
+      return atomic::load( m_events[ apid & (MAX_APIDS-1) ] );
+    }
+
+    /// number of gaps of the given type seen on this apid
+    inline unsigned int gaps( unsigned int apid, GapType type ) const {
+      return atomic::load( m_gaps[type][ apid & (MAX_APIDS-1) ] );
+    }
+
+    /// number of sequence numbers skipped over by forward gaps on this apid
+    inline unsigned int missing( unsigned int apid ) const {
+      return atomic::load( m_missing[ apid & (MAX_APIDS-1) ] );
+    }
+
+    /// number of events seen on all apids
+    inline unsigned int totalEvents() const { return atomic::load( m_totalEvents ); }
+
+    /// number of gaps of the given type seen on all apids
+    inline unsigned int totalGaps( GapType type ) const { return atomic::load( m_totalGaps[type] ); }
+
+    /// number of gaps recorded since the last reset; only the most recent
+    /// MAX_GAPS of them can still be retrieved
+    inline unsigned int gapCount() const { return atomic::load( m_gapCount ); }
+
+    /// copy up to max of the most recently recorded gaps, oldest first,
+    /// and return how many were copied
+    unsigned int recentGaps( Gap* out, unsigned int max ) const;
+
+    inline Sequence sequence() const { return m_sequence; }
+
+    /// print the per-apid totals in the style of the LSF header summary
+    void print() const;
+
+  private:
+
+    void record( unsigned int apid, GapType type,
+                 unsigned long long expected, unsigned long long found,
+                 unsigned int datagram, double utc );
+
+    // not copyable, other threads may hold a pointer to us
+    SequenceMonitor( const SequenceMonitor& );
+    SequenceMonitor& operator=( const SequenceMonitor& );
+
+    /// last state seen on each apid, touched by the writer only
+    struct ApidState {
+      unsigned long long sequence;
+      unsigned int       datagram;
+      unsigned int       run;
+      bool               seen;
+    };
+
+    struct GapSlot {
+      volatile unsigned int stamp;  // odd while being written
+      Gap                   gap;
+    };
+
+    Sequence  m_sequence;
+    ApidState m_state[MAX_APIDS];
+    ApidState m_merged;    // the sequence across all apids, with Merged
+
+    volatile unsigned int m_events[MAX_APIDS];
+    volatile unsigned int m_missing[MAX_APIDS];
+    volatile unsigned int m_gaps[GapTypeCnt][MAX_APIDS];
+
+    volatile unsigned int m_totalEvents;
+    volatile unsigned int m_totalGaps[GapTypeCnt];
+
+    volatile unsigned int m_gapCount;
+    GapSlot               m_ring[MAX_GAPS];
+
+    unsigned long long m_ordinal;
+  };
+
+}
+
+#endif    // LSFDATA_SEQUENCEMONITOR_H
@@ -0,0 +1,83 @@
+#ifndef LSFDATA_TEXTBUFFER_H
+#define LSFDATA_TEXTBUFFER_H 1
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/** @class TextBuffer
+* @brief Reusable output buffer with fast integer formatting
+*
+* Text is appended to an in-memory buffer that is written to the output
+* FILE with a single fwrite whenever it fills up, on flush() and on
+* destruction.  Integers are converted by hand rather than through printf.
+* With no output FILE the buffer just grows, which is handy for building
+* strings.
+*
+* Output is only ordered with respect to other writes to the same FILE at
+* the points where the buffer is flushed.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class TextBuffer {
+
+  public:
+
+    enum { DEFAULT_CAPACITY = 1 << 20 };
+
+    TextBuffer( FILE* out = stdout, size_t capacity = DEFAULT_CAPACITY );
+    ~TextBuffer();
+
+    TextBuffer& append( const char* s );
+    TextBuffer& append( const char* s, size_t n );
+    TextBuffer& append( const std::string& s ) { return append( s.data(), s.size() ); }
+    TextBuffer& append( char c ) {
+      if ( m_size == m_buf.size() ) reserve( 1 );
+      m_buf[m_size++] = c;
+      return *this;
+    }
+
+    /// decimal, as printf %d / %u / %llu
+    TextBuffer& dec( int v );
+    TextBuffer& dec( unsigned int v ) { return dec( static_cast< unsigned long long >( v ) ); }
+    TextBuffer& dec( unsigned long long v );
+
+    /// hexadecimal zero-padded to width digits, as printf %0<width>x / X
+    TextBuffer& hex( unsigned long long v, unsigned int width = 0, bool upper = false );
+
+    /// as printf %<width>.<precision>f
+    TextBuffer& fixed( double v, int width, int precision );
+
+    /// write the buffered text to the output FILE
+    void flush();
+
+    /// drop the buffered text without writing it
+    void clear() { m_size = 0; }
+
+    const char* data() const { return m_size ? &m_buf[0] : ""; }
+    size_t size() const { return m_size; }
+    std::string str() const { return std::string( data(), m_size ); }
+
+    FILE* output() const { return m_out; }
+    void setOutput( FILE* out ) { flush(); m_out = out; }
+
+  private:
+
+    // no copies, two buffers would write the same text
+    TextBuffer( const TextBuffer& );
+    TextBuffer& operator=( const TextBuffer& );
+
+    /// make room for n more characters
+    void reserve( size_t n );
+
+    FILE*             m_out;
+    std::vector<char> m_buf;
+    size_t            m_size;
+  };
+
+}
+
+#endif    // LSFDATA_TEXTBUFFER_H
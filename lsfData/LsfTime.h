@@ -102,6 +102,31 @@ namespace lsfData {
     /// The number of 50ns ticks since last the last time hack
     inline unsigned int timeTicks() const { return m_timeTicks; }
 
+    /// GEM ticks are a 25 bit counter of the nominally 20 MHz LAT clock
+    enum { TICKS_MASK = 0x1FFFFFF, TICKS_PER_SECOND = 20000000 };
+
+    /// Seconds of mission elapsed time at event capture: the current
+    /// timetone's seconds plus the ticks since its time hack, at the clock
+    /// rate counted between the previous and current timetones
+    inline double met() const {
+      return met( m_current.timeSecs(), m_current.timeHack().ticks(),
+                  m_previous.timeSecs(), m_previous.timeHack().ticks(), m_timeTicks );
+    }
+
+    /// As above, from the raw values.  The nominal rate is used when the
+    /// two timetones are not one second apart or the counted rate is off
+    /// by more than 1%
+    static inline double met( unsigned int currentSecs, unsigned int currentTicks,
+                              unsigned int previousSecs, unsigned int previousTicks,
+                              unsigned int eventTicks ) {
+      double rate = TICKS_PER_SECOND;
+      if ( currentSecs == previousSecs + 1 ) {
+        const unsigned int counted = ( currentTicks - previousTicks ) & TICKS_MASK;
+        if ( counted > TICKS_PER_SECOND / 100 * 99 && counted < TICKS_PER_SECOND / 100 * 101 ) rate = counted;
+      }
+      return currentSecs + ( ( eventTicks - currentTicks ) & TICKS_MASK ) / rate;
+    }
+
     /// set everything at once
     inline void set(const TimeTone& current, const TimeTone& previous,
 		    const GemTime& timeHack, unsigned int timeTicks) {
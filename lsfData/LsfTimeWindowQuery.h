@@ -0,0 +1,112 @@
+#ifndef LSFDATA_TIMEWINDOWQUERY_H
+#define LSFDATA_TIMEWINDOWQUERY_H 1
+
+#include <vector>
+
+#include "lsfData/LsfEventSource.h"
+#include "lsfData/LsfRunCatalog.h"
+
+/** @class TimeWindowQuery
+* @brief The events of a time window, across all the files of a RunCatalog
+*
+* A follow-up on a transient wants a few minutes of data out of months of
+* archive.  The query asks the catalog for the files whose header seconds
+* overlap the window and reads only those, in begSec order.  If the source
+* of a file can seek (EventSource::canSeek()), the query skips the events
+* that the header's begSec, endSec and evtcnt predict to lie before the
+* window, less some slack; if the first event after the skip is already
+* inside the window the estimate was too far, and the file is reopened
+* with half the skip.  A source that can only tell() and seek(), as a
+* FileEventSource with LSFDATA_LSE_SEEK, goes to the last of the catalog's
+* marks (RunCatalog::Entry) before the window, or the one before that if
+* it lands inside.  Any other source would only read and drop those
+* events, and read them again after a reopen, so it is read from the
+* start, once.  Events before the window are passed over without being
+* converted.  Events are assumed to be in time order within a file, give
+* or take the margin: a file is left at the first event later than the
+* window by more than the margin.
+*
+* The window is [begin, end] in seconds on one of two clocks: the event
+* time from the GEM timetones (Time::met()) or the CCSDS packet time
+* (LsfCcsds::getUtc()).  File headers count seconds of packet time, so
+* margin widens the window by that much when choosing files and seek
+* points, to cover the latency between event and packet.
+*
+* The catalog must outlive the query and not change while it is read.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class LsfCcsds;
+  class MetaEvent;
+  class LSFReader;
+
+  class TimeWindowQuery {
+
+  public:
+
+    enum Clock { Met = 0,   ///< event time, see Time::met()
+                 Utc };     ///< CCSDS packet time, see LsfCcsds::getUtc()
+
+    /// files are opened with the catalog's default opener unless another is given
+    TimeWindowQuery( const RunCatalog& catalog, double begin, double end, Clock clock = Met,
+                     double margin = 1., const RunCatalog::Opener* opener = 0 );
+    ~TimeWindowQuery();
+
+    /// the next event in the window, false when there are no more
+    bool read( LsfCcsds& ccsds, MetaEvent& meta, eventFile::EBF_Data& ebf );
+    /// the native records of the next event in the window, not converted
+    bool readRecord( EventRecord& rec );
+
+    /// time of an event on the query's clock
+    double time( const EventRecord& rec ) const;
+
+    /// files overlapping the window
+    inline unsigned int files() const { return static_cast< unsigned int >( m_entries.size() ); }
+    /// files opened so far, counting reopening after a skip too far
+    inline unsigned int opened() const { return m_opened; }
+    /// events passed over by EventSource::skip(), not counting seek()s
+    inline unsigned long long skipped() const { return m_skipped; }
+    /// events read and compared with the window
+    inline unsigned long long examined() const { return m_examined; }
+    /// events returned
+    inline unsigned long long matched() const { return m_matched; }
+
+  private:
+
+    // no copies, the open file is owned
+    TimeWindowQuery( const TimeWindowQuery& );
+    TimeWindowQuery& operator=( const TimeWindowQuery& );
+
+    /// open the next file at or before the window start, with its first
+    /// record in rec; false when there are no more files
+    bool openNext( EventRecord& rec );
+    void close();
+
+    RunCatalog::Opener                       m_fileOpener;
+    const RunCatalog::Opener*                m_opener;
+    std::vector< const RunCatalog::Entry* >  m_entries;
+    size_t                                   m_next;      // next file to open
+    const RunCatalog*                        m_catalog;
+
+    double            m_begin;
+    double            m_end;
+    Clock             m_clock;
+    double            m_margin;
+
+    EventSource*      m_source;
+    LSFReader*        m_reader;
+    bool              m_pending;   // rec already holds the first record of the file
+    EventRecord       m_record;
+
+    unsigned int       m_opened;
+    unsigned long long m_skipped;
+    unsigned long long m_examined;
+    unsigned long long m_matched;
+  };
+
+}
+
+#endif    // LSFDATA_TIMEWINDOWQUERY_H
@@ -1,3 +1,6 @@
+#include <cstring>
+#include <stdexcept>
+
 #include "eventFile/LSE_Context.h"
 #include "eventFile/EBF_Data.h"
 #include "eventFile/LSE_Info.h"
@@ -13,11 +16,70 @@
 #include "lsfData/LsfTime.h"
 #include "lsfData/LsfTimeTone.h"
 #include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfSequenceMonitor.h"
+#include "lsfData/LsfContextObserver.h"
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfProfile.h"
+
+namespace {
+
+  // the timetone fields of the context are read through templates so that
+  // only their member names, not their type, are needed here
+
+  template < class Tone >
+  unsigned char toneFlags( const Tone& tone )
+  {
+    unsigned char flags = 0;
+    flags |= ( tone.missingTimeTone ) ? enums::Lsf::TimeTone::MISSING_TIMETONE_MASK : 0x0;
+    flags |= ( tone.missingLatPps )   ? enums::Lsf::TimeTone::MISSING_LAT_MASK      : 0x0;
+    flags |= ( tone.missingCpuPps )   ? enums::Lsf::TimeTone::MISSING_CPU_MASK      : 0x0;
+    flags |= ( tone.earlyEvent )      ? enums::Lsf::TimeTone::EARLY_EVENT_MASK      : 0x0;
+    flags |= ( tone.sourceGps )       ? enums::Lsf::TimeTone::SOURCE_GPS_MASK       : 0x0;
+    return flags;
+  }
+
+  template < class Tone >
+  lsfData::TimeTone convertTone( const Tone& tone, unsigned char flags )
+  {
+    return lsfData::TimeTone( tone.incomplete, tone.timeSecs, tone.flywheeling, flags,
+                              lsfData::GemTime( tone.timeHack.hacks, tone.timeHack.tics ) );
+  }
+
+  // a timetone is known by its seconds and flags (see TimeToneCache)
+  bool sameTone( const lsfData::TimeTone& a, unsigned int timeSecs, unsigned char flags )
+  {
+    return a.timeSecs() == timeSecs && a.flags() == flags;
+  }
+
+  bool sameDatagram( const lsfData::DatagramInfo& a, const lsfData::DatagramInfo& b )
+  {
+    return a.datagrams() == b.datagrams() && a.modeChanges() == b.modeChanges()
+      && a.openAction() == b.openAction() && a.openReason() == b.openReason()
+      && a.crate() == b.crate() && a.mode() == b.mode()
+      && a.closeAction() == b.closeAction() && a.closeReason() == b.closeReason();
+  }
+
+  bool sameRun( const lsfData::RunInfo& a, const lsfData::RunInfo& b )
+  {
+    return a.id() == b.id() && a.startTime() == b.startTime()
+      && a.platform() == b.platform() && a.dataOrigin() == b.dataOrigin()
+      && a.dataTransferId() == b.dataTransferId();
+  }
+
+}
 
 namespace lsfData {
   
+  LSFReader::operator eventFile::LSEReader&() const
+  {
+    if ( !m_file ) throw std::runtime_error( "LSFReader: the event source is not an LSF file" );
+    return *m_file;
+  }
+
   bool LSFReader::read( LsfCcsds& lccsds, MetaEvent& lmeta, eventFile::EBF_Data& ebf )
   {
+    LSFDATA_PROFILE_SCOPE(Read);
+
     // create LSE objects to hold the retrieved values
     eventFile::LSE_Context        ctx;
     eventFile::LSE_Info::InfoType infotype;
@@ -30,10 +92,40 @@ namespace lsfData {
     eventFile::LCI_Keys           cikeys;
 
     // read the native objects
-    if ( !eventFile::LSEReader::read( ctx, ebf, infotype, pinfo, ainfo, cinfo, tinfo, ktype, pakeys, cikeys ) ) {
-      return false;
+    {
+      LSFDATA_PROFILE_SCOPE(BaseRead);
+      if ( !m_source->read( ctx, ebf, infotype, pinfo, ainfo, cinfo, tinfo, ktype, pakeys, cikeys ) ) {
+        return false;
+      }
     }
 
+    convert( ctx, infotype, pinfo, ainfo, cinfo, tinfo, ktype, pakeys, cikeys, lccsds, lmeta );
+    return true;
+  }
+
+  bool LSFReader::readRecord( EventRecord& rec )
+  {
+    LSFDATA_PROFILE_SCOPE(BaseRead);
+    return m_source->readRecord( rec );
+  }
+
+  void LSFReader::decode( const EventRecord& rec, LsfCcsds& lccsds, MetaEvent& lmeta )
+  {
+    convert( rec.ctx, rec.infotype, rec.pinfo, rec.ainfo, rec.cinfo, rec.tinfo,
+             rec.ktype, rec.pakeys, rec.cikeys, lccsds, lmeta );
+  }
+
+  void LSFReader::convert( const eventFile::LSE_Context&        ctx,
+                           eventFile::LSE_Info::InfoType        infotype,
+                           const eventFile::LPA_Info&           pinfo,
+                           const eventFile::LCI_ACD_Info&       ainfo,
+                           const eventFile::LCI_CAL_Info&       cinfo,
+                           const eventFile::LCI_TKR_Info&       tinfo,
+                           eventFile::LSE_Keys::KeysType        ktype,
+                           const eventFile::LPA_Keys&           pakeys,
+                           const eventFile::LCI_Keys&           cikeys,
+                           LsfCcsds& lccsds, MetaEvent& lmeta )
+  {
     // transfer the CCSDS information
     transferCcsds( ctx, lccsds );
 
@@ -62,35 +154,81 @@ namespace lsfData {
       break;
     }
 
-    return true;
+    // let the monitor look for sequence and datagram gaps
+    if ( m_monitor ) m_monitor->update( lccsds, lmeta );
   }
 
   void LSFReader::transferCcsds( const eventFile::LSE_Context& ctx, LsfCcsds& lccsds )
   {
+    LSFDATA_PROFILE_SCOPE(TransferCcsds);
+
     lccsds.initialize( ctx.ccsds.scid, ctx.ccsds.apid, ctx.ccsds.utc );
   }
   
   void LSFReader::transferContext( const eventFile::LSE_Context& ctx, MetaEvent& lsfmeta )
   {
-    // set the datagram information
-    enums::Lsf::Open::Action  ao = static_cast< enums::Lsf::Open::Action  >( ctx.open.action );
-    enums::Lsf::Open::Reason  ro = static_cast< enums::Lsf::Open::Reason  >( ctx.open.reason );
-    enums::Lsf::Crate         cr = static_cast< enums::Lsf::Crate         >( ctx.open.crate );
-    enums::Lsf::Mode          md = static_cast< enums::Lsf::Mode          >( ctx.open.mode );
-    enums::Lsf::Close::Action ac = static_cast< enums::Lsf::Close::Action >( ctx.close.action );
-    enums::Lsf::Close::Reason rc = static_cast< enums::Lsf::Close::Reason >( ctx.close.reason );
-    DatagramInfo dgm( ao, ro, cr, md, ac, rc,
-			       ctx.open.datagrams, ctx.open.modeChanges 
-			       );
-    lsfmeta.setDatagram( dgm );
-
-    // set the run information
-    enums::Lsf::Platform   pl = static_cast< enums::Lsf::Platform   >( ctx.run.platform );
-    enums::Lsf::DataOrigin od = static_cast< enums::Lsf::DataOrigin >( ctx.run.origin );
-    RunInfo  run( pl, od,
-			   ctx.run.groundId, ctx.run.startedAt, runid()
-			   );
-    lsfmeta.setRun( run );
+    LSFDATA_PROFILE_SCOPE(TransferContext);
+
+    // compare the raw datagram, run and MOOT context with the last event's
+    ContextCache::Raw raw;
+    raw.openAction  = ctx.open.action;
+    raw.openReason  = ctx.open.reason;
+    raw.crate       = ctx.open.crate;
+    raw.mode        = ctx.open.mode;
+    raw.closeAction = ctx.close.action;
+    raw.closeReason = ctx.close.reason;
+    raw.datagrams   = ctx.open.datagrams;
+    raw.modeChanges = ctx.open.modeChanges;
+    raw.platform    = ctx.run.platform;
+    raw.origin      = ctx.run.origin;
+    raw.groundId    = ctx.run.groundId;
+    raw.startedAt   = ctx.run.startedAt;
+    raw.mootKey     = ctx.mootKey();
+
+    const ContextCache::Raw& last = m_context.raw;
+    const bool newRun = !m_context.valid
+      || raw.groundId != last.groundId || raw.startedAt != last.startedAt
+      || raw.platform != last.platform || raw.origin != last.origin;
+    const bool newDatagram = newRun || raw.datagrams != last.datagrams;
+    const bool modeChange = !newRun && raw.modeChanges != last.modeChanges;
+    const bool changed = newDatagram || memcmp( &raw, &last, sizeof(raw) ) != 0
+      || m_context.mootAlias != ctx.mootAlias();
+
+    if ( changed ) {
+      // the datagram information
+      enums::Lsf::Open::Action  ao = static_cast< enums::Lsf::Open::Action  >( ctx.open.action );
+      enums::Lsf::Open::Reason  ro = static_cast< enums::Lsf::Open::Reason  >( ctx.open.reason );
+      enums::Lsf::Crate         cr = static_cast< enums::Lsf::Crate         >( ctx.open.crate );
+      enums::Lsf::Mode          md = static_cast< enums::Lsf::Mode          >( ctx.open.mode );
+      enums::Lsf::Close::Action ac = static_cast< enums::Lsf::Close::Action >( ctx.close.action );
+      enums::Lsf::Close::Reason rc = static_cast< enums::Lsf::Close::Reason >( ctx.close.reason );
+      m_context.datagram.set( ao, ro, cr, md, ac, rc,
+                              ctx.open.datagrams, ctx.open.modeChanges );
+
+      // the run information
+      enums::Lsf::Platform   pl = static_cast< enums::Lsf::Platform   >( ctx.run.platform );
+      enums::Lsf::DataOrigin od = static_cast< enums::Lsf::DataOrigin >( ctx.run.origin );
+      m_context.run.set( pl, od, ctx.run.groundId, ctx.run.startedAt, runid() );
+
+      // the MOOT key/alias
+      m_context.mootKey = ctx.mootKey();
+      m_context.mootAlias = ctx.mootAlias();
+
+      m_context.raw = raw;
+      m_context.valid = true;
+    }
+
+    // the MetaEvent may be a different one, or cleared, since the last event;
+    // clear() zeroes the run start time, which no run has
+    const bool held = !changed && &lsfmeta == m_context.meta && m_context.run.startTime() != 0
+      && lsfmeta.run().startTime() == m_context.run.startTime();
+    if ( !held ) {
+      if ( !sameDatagram( lsfmeta.datagram(), m_context.datagram ) ) lsfmeta.setDatagram( m_context.datagram );
+      if ( !sameRun( lsfmeta.run(), m_context.run ) ) lsfmeta.setRun( m_context.run );
+      if ( lsfmeta.mootKey() != m_context.mootKey ) lsfmeta.setMootKey( m_context.mootKey );
+      if ( lsfmeta.mootAlias() != m_context.mootAlias ) lsfmeta.setMootAlias( m_context.mootAlias.c_str() );
+      m_context.meta = &lsfmeta;
+    }
 
     // set the GEM scalers
     GemScalers sca( ctx.scalers.elapsed, ctx.scalers.livetime,
@@ -99,42 +237,37 @@ namespace lsfData {
 			  );
     lsfmeta.setScalers( sca );
 
-    // Set MOOT key/alias
-    lsfmeta.setMootKey(ctx.mootKey());
-    lsfmeta.setMootAlias(ctx.mootAlias());
+    // tell the observer about the boundaries, now that the MetaEvent is filled
+    if ( m_observer ) {
+      if ( newRun ) m_observer->onNewRun( m_context.run );
+      if ( newDatagram ) m_observer->onNewDatagram( m_context.datagram );
+      if ( modeChange ) m_observer->onModeChange( m_context.datagram );
+    }
   }
   
   void LSFReader::transferTime( const eventFile::LSE_Context& ctx, const eventFile::LSE_Info& info, MetaEvent& lsfmeta )
   {
-    // get the current timetone info
-    unsigned char flags = 0;
-    flags |= ( ctx.current.missingTimeTone ) ? enums::Lsf::TimeTone::MISSING_TIMETONE_MASK : 0x0;
-    flags |= ( ctx.current.missingLatPps )   ? enums::Lsf::TimeTone::MISSING_LAT_MASK      : 0x0;
-    flags |= ( ctx.current.missingCpuPps )   ? enums::Lsf::TimeTone::MISSING_CPU_MASK      : 0x0;
-    flags |= ( ctx.current.earlyEvent )      ? enums::Lsf::TimeTone::EARLY_EVENT_MASK      : 0x0;
-    flags |= ( ctx.current.sourceGps )      ? enums::Lsf::TimeTone::SOURCE_GPS_MASK      : 0x0;
-    TimeTone curr( ctx.current.incomplete, ctx.current.timeSecs, 
-			    ctx.current.flywheeling, flags,
-			    GemTime( ctx.current.timeHack.hacks, ctx.current.timeHack.tics )
-			    );
-
-    // get the previous timetone info
-    flags = 0;
-    flags |= ( ctx.previous.missingTimeTone ) ? enums::Lsf::TimeTone::MISSING_TIMETONE_MASK : 0x0;
-    flags |= ( ctx.previous.missingLatPps )   ? enums::Lsf::TimeTone::MISSING_LAT_MASK      : 0x0;
-    flags |= ( ctx.previous.missingCpuPps )   ? enums::Lsf::TimeTone::MISSING_CPU_MASK      : 0x0;
-    flags |= ( ctx.previous.earlyEvent )      ? enums::Lsf::TimeTone::EARLY_EVENT_MASK      : 0x0;
-    flags |= ( ctx.previous.sourceGps )      ? enums::Lsf::TimeTone::SOURCE_GPS_MASK      : 0x0;
-    TimeTone prev( ctx.previous.incomplete, ctx.previous.timeSecs, 
-			    ctx.previous.flywheeling, flags,
-			    GemTime( ctx.previous.timeHack.hacks, ctx.previous.timeHack.tics )
-			    );
-
-    // set the current, previous, and event-time fields
-    lsfmeta.setTime( Time( curr, prev,
-				    GemTime( info.timeHack.hacks, info.timeHack.tics ),
-				    info.timeTics )
-		     );
+    LSFDATA_PROFILE_SCOPE(TransferTime);
+
+    // convert the current and previous timetones only when they change
+    const unsigned char currentFlags = toneFlags( ctx.current );
+    const unsigned char previousFlags = toneFlags( ctx.previous );
+    if ( !m_tones.valid || !sameTone( m_tones.current, ctx.current.timeSecs, currentFlags )
+         || !sameTone( m_tones.previous, ctx.previous.timeSecs, previousFlags ) ) {
+      m_tones.current = convertTone( ctx.current, currentFlags );
+      m_tones.previous = convertTone( ctx.previous, previousFlags );
+      m_tones.valid = true;
+    }
+
+    // the MetaEvent may be a different one, or cleared, since the last event
+    const Time& t = lsfmeta.time();
+    if ( !sameTone( t.current(), ctx.current.timeSecs, currentFlags )
+         || !sameTone( t.previous(), ctx.previous.timeSecs, previousFlags ) ) {
+      lsfmeta.setTimeTones( m_tones.current, m_tones.previous );
+    }
+
+    // set the event-time fields
+    lsfmeta.setEventTime( GemTime( info.timeHack.hacks, info.timeHack.tics ), info.timeTics );
   }
 
   void LSFReader::transferLciCfg( const eventFile::LCI_Info& info, LciConfiguration& lcfg )
@@ -175,6 +308,7 @@ namespace lsfData {
     lmeta.setCompressionLevel( info.compressionLevel );
     lmeta.setCompressedSize( info.compressedSize );
 
+    LSFDATA_PROFILE_SCOPE(TransferHandlers);
     std::vector<eventFile::LPA_Handler>::const_iterator handlerIt;
     for (handlerIt = info.handlers.begin(); handlerIt != info.handlers.end(); handlerIt++) {
     const eventFile::PassthruHandlerRsdV0* evtPass( handlerIt->passthruRsdV0() );
@@ -215,9 +349,7 @@ namespace lsfData {
                               evtGamma->energyValid, evtGamma->energyInLeus);
             } else {
             // no version found
-              std::cout << "LSEReader ERROR:  No matching GammaRsd found!" 
-                        << " version is: " << handlerIt->version
-                        << std::endl;
+              Diagnostics::report( Diagnostics::NoGammaRsd, handlerIt->version );
             } 
 
             lmeta.addGammaHandler(gam);
@@ -0,0 +1,125 @@
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#include "lsfData/LsfBufferArena.h"
+
+namespace {
+
+  inline size_t roundUp( size_t n, size_t to ) { return ( n + to - 1 ) / to * to; }
+
+  inline size_t blockSize( size_t n )
+  {
+    return roundUp( n ? n : 1, lsfData::BufferArena::HUGE_PAGE );
+  }
+
+}
+
+namespace lsfData {
+
+  void* BufferArena::map( size_t n, Pages pages, bool& huge )
+  {
+    const size_t size = blockSize( n );
+    huge = false;
+#ifdef _WIN32
+    (void)pages;
+    return VirtualAlloc( 0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+#else
+#ifdef MAP_HUGETLB
+    if ( pages == HugePages ) {
+      // only succeeds if huge pages have been reserved on the node
+      void* p = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+      if ( p != MAP_FAILED ) {
+        huge = true;
+        return p;
+      }
+    }
+#endif
+    // map one huge page more and trim, so the block starts on a huge page
+    // boundary and transparent huge pages can back all of it
+    char* raw = static_cast< char* >( mmap( 0, size + HUGE_PAGE, PROT_READ | PROT_WRITE,
+                                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+    if ( raw == MAP_FAILED ) return 0;
+    char* p = reinterpret_cast< char* >( roundUp( reinterpret_cast< size_t >( raw ), HUGE_PAGE ) );
+    if ( p > raw ) munmap( raw, p - raw );
+    if ( raw + HUGE_PAGE > p ) munmap( p + size, raw + HUGE_PAGE - p );
+#ifdef MADV_HUGEPAGE
+    if ( pages == HugePages ) huge = madvise( p, size, MADV_HUGEPAGE ) == 0;
+#endif
+    return p;
+#endif
+  }
+
+  void BufferArena::unmap( void* p, size_t n )
+  {
+    if ( !p ) return;
+#ifdef _WIN32
+    (void)n;
+    VirtualFree( p, 0, MEM_RELEASE );
+#else
+    munmap( p, blockSize( n ) );
+#endif
+  }
+
+  BufferArena::BufferArena( size_t chunk, Pages pages )
+    : m_current(0), m_chunk( chunk ? chunk : static_cast< size_t >( DEFAULT_CHUNK ) ), m_pages(pages), m_huge(false), m_used(0)
+  {
+  }
+
+  BufferArena::~BufferArena()
+  {
+    for ( size_t i=0; i<m_chunks.size(); i++ ) unmap( m_chunks[i].base, m_chunks[i].size );
+  }
+
+  void* BufferArena::allocate( size_t n, size_t align )
+  {
+    if ( align == 0 ) align = 1;
+    for ( ; m_current < m_chunks.size(); m_current++ ) {
+      Chunk& c = m_chunks[m_current];
+      const size_t offset = roundUp( c.used, align );
+      if ( offset + n <= c.size ) {
+        c.used = offset + n;
+        m_used += n;
+        return c.base + offset;
+      }
+    }
+
+    // chunks are huge page aligned, so offset 0 satisfies any smaller alignment
+    const size_t size = blockSize( n > m_chunk ? n : m_chunk );
+    bool huge = false;
+    char* base = static_cast< char* >( map( size, m_pages, huge ) );
+    if ( !base ) throw std::bad_alloc();
+    m_huge = ( m_chunks.empty() || m_huge ) && huge;
+
+    Chunk c;
+    c.base = base;
+    c.size = size;
+    c.used = n;
+    m_chunks.push_back( c );
+    m_current = m_chunks.size() - 1;
+    m_used += n;
+    return base;
+  }
+
+  void BufferArena::reset()
+  {
+    for ( size_t i=0; i<m_chunks.size(); i++ ) m_chunks[i].used = 0;
+    m_current = 0;
+    m_used = 0;
+  }
+
+  size_t BufferArena::reserved() const
+  {
+    size_t n = 0;
+    for ( size_t i=0; i<m_chunks.size(); i++ ) n += m_chunks[i].size;
+    return n;
+  }
+
+}
@@ -0,0 +1,177 @@
+#include <stdexcept>
+
+#include "eventFile/EBF_Data.h"
+
+#include "lsfData/LsfDecompressor.h"
+#include "lsfData/LsfNuma.h"
+
+namespace lsfData {
+
+  Decompressor::Decompressor( const PayloadCodec& codec, unsigned int threads, unsigned int depth,
+                              int node )
+    : m_codec(codec), m_depth( depth ? depth : 1 ), m_node(node),
+      m_head(0), m_claim(0), m_tail(0), m_quit(false)
+  {
+    for ( unsigned int i=0; i<m_depth; i++ ) m_slots.push_back( new Slot );
+#ifndef _WIN32
+    pthread_mutex_init( &m_mutex, 0 );
+    pthread_cond_init( &m_work, 0 );
+    pthread_cond_init( &m_done, 0 );
+    pthread_cond_init( &m_space, 0 );
+    for ( unsigned int i=0; i<threads; i++ ) {
+      pthread_t tid;
+      if ( pthread_create( &tid, 0, &Decompressor::run, this ) == 0 ) {
+        m_threads.push_back( tid );
+      }
+    }
+#else
+    (void)threads;
+#endif
+  }
+
+  Decompressor::~Decompressor()
+  {
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    m_quit = true;
+    pthread_cond_broadcast( &m_work );
+    pthread_mutex_unlock( &m_mutex );
+    for ( size_t i=0; i<m_threads.size(); i++ ) pthread_join( m_threads[i], 0 );
+    pthread_cond_destroy( &m_space );
+    pthread_cond_destroy( &m_done );
+    pthread_cond_destroy( &m_work );
+    pthread_mutex_destroy( &m_mutex );
+#endif
+    for ( size_t i=0; i<m_slots.size(); i++ ) delete m_slots[i];
+  }
+
+  void Decompressor::push( const char* data, unsigned int length, int level )
+  {
+    // only this thread moves m_tail, so the slot at m_tail is ours once
+    // there is space; the workers do not look at it before m_tail moves on
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    while ( !m_threads.empty() && m_tail - m_head >= m_depth ) {
+      pthread_cond_wait( &m_space, &m_mutex );
+    }
+    pthread_mutex_unlock( &m_mutex );
+#endif
+    if ( m_threads.empty() && m_tail - m_head >= m_depth ) {
+      throw std::runtime_error( "Decompressor: push with a full queue and no worker threads" );
+    }
+
+    Slot& slot = *m_slots[ m_tail % m_depth ];
+    slot.in.assign( data, data + length );
+    slot.level  = level;
+    slot.status = Empty;
+    slot.done   = false;
+
+    if ( m_threads.empty() ) {
+      expand( slot );
+      slot.done = true;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    m_tail++;
+    pthread_cond_signal( &m_work );
+    pthread_mutex_unlock( &m_mutex );
+#else
+    m_tail++;
+#endif
+  }
+
+  void Decompressor::push( const eventFile::EBF_Data& ebf, int level )
+  {
+    push( reinterpret_cast< const char* >( ebf.start() ), static_cast< unsigned int >( ebf.size() ), level );
+  }
+
+  Decompressor::Status Decompressor::pop( std::vector< char >& out )
+  {
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    if ( m_head == m_tail ) {
+      pthread_mutex_unlock( &m_mutex );
+      return Empty;
+    }
+    Slot& slot = *m_slots[ m_head % m_depth ];
+    while ( !slot.done ) pthread_cond_wait( &m_done, &m_mutex );
+    pthread_mutex_unlock( &m_mutex );
+#else
+    if ( m_head == m_tail ) return Empty;
+    Slot& slot = *m_slots[ m_head % m_depth ];
+#endif
+
+    // the caller's old buffer stays in the slot for a later payload
+    out.swap( slot.out );
+    const Status status = slot.status;
+
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    m_head++;
+    pthread_cond_signal( &m_space );
+    pthread_mutex_unlock( &m_mutex );
+#else
+    m_head++;
+#endif
+    return status;
+  }
+
+  unsigned int Decompressor::pending() const
+  {
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    const unsigned long long n = m_tail - m_head;
+    pthread_mutex_unlock( &m_mutex );
+    return static_cast< unsigned int >( n );
+#else
+    return static_cast< unsigned int >( m_tail - m_head );
+#endif
+  }
+
+  void Decompressor::expand( Slot& slot ) const
+  {
+    if ( slot.level <= 0 ) {
+      slot.out.assign( slot.in.begin(), slot.in.end() );
+      slot.status = PassedThrough;
+      return;
+    }
+    slot.out.clear();
+    const char* data = slot.in.empty() ? 0 : &slot.in[0];
+    if ( m_codec.decompress( data, static_cast< unsigned int >( slot.in.size() ), slot.level, slot.out ) ) {
+      slot.status = Decompressed;
+    } else {
+      slot.out.clear();
+      slot.status = Failed;
+    }
+  }
+
+#ifndef _WIN32
+  void* Decompressor::run( void* arg )
+  {
+    static_cast< Decompressor* >( arg )->work();
+    return 0;
+  }
+
+  void Decompressor::work()
+  {
+    if ( m_node >= 0 ) Numa::bind( m_node );
+
+    pthread_mutex_lock( &m_mutex );
+    while ( true ) {
+      while ( !m_quit && m_claim == m_tail ) pthread_cond_wait( &m_work, &m_mutex );
+      if ( m_quit ) break;
+      Slot& slot = *m_slots[ m_claim++ % m_depth ];
+      pthread_mutex_unlock( &m_mutex );
+
+      expand( slot );
+
+      pthread_mutex_lock( &m_mutex );
+      slot.done = true;
+      pthread_cond_broadcast( &m_done );
+    }
+    pthread_mutex_unlock( &m_mutex );
+  }
+#endif
+
+}
@@ -0,0 +1,121 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfAtomic.h"
+
+namespace {
+
+  volatile unsigned int s_counts[ lsfData::Diagnostics::AnomalyCnt ] = { 0, 0, 0 };
+  volatile unsigned int s_limit = 10;
+  std::ostream* volatile s_stream = &std::cout;
+
+  // serializes the log writes of readers on different threads; the
+  // rate limit keeps them rare, so the lock is never busy for long
+#ifndef _WIN32
+  pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+  inline void lock()   { pthread_mutex_lock( &s_mutex ); }
+  inline void unlock() { pthread_mutex_unlock( &s_mutex ); }
+#else
+  volatile unsigned int s_busy = 0;
+  inline void lock()   { while ( !lsfData::atomic::cas( s_busy, 0, 1 ) ) Sleep( 0 ); }
+  inline void unlock() { lsfData::atomic::store( s_busy, 0 ); }
+#endif
+
+  const char* s_names[ lsfData::Diagnostics::AnomalyCnt ] = {
+    "NoGammaRsd",
+    "InvalidGammaVersion",
+    "UncopiedGammaRsd"
+  };
+
+  const char* s_messages[ lsfData::Diagnostics::AnomalyCnt ] = {
+    "LSEReader ERROR:  No matching GammaRsd found! version is: ",
+    "Gamma version invalid, not setting GammaRsd, version is: ",
+    "No valid version for GammaRsd found, set to NULL, version is: "
+  };
+
+  inline bool powerOfTwo( unsigned int n ) { return ( n & (n-1) ) == 0; }
+}
+
+namespace lsfData {
+
+  void Diagnostics::report( Anomaly what, unsigned int version )
+  {
+    const unsigned int n = atomic::add( s_counts[what], 1 );
+    const unsigned int limit = atomic::load( s_limit );
+    if ( n > limit && !powerOfTwo( n ) ) return;
+    lock();
+    std::ostream* s = atomic::load( s_stream );
+    if ( s ) {
+      if ( n <= limit ) {
+        *s << s_messages[what] << version << '\n';
+        if ( n == limit ) {
+          *s << "lsfData: further " << s_names[what]
+             << " messages suppressed, logging every power of two\n";
+        }
+      } else {
+        *s << s_messages[what] << version
+           << " (" << n << " occurrences)\n";
+      }
+    }
+    unlock();
+  }
+
+  unsigned int Diagnostics::count( Anomaly what )
+  {
+    return atomic::load( s_counts[what] );
+  }
+
+  unsigned int Diagnostics::total()
+  {
+    unsigned int sum = 0;
+    for ( int i=0; i<AnomalyCnt; i++ ) {
+      sum += atomic::load( s_counts[i] );
+    }
+    return sum;
+  }
+
+  void Diagnostics::reset()
+  {
+    for ( int i=0; i<AnomalyCnt; i++ ) {
+      atomic::store( s_counts[i], 0 );
+    }
+  }
+
+  void Diagnostics::setLogLimit( unsigned int limit )
+  {
+    atomic::store( s_limit, limit );
+  }
+
+  unsigned int Diagnostics::logLimit()
+  {
+    return atomic::load( s_limit );
+  }
+
+  void Diagnostics::setStream( std::ostream* s )
+  {
+    atomic::store( s_stream, s );
+    // wait out a log write to the old stream
+    lock();
+    unlock();
+  }
+
+  const char* Diagnostics::name( Anomaly what )
+  {
+    return ( what >= 0 && what < AnomalyCnt ) ? s_names[what] : "Unknown";
+  }
+
+  void Diagnostics::summary( std::ostream& s )
+  {
+    for ( int i=0; i<AnomalyCnt; i++ ) {
+      const unsigned int n = atomic::load( s_counts[i] );
+      if ( n > 0 ) {
+        s << "lsfData: " << s_names[i] << " occurred " << n << " times\n";
+      }
+    }
+  }
+
+}
@@ -0,0 +1,400 @@
+#include "lsfData/LsfEventExporter.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+
+namespace {
+
+  const char* s_names[ lsfData::EventExporter::ColumnCnt ] = {
+    "scid", "apid", "utc",
+    "groundId", "startTime", "platform", "dataOrigin", "dataTransferId",
+    "openAction", "openReason", "crate", "mode", "closeAction", "closeReason", "datagrams", "modeChanges",
+    "elapsed", "livetime", "prescaled", "discarded", "sequence", "deadzone",
+    "timeTicks", "hackHacks", "hackTicks",
+    "currentSecs", "currentHacks", "currentTicks", "currentIncomplete", "currentFlywheeling", "currentFlags",
+    "previousSecs", "previousHacks", "previousTicks", "previousIncomplete", "previousFlywheeling", "previousFlags",
+    "mootKey", "mootAlias", "compressionLevel", "compressedSize",
+    "runType", "softwareKey", "hardwareKey", "writeCfg", "readCfg", "period", "cfgFlags",
+    "injected", "threshold", "delay", "channelSingle", "channelAll", "channelLatc",
+    "biasDac", "holdDelay", "hitmapDelay", "range", "veto", "vetoVernier", "highLevelDiscrim",
+    "uld", "firstRange", "calibGain", "highCalEna", "highRngEna", "highGain", "lowCalEna", "lowRngEna", "lowGain",
+    "le", "lowTrgEna", "he", "highTrgEna",
+    "splitLow", "splitHigh",
+    "keysType", "LATC_master", "LATC_ignore", "SBS", "LPA_db", "LCI_script",
+    "gammaState", "gammaPrescaler", "gammaVersion", "gammaStatus", "gammaStage", "gammaEnergyValid", "gammaEnergyInLeus",
+    "mipState", "mipPrescaler", "mipVersion", "mipStatus",
+    "hipState", "hipPrescaler", "hipVersion", "hipStatus",
+    "dgnState", "dgnPrescaler", "dgnVersion", "dgnStatus",
+    "passthruState", "passthruPrescaler", "passthruVersion", "passthruStatus"
+  };
+
+}
+
+namespace lsfData {
+
+  /// one column's value for one event
+  struct EventExporter::Value {
+    enum Kind { Null, Unsigned, Signed, Real, Text } kind;
+    unsigned long long u;
+    int                i;
+    double             d;
+    const std::string* s;
+
+    void setNull() { kind = Null; }
+    void set( unsigned long long val ) { kind = Unsigned; u = val; }
+    void set( unsigned int val ) { kind = Unsigned; u = val; }
+    void set( int val ) { kind = Signed; i = val; }
+    // NaN and infinities have no JSON representation
+    void set( double val ) { kind = ( val - val == 0. ) ? Real : Null; d = val; }
+    void set( const std::string& val ) { kind = Text; s = &val; }
+  };
+
+  /// the pieces of one event, resolved once per line
+  struct EventExporter::Parts {
+    Parts( const LsfCcsds& c, const MetaEvent& m )
+      : ccsds(c), meta(m), cfg( m.configuration() ),
+        lpa( cfg ? cfg->castToLpaConfig() : 0 ),
+        lci( cfg ? cfg->castToLciConfig() : 0 ),
+        acd( cfg ? cfg->castToLciAcdConfig() : 0 ),
+        cal( cfg ? cfg->castToLciCalConfig() : 0 ),
+        tkr( cfg ? cfg->castToLciTkrConfig() : 0 ),
+        keys( m.keys() ),
+        lpaKeys( keys ? keys->castToLpaKeys() : 0 ),
+        lciKeys( keys ? keys->castToLciKeys() : 0 ) {}
+
+    const LsfCcsds&            ccsds;
+    const MetaEvent&           meta;
+    const Configuration*       cfg;
+    const LpaConfiguration*    lpa;
+    const LciConfiguration*    lci;
+    const LciAcdConfiguration* acd;
+    const LciCalConfiguration* cal;
+    const LciTkrConfiguration* tkr;
+    const LsfKeys*             keys;
+    const LpaKeys*             lpaKeys;
+    const LciKeys*             lciKeys;
+  };
+
+  namespace {
+
+    // state, prescaler, version and RSD status are common to all handlers
+    template < class H >
+    void handlerValue( const H* h, int field, unsigned long long& u, bool& ok )
+    {
+      ok = h != 0;
+      if ( !ok ) return;
+      switch ( field ) {
+      case 0: u = h->state(); break;
+      case 1: u = h->prescaler(); break;
+      case 2: u = h->version(); break;
+      default:
+        ok = h->rsd() != 0;
+        if ( ok ) u = h->rsd()->status();
+        break;
+      }
+    }
+
+  }
+
+  EventExporter::EventExporter( TextBuffer& out, Format format )
+    : m_out(out), m_format(format), m_events(0)
+  {
+    selectAll();
+  }
+
+  void EventExporter::selectAll()
+  {
+    m_columns.clear();
+    for ( int i=0; i<ColumnCnt; i++ ) {
+      m_columns.push_back( static_cast< Column >( i ) );
+    }
+  }
+
+  void EventExporter::select( const std::vector< Column >& columns )
+  {
+    m_columns = columns;
+  }
+
+  bool EventExporter::select( const std::string& names )
+  {
+    std::vector< Column > columns;
+    std::string::size_type pos = 0;
+    while ( pos <= names.size() ) {
+      std::string::size_type end = names.find( ',', pos );
+      if ( end == std::string::npos ) end = names.size();
+      std::string name = names.substr( pos, end - pos );
+      // tolerate blanks around the names
+      const std::string::size_type first = name.find_first_not_of( " \t" );
+      const std::string::size_type last  = name.find_last_not_of( " \t" );
+      name = ( first == std::string::npos ) ? std::string() : name.substr( first, last - first + 1 );
+      Column col;
+      if ( !column( name, col ) ) return false;
+      columns.push_back( col );
+      pos = end + 1;
+    }
+    m_columns.swap( columns );
+    return true;
+  }
+
+  const char* EventExporter::columnName( Column column )
+  {
+    return ( column >= 0 && column < ColumnCnt ) ? s_names[column] : "unknown";
+  }
+
+  bool EventExporter::column( const std::string& name, Column& column )
+  {
+    for ( int i=0; i<ColumnCnt; i++ ) {
+      if ( name == s_names[i] ) {
+        column = static_cast< Column >( i );
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void EventExporter::header()
+  {
+    if ( m_format != Csv ) return;
+    for ( size_t i=0; i<m_columns.size(); i++ ) {
+      if ( i ) m_out.append( ',' );
+      m_out.append( s_names[ m_columns[i] ] );
+    }
+    m_out.append( '\n' );
+  }
+
+  void EventExporter::write( const LsfCcsds& ccsds, const MetaEvent& meta )
+  {
+    const Parts p( ccsds, meta );
+    Value v;
+    if ( m_format == JsonLines ) m_out.append( '{' );
+    for ( size_t i=0; i<m_columns.size(); i++ ) {
+      if ( i ) m_out.append( ',' );
+      if ( m_format == JsonLines ) {
+        m_out.append( '"' ).append( s_names[ m_columns[i] ] ).append( "\":" );
+      }
+      value( m_columns[i], p, v );
+      emit( v );
+    }
+    if ( m_format == JsonLines ) m_out.append( '}' );
+    m_out.append( '\n' );
+    m_events++;
+  }
+
+  void EventExporter::emit( const Value& v )
+  {
+    switch ( v.kind ) {
+    case Value::Unsigned: m_out.dec( v.u ); break;
+    case Value::Signed:   m_out.dec( v.i ); break;
+    case Value::Real:     m_out.fixed( v.d, 0, 6 ); break;
+    case Value::Text:     quoted( *v.s ); break;
+    default:
+      if ( m_format == JsonLines ) m_out.append( "null" );
+      break;
+    }
+  }
+
+  void EventExporter::quoted( const std::string& s )
+  {
+    if ( m_format == Csv ) {
+      if ( s.find_first_of( ",\"\r\n" ) == std::string::npos ) {
+        m_out.append( s );
+        return;
+      }
+      m_out.append( '"' );
+      for ( size_t i=0; i<s.size(); i++ ) {
+        if ( s[i] == '"' ) m_out.append( '"' );
+        m_out.append( s[i] );
+      }
+      m_out.append( '"' );
+      return;
+    }
+
+    m_out.append( '"' );
+    for ( size_t i=0; i<s.size(); i++ ) {
+      const unsigned char c = static_cast< unsigned char >( s[i] );
+      if ( c == '"' || c == '\\' ) {
+        m_out.append( '\\' ).append( s[i] );
+      } else if ( c < 0x20 ) {
+        m_out.append( "\\u00" ).hex( c, 2 );
+      } else {
+        m_out.append( s[i] );
+      }
+    }
+    m_out.append( '"' );
+  }
+
+  void EventExporter::value( Column column, const Parts& p, Value& v )
+  {
+    const LsfCcsds& ccsds = p.ccsds;
+    const MetaEvent& meta = p.meta;
+    const Configuration*       cfg = p.cfg;
+    const LpaConfiguration*    lpa = p.lpa;
+    const LciConfiguration*    lci = p.lci;
+    const LciAcdConfiguration* acd = p.acd;
+    const LciCalConfiguration* cal = p.cal;
+    const LciTkrConfiguration* tkr = p.tkr;
+    const LsfKeys*             keys = p.keys;
+    const LpaKeys*             lpaKeys = p.lpaKeys;
+    const LciKeys*             lciKeys = p.lciKeys;
+
+    v.setNull();
+    unsigned long long u = 0;
+    bool ok = false;
+
+    switch ( column ) {
+    case Scid:           v.set( ccsds.getScid() ); break;
+    case Apid:           v.set( ccsds.getApid() ); break;
+    case Utc:            v.set( ccsds.getUtc() ); break;
+
+    case GroundId:       v.set( meta.run().id() ); break;
+    case StartTime:      v.set( meta.run().startTime() ); break;
+    case Platform:       v.set( static_cast< int >( meta.run().platform() ) ); break;
+    case DataOrigin:     v.set( static_cast< int >( meta.run().dataOrigin() ) ); break;
+    case DataTransferId: v.set( meta.run().dataTransferId() ); break;
+
+    case OpenAction:     v.set( static_cast< int >( meta.datagram().openAction() ) ); break;
+    case OpenReason:     v.set( static_cast< int >( meta.datagram().openReason() ) ); break;
+    case Crate:          v.set( static_cast< int >( meta.datagram().crate() ) ); break;
+    case Mode:           v.set( static_cast< int >( meta.datagram().mode() ) ); break;
+    case CloseAction:    v.set( static_cast< int >( meta.datagram().closeAction() ) ); break;
+    case CloseReason:    v.set( static_cast< int >( meta.datagram().closeReason() ) ); break;
+    case Datagrams:      v.set( meta.datagram().datagrams() ); break;
+    case ModeChanges:    v.set( meta.datagram().modeChanges() ); break;
+
+    case Elapsed:        v.set( meta.scalers().elapsed() ); break;
+    case Livetime:       v.set( meta.scalers().livetime() ); break;
+    case Prescaled:      v.set( meta.scalers().prescaled() ); break;
+    case Discarded:      v.set( meta.scalers().discarded() ); break;
+    case Sequence:       v.set( meta.scalers().sequence() ); break;
+    case Deadzone:       v.set( meta.scalers().deadzone() ); break;
+
+    case TimeTicks:          v.set( meta.time().timeTicks() ); break;
+    case HackHacks:          v.set( meta.time().timeHack().hacks() ); break;
+    case HackTicks:          v.set( meta.time().timeHack().ticks() ); break;
+    case CurrentSecs:        v.set( meta.time().current().timeSecs() ); break;
+    case CurrentHacks:       v.set( meta.time().current().timeHack().hacks() ); break;
+    case CurrentTicks:       v.set( meta.time().current().timeHack().ticks() ); break;
+    case CurrentIncomplete:  v.set( meta.time().current().incomplete() ); break;
+    case CurrentFlywheeling: v.set( meta.time().current().flywheeling() ); break;
+    case CurrentFlags:       v.set( static_cast< unsigned int >( meta.time().current().flags() ) ); break;
+    case PreviousSecs:       v.set( meta.time().previous().timeSecs() ); break;
+    case PreviousHacks:      v.set( meta.time().previous().timeHack().hacks() ); break;
+    case PreviousTicks:      v.set( meta.time().previous().timeHack().ticks() ); break;
+    case PreviousIncomplete:  v.set( meta.time().previous().incomplete() ); break;
+    case PreviousFlywheeling: v.set( meta.time().previous().flywheeling() ); break;
+    case PreviousFlags:      v.set( static_cast< unsigned int >( meta.time().previous().flags() ) ); break;
+
+    case MootKey:          v.set( meta.mootKey() ); break;
+    case MootAlias:        v.set( meta.mootAlias() ); break;
+    case CompressionLevel: v.set( meta.compressionLevel() ); break;
+    case CompressedSize:   v.set( meta.compressedSize() ); break;
+
+    case RunType:
+      if ( cfg ) v.set( static_cast< int >( cfg->type() ) );
+      break;
+    case SoftwareKey:
+      if ( lpa ) v.set( lpa->softwareKey() );
+      else if ( lci ) v.set( lci->softwareKey() );
+      break;
+    case HardwareKey:   if ( lpa ) v.set( lpa->hardwareKey() ); break;
+    case WriteCfg:      if ( lci ) v.set( lci->writeCfg() ); break;
+    case ReadCfg:       if ( lci ) v.set( lci->readCfg() ); break;
+    case Period:        if ( lci ) v.set( lci->period() ); break;
+    case CfgFlags:      if ( lci ) v.set( lci->flags() ); break;
+    case Injected:
+      if ( acd ) v.set( static_cast< unsigned int >( acd->injected() ) );
+      else if ( cal ) v.set( static_cast< unsigned int >( cal->injected() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->injected() ) );
+      break;
+    case Threshold:
+      if ( acd ) v.set( static_cast< unsigned int >( acd->threshold() ) );
+      else if ( cal ) v.set( static_cast< unsigned int >( cal->threshold() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->threshold() ) );
+      break;
+    case Delay:
+      if ( cal ) v.set( static_cast< unsigned int >( cal->delay() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->delay() ) );
+      break;
+    case ChannelSingle:
+      if ( acd ) v.set( static_cast< unsigned int >( acd->channel().single() ) );
+      else if ( cal ) v.set( static_cast< unsigned int >( cal->channel().single() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->channel().single() ) );
+      break;
+    case ChannelAll:
+      if ( acd ) v.set( static_cast< unsigned int >( acd->channel().all() ) );
+      else if ( cal ) v.set( static_cast< unsigned int >( cal->channel().all() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->channel().all() ) );
+      break;
+    case ChannelLatc:
+      if ( acd ) v.set( static_cast< unsigned int >( acd->channel().latc() ) );
+      else if ( cal ) v.set( static_cast< unsigned int >( cal->channel().latc() ) );
+      else if ( tkr ) v.set( static_cast< unsigned int >( tkr->channel().latc() ) );
+      break;
+
+    case BiasDac:     if ( acd ) v.set( static_cast< unsigned int >( acd->biasDac() ) ); break;
+    case HoldDelay:   if ( acd ) v.set( static_cast< unsigned int >( acd->holdDelay() ) ); break;
+    case HitmapDelay: if ( acd ) v.set( static_cast< unsigned int >( acd->hitmapDelay() ) ); break;
+    case Range:       if ( acd ) v.set( static_cast< unsigned int >( acd->range() ) ); break;
+    case Veto:        if ( acd ) v.set( static_cast< unsigned int >( acd->trigger().veto() ) ); break;
+    case VetoVernier: if ( acd ) v.set( static_cast< unsigned int >( acd->trigger().vetoVernier() ) ); break;
+    case HighDiscrim: if ( acd ) v.set( static_cast< unsigned int >( acd->trigger().highDiscrim() ) ); break;
+
+    case Uld:         if ( cal ) v.set( static_cast< unsigned int >( cal->uld() ) ); break;
+    case FirstRange:  if ( cal ) v.set( static_cast< unsigned int >( cal->firstRange() ) ); break;
+    case CalibGain:   if ( cal ) v.set( static_cast< unsigned int >( cal->calibGain() ) ); break;
+    case HighCalEna:  if ( cal ) v.set( static_cast< unsigned int >( cal->highCalEna() ) ); break;
+    case HighRngEna:  if ( cal ) v.set( static_cast< unsigned int >( cal->highRngEna() ) ); break;
+    case HighGain:    if ( cal ) v.set( static_cast< unsigned int >( cal->highGain() ) ); break;
+    case LowCalEna:   if ( cal ) v.set( static_cast< unsigned int >( cal->lowCalEna() ) ); break;
+    case LowRngEna:   if ( cal ) v.set( static_cast< unsigned int >( cal->lowRngEna() ) ); break;
+    case LowGain:     if ( cal ) v.set( static_cast< unsigned int >( cal->lowGain() ) ); break;
+    case TriggerLe:   if ( cal ) v.set( static_cast< unsigned int >( cal->trigger().le() ) ); break;
+    case LowTrgEna:   if ( cal ) v.set( static_cast< unsigned int >( cal->trigger().lowTrgEna() ) ); break;
+    case TriggerHe:   if ( cal ) v.set( static_cast< unsigned int >( cal->trigger().he() ) ); break;
+    case HighTrgEna:  if ( cal ) v.set( static_cast< unsigned int >( cal->trigger().highTrgEna() ) ); break;
+
+    case SplitLow:    if ( tkr ) v.set( static_cast< unsigned int >( tkr->splitLow() ) ); break;
+    case SplitHigh:   if ( tkr ) v.set( static_cast< unsigned int >( tkr->splitHigh() ) ); break;
+
+    case KeysType:   if ( keys ) v.set( static_cast< int >( keys->type() ) ); break;
+    case LatcMaster: if ( keys ) v.set( keys->LATC_master() ); break;
+    case LatcIgnore: if ( keys ) v.set( keys->LATC_ignore() ); break;
+    case Sbs:        if ( lpaKeys ) v.set( lpaKeys->sbs() ); break;
+    case LpaDb:      if ( lpaKeys ) v.set( lpaKeys->lpa_db() ); break;
+    case LciScript:  if ( lciKeys ) v.set( lciKeys->LCI_script() ); break;
+
+    case GammaState: case GammaPrescaler: case GammaVersion: case GammaStatus:
+      handlerValue( meta.gammaFilter(), column - GammaState, u, ok );
+      if ( ok ) v.set( u );
+      break;
+    case GammaStage:
+      if ( meta.gammaFilter() && meta.gammaFilter()->rsd() ) v.set( meta.gammaFilter()->rsd()->stage() );
+      break;
+    case GammaEnergyValid:
+      if ( meta.gammaFilter() && meta.gammaFilter()->rsd() ) v.set( meta.gammaFilter()->rsd()->energyValid() );
+      break;
+    case GammaEnergyInLeus:
+      if ( meta.gammaFilter() && meta.gammaFilter()->rsd() ) v.set( meta.gammaFilter()->rsd()->energyInLeus() );
+      break;
+    case MipState: case MipPrescaler: case MipVersion: case MipStatus:
+      handlerValue( meta.mipFilter(), column - MipState, u, ok );
+      if ( ok ) v.set( u );
+      break;
+    case HipState: case HipPrescaler: case HipVersion: case HipStatus:
+      handlerValue( meta.hipFilter(), column - HipState, u, ok );
+      if ( ok ) v.set( u );
+      break;
+    case DgnState: case DgnPrescaler: case DgnVersion: case DgnStatus:
+      handlerValue( meta.dgnFilter(), column - DgnState, u, ok );
+      if ( ok ) v.set( u );
+      break;
+    case PassthruState: case PassthruPrescaler: case PassthruVersion: case PassthruStatus:
+      handlerValue( meta.passthruFilter(), column - PassthruState, u, ok );
+      if ( ok ) v.set( u );
+      break;
+
+    default:
+      break;
+    }
+  }
+
+}
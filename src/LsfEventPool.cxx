@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <new>
+
+#include "lsfData/LsfEventPool.h"
+#include "lsfData/LsfNuma.h"
+
+namespace lsfData {
+
+  EventPool::EventPool( unsigned int n, int node )
+    : m_node(node)
+  {
+    reserve( n );
+  }
+
+  EventPool::~EventPool()
+  {
+    if ( m_node < 0 ) {
+      for ( size_t i=0; i<m_all.size(); i++ ) delete m_all[i];
+      return;
+    }
+    for ( size_t i=0; i<m_all.size(); i++ ) m_all[i]->~QueuedEvent();
+    for ( size_t i=0; i<m_blocks.size(); i++ ) Numa::release( m_blocks[i].base, m_blocks[i].size, m_node );
+  }
+
+  void EventPool::grow( unsigned int n )
+  {
+    // grown geometrically, or one event at a time would copy them all;
+    // m_free can hold every event, so release() never reallocates it
+    if ( m_all.size() + n > m_all.capacity() ) {
+      m_all.reserve( std::max( m_all.size() + n, 2 * m_all.capacity() ) );
+    }
+    m_free.reserve( m_all.capacity() );
+    if ( m_node < 0 ) {
+      for ( unsigned int i=0; i<n; i++ ) {
+        m_all.push_back( new QueuedEvent );
+        m_free.push_back( m_all.back() );
+      }
+      return;
+    }
+    Block block;
+    block.size = n * sizeof(QueuedEvent);
+    block.base = Numa::allocate( block.size, m_node );
+    if ( !block.base ) throw std::bad_alloc();
+    m_blocks.push_back( block );
+    QueuedEvent* events = static_cast< QueuedEvent* >( block.base );
+    for ( unsigned int i=0; i<n; i++ ) {
+      m_all.push_back( new ( events + i ) QueuedEvent );
+      m_free.push_back( m_all.back() );
+    }
+  }
+
+  QueuedEvent* EventPool::acquire()
+  {
+    if ( m_free.empty() ) grow( m_node < 0 ? 1 : BLOCK );
+    QueuedEvent* event = m_free.back();
+    m_free.pop_back();
+    return event;
+  }
+
+  void EventPool::release( QueuedEvent* event )
+  {
+    if ( event == 0 ) return;
+    event->clear();
+    m_free.push_back( event );
+  }
+
+  void EventPool::reserve( unsigned int n )
+  {
+    if ( n <= m_free.size() ) return;
+    grow( n - static_cast< unsigned int >( m_free.size() ) );
+  }
+
+}
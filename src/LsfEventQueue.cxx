@@ -0,0 +1,215 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <sys/time.h>
+#endif
+
+#include "lsfData/LsfEventQueue.h"
+
+namespace {
+
+  enum { SPIN_ROUNDS = 64, YIELD_ROUNDS = 128 };
+
+  /// spin a little, then give the processor away; true once it is time to
+  /// park instead
+  inline bool backoff( unsigned int& round )
+  {
+    if ( ++round < SPIN_ROUNDS ) return false;
+#ifdef _WIN32
+    SwitchToThread();
+    return false;
+#else
+    if ( round >= YIELD_ROUNDS ) return true;
+    sched_yield();
+    return false;
+#endif
+  }
+
+}
+
+namespace lsfData {
+
+  unsigned int EventQueue::roundUp( unsigned int n )
+  {
+    unsigned int p = 1;
+    while ( p < n && p < ( 1u << 30 ) ) p <<= 1;
+    return p;
+  }
+
+  EventQueue::EventQueue( unsigned int capacity, int node )
+    : m_block(0), m_marks(0), m_node(node), m_free( roundUp( capacity ), node ),
+      m_full( roundUp( capacity ), node ), m_closed(0), m_takers(0), m_acquirers(0)
+  {
+    const unsigned int n = roundUp( capacity );
+    m_block = static_cast< QueuedEvent* >( Numa::allocate( n * sizeof(QueuedEvent), m_node ) );
+    m_marks = static_cast< Mark* >( Numa::allocate( n * sizeof(Mark), m_node ) );
+    if ( !m_block || !m_marks ) {
+      Numa::release( m_block, n * sizeof(QueuedEvent), m_node );
+      Numa::release( m_marks, n * sizeof(Mark), m_node );
+      throw std::bad_alloc();
+    }
+    m_slots.reserve( n );
+    for ( unsigned int i=0; i<n; i++ ) {
+      m_marks[i].acquired = 0;
+      m_slots.push_back( new ( m_block + i ) QueuedEvent );
+      m_free.push( m_slots.back() );
+    }
+#ifndef _WIN32
+    pthread_mutex_init( &m_mutex, 0 );
+    pthread_cond_init( &m_published, 0 );
+    pthread_cond_init( &m_freed, 0 );
+#endif
+  }
+
+  EventQueue::~EventQueue()
+  {
+#ifndef _WIN32
+    pthread_cond_destroy( &m_freed );
+    pthread_cond_destroy( &m_published );
+    pthread_mutex_destroy( &m_mutex );
+#endif
+    for ( size_t i=0; i<m_slots.size(); i++ ) m_slots[i]->~QueuedEvent();
+    Numa::release( m_marks, m_slots.size() * sizeof(Mark), m_node );
+    Numa::release( m_block, m_slots.size() * sizeof(QueuedEvent), m_node );
+  }
+
+#ifndef _WIN32
+  void EventQueue::park( volatile unsigned int& parked, pthread_cond_t& cond, bool whileOpen )
+  {
+    atomic::add( parked, 1 );
+    struct timeval now;
+    gettimeofday( &now, 0 );
+    struct timespec until;
+    until.tv_sec  = now.tv_sec;
+    until.tv_nsec = ( now.tv_usec + 1000 ) * 1000;
+    if ( until.tv_nsec >= 1000000000 ) {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock( &m_mutex );
+    // close() signals under the lock, so it cannot slip in between
+    if ( !whileOpen || !closed() ) pthread_cond_timedwait( &cond, &m_mutex, &until );
+    pthread_mutex_unlock( &m_mutex );
+    atomic::add( parked, ~0u );
+  }
+
+  void EventQueue::wake( volatile unsigned int& parked, pthread_cond_t& cond )
+  {
+    if ( atomic::load( parked ) == 0 ) return;
+    pthread_mutex_lock( &m_mutex );
+    pthread_cond_signal( &cond );
+    pthread_mutex_unlock( &m_mutex );
+  }
+#endif
+
+  QueuedEvent* EventQueue::obtain( bool wait )
+  {
+    unsigned int round = 0;
+    while ( !closed() ) {
+      QueuedEvent* e = m_free.pop();
+      if ( e ) {
+        // marked before looking at m_closed again, and take() looks at them
+        // in the other order, so a consumer that finds no mark after close()
+        // knows no producer will publish
+        Mark& m = mark( e );
+        atomic::store( m.acquired, 1 );
+        atomic::fence();
+        if ( !closed() ) return e;
+        cancel( e );
+        return 0;
+      }
+      if ( !wait ) return 0;
+      if ( backoff( round ) ) {
+#ifndef _WIN32
+        park( m_acquirers, m_freed, true );
+#endif
+      }
+    }
+    return 0;
+  }
+
+  bool EventQueue::inFlight() const
+  {
+    for ( size_t i=0; i<m_slots.size(); i++ ) {
+      if ( atomic::load( m_marks[i].acquired ) ) return true;
+    }
+    return false;
+  }
+
+  QueuedEvent* EventQueue::tryAcquire()
+  {
+    return obtain( false );
+  }
+
+  QueuedEvent* EventQueue::acquire()
+  {
+    return obtain( true );
+  }
+
+  void EventQueue::publish( QueuedEvent* event )
+  {
+    // there are as many cells as slots, so this cannot fail
+    m_full.push( event );
+    atomic::store( mark( event ).acquired, 0 );
+#ifndef _WIN32
+    wake( m_takers, m_published );
+#endif
+  }
+
+  void EventQueue::cancel( QueuedEvent* event )
+  {
+    m_free.push( event );
+    atomic::store( mark( event ).acquired, 0 );
+#ifndef _WIN32
+    wake( m_acquirers, m_freed );
+    // a consumer may be waiting for this slot to end the stream
+    if ( closed() ) wake( m_takers, m_published );
+#endif
+  }
+
+  QueuedEvent* EventQueue::tryTake()
+  {
+    return m_full.pop();
+  }
+
+  QueuedEvent* EventQueue::take()
+  {
+    unsigned int round = 0;
+    while ( true ) {
+      QueuedEvent* e = m_full.pop();
+      if ( e ) return e;
+      // events published after close() by producers that acquired their
+      // slot before it must still be handed out
+      if ( closed() ) {
+        atomic::fence();
+        if ( !inFlight() ) return m_full.pop();
+      }
+      if ( backoff( round ) ) {
+#ifndef _WIN32
+        park( m_takers, m_published, false );
+#endif
+      }
+    }
+  }
+
+  void EventQueue::recycle( QueuedEvent* event )
+  {
+    m_free.push( event );
+#ifndef _WIN32
+    wake( m_acquirers, m_freed );
+#endif
+  }
+
+  void EventQueue::close()
+  {
+    atomic::store( m_closed, 1 );
+#ifndef _WIN32
+    pthread_mutex_lock( &m_mutex );
+    pthread_cond_broadcast( &m_freed );
+    pthread_cond_broadcast( &m_published );
+    pthread_mutex_unlock( &m_mutex );
+#endif
+  }
+
+}
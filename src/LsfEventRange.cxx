@@ -0,0 +1,124 @@
+#include "lsfData/LsfEventRange.h"
+#include "lsfData/LSFReader.h"
+
+namespace {
+
+  class RecordPredicateFilter : public lsfData::EventFilter {
+  public:
+    RecordPredicateFilter( lsfData::EventRange::RecordPredicate pred ) : m_pred(pred) {}
+    virtual bool acceptRecord( const lsfData::EventRecord& rec ) const { return m_pred( rec ); }
+  private:
+    lsfData::EventRange::RecordPredicate m_pred;
+  };
+
+  class EventPredicateFilter : public lsfData::EventFilter {
+  public:
+    EventPredicateFilter( lsfData::EventRange::EventPredicate pred ) : m_pred(pred) {}
+    virtual bool acceptEvent( const lsfData::LsfCcsds& ccsds, const lsfData::MetaEvent& meta ) const {
+      return m_pred( ccsds, meta );
+    }
+  private:
+    lsfData::EventRange::EventPredicate m_pred;
+  };
+
+}
+
+namespace lsfData {
+
+  EventRange::EventRange( LSFReader& reader )
+    : m_reader(reader), m_limit(~0ULL), m_taken(0), m_skipped(0), m_skippedRaw(0),
+      m_started(false), m_done(false)
+  {
+    m_slots.push_back( new EventSlot );
+  }
+
+  EventRange::~EventRange()
+  {
+    for ( size_t i=0; i<m_owned.size(); i++ ) delete m_owned[i];
+    for ( size_t i=0; i<m_slots.size(); i++ ) delete m_slots[i];
+  }
+
+  EventRange& EventRange::filter( RecordPredicate pred )
+  {
+    m_owned.push_back( new RecordPredicateFilter( pred ) );
+    m_filters.push_back( m_owned.back() );
+    return *this;
+  }
+
+  EventRange& EventRange::filter( EventPredicate pred )
+  {
+    m_owned.push_back( new EventPredicateFilter( pred ) );
+    m_filters.push_back( m_owned.back() );
+    return *this;
+  }
+
+  EventRange& EventRange::filter( const EventFilter& f )
+  {
+    m_filters.push_back( &f );
+    return *this;
+  }
+
+  EventRange& EventRange::take( unsigned long long n )
+  {
+    m_limit = n;
+    return *this;
+  }
+
+  EventRange::ChunkRange EventRange::chunk( size_t n )
+  {
+    if ( n == 0 ) n = 1;
+    while ( m_slots.size() < n ) m_slots.push_back( new EventSlot );
+    m_started = true;
+    return ChunkRange( this, n );
+  }
+
+  EventRange::iterator EventRange::begin()
+  {
+    if ( !m_started ) {
+      m_started = true;
+      next( *m_slots[0] );
+    }
+    return m_done ? end() : iterator( this );
+  }
+
+  bool EventRange::next( EventSlot& slot )
+  {
+    while ( !m_done ) {
+      if ( m_taken >= m_limit || !m_reader.readRecord( slot.m_record ) ) {
+        m_done = true;
+        break;
+      }
+
+      bool accepted = true;
+      for ( size_t i=0; accepted && i<m_filters.size(); i++ ) {
+        accepted = m_filters[i]->acceptRecord( slot.m_record );
+      }
+      if ( !accepted ) {
+        m_skipped++;
+        m_skippedRaw++;
+        continue;
+      }
+
+      m_reader.decode( slot.m_record, slot.m_ccsds, slot.m_meta );
+      for ( size_t i=0; accepted && i<m_filters.size(); i++ ) {
+        accepted = m_filters[i]->acceptEvent( slot.m_ccsds, slot.m_meta );
+      }
+      if ( !accepted ) {
+        m_skipped++;
+        continue;
+      }
+
+      m_taken++;
+      return true;
+    }
+    return false;
+  }
+
+  size_t EventRange::nextChunk( size_t n )
+  {
+    size_t filled = 0;
+    while ( filled < n && filled < m_slots.size() && next( *m_slots[filled] ) ) filled++;
+    return filled;
+  }
+
+}
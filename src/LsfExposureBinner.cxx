@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cmath>
+
+#include "lsfData/LsfExposureBinner.h"
+#include "lsfData/LsfTime.h"
+
+namespace {
+
+  /// the counts of an interval, spread over the bins it covers
+  struct Counts {
+    double livetime;
+    double elapsed;
+    double deadzone;
+    double discarded;
+  };
+
+  inline void accumulate( lsfData::ExposureBinner::Bin& bin, const Counts& c, double fraction )
+  {
+    bin.livetime  += c.livetime * fraction;
+    bin.elapsed   += c.elapsed * fraction;
+    bin.deadzone  += c.deadzone * fraction;
+    bin.discarded += c.discarded * fraction;
+  }
+
+  /// elapsed counts and event times may disagree by this many seconds
+  const double TOLERANCE = 1.;
+
+  /// bin indices stay well inside what a double holds exactly
+  const double INDEX_LIMIT = 4503599627370496.;   // 2^52
+
+}
+
+namespace lsfData {
+
+  ExposureBinner::ExposureBinner( double width, double origin, unsigned int bits, unsigned int maxBins )
+    : m_width( width > 0. ? width : 30. ), m_origin(origin),
+      m_mask( bits >= 64 || bits == 0 ? ~0ULL : ( 1ULL << bits ) - 1 ),
+      m_maxBins( maxBins ? maxBins : static_cast< unsigned int >( MAX_BINS ) ),
+      m_first(0), m_havePrevious(false), m_time(0.), m_intervals(0), m_rejected(0), m_outside(0)
+  {
+  }
+
+  void ExposureBinner::clear()
+  {
+    m_bins.clear();
+    m_first = 0;
+    m_havePrevious = false;
+    m_intervals = 0;
+    m_rejected = 0;
+    m_outside = 0;
+  }
+
+  bool ExposureBinner::fits( double a, double b ) const
+  {
+    double lo = std::min( a, b ), hi = std::max( a, b );
+    if ( !m_bins.empty() ) {
+      lo = std::min( lo, static_cast< double >( m_first ) );
+      hi = std::max( hi, static_cast< double >( m_first + static_cast< long long >( m_bins.size() ) - 1 ) );
+    }
+    // written so that NaN and infinite times fail every test
+    return std::fabs( lo ) < INDEX_LIMIT && std::fabs( hi ) < INDEX_LIMIT && hi - lo < m_maxBins;
+  }
+
+  ExposureBinner::Bin& ExposureBinner::bin( long long b )
+  {
+    if ( m_bins.empty() ) {
+      m_first = b;
+      m_bins.resize( 1 );
+    } else if ( b < m_first ) {
+      m_bins.insert( m_bins.begin(), static_cast< size_t >( m_first - b ), Bin() );
+      m_first = b;
+    } else if ( b >= m_first + static_cast< long long >( m_bins.size() ) ) {
+      m_bins.resize( static_cast< size_t >( b - m_first + 1 ) );
+    }
+    return m_bins[ static_cast< size_t >( b - m_first ) ];
+  }
+
+  void ExposureBinner::add( double time, const GemScalers& scalers )
+  {
+    // checked before any bin is touched, or one bogus time among real ones
+    // would have the bins stretch all the way to it
+    const double at = index( time );
+    if ( !fits( at, at ) ) {
+      m_outside++;
+      return;
+    }
+    const long long last = static_cast< long long >( at );
+
+    if ( m_havePrevious ) {
+      const double tps = Time::TICKS_PER_SECOND;
+      Counts c;
+      c.elapsed   = delta( scalers.elapsed(), m_scalers.elapsed() ) / tps;
+      c.livetime  = delta( scalers.livetime(), m_scalers.livetime() ) / tps;
+      c.deadzone  = static_cast< double >( delta( scalers.deadzone(), m_scalers.deadzone() ) );
+      c.discarded = static_cast< double >( delta( scalers.discarded(), m_scalers.discarded() ) );
+
+      const double span = time - m_time;
+      if ( std::fabs( c.elapsed - std::max( span, 0. ) ) > TOLERANCE ) {
+        m_rejected++;
+      } else if ( span <= 0. ) {
+        // no time to spread over
+        accumulate( bin( last ), c, 1. );
+        m_intervals++;
+      } else if ( !fits( index( m_time ), at ) ) {
+        // restart() from an event far from these bins
+        m_rejected++;
+      } else {
+        const long long first = binOf( m_time );
+        for ( long long b=first; b<=last; b++ ) {
+          const double lo = std::max( m_time, m_origin + b * m_width );
+          const double hi = std::min( time, m_origin + ( b + 1 ) * m_width );
+          if ( hi > lo ) accumulate( bin( b ), c, ( hi - lo ) / span );
+        }
+        m_intervals++;
+      }
+    }
+    bin( last ).events++;
+
+    m_havePrevious = true;
+    m_time = time;
+    m_scalers = scalers;
+  }
+
+  bool ExposureBinner::merge( const ExposureBinner& other )
+  {
+    if ( &other == this ) {
+      const ExposureBinner copy( other );
+      return merge( copy );
+    }
+    if ( other.m_width != m_width || other.m_origin != m_origin ) return false;
+    if ( !other.m_bins.empty() ) {
+      // touch both ends first so the vector grows at most twice
+      bin( other.m_first );
+      bin( other.m_first + static_cast< long long >( other.m_bins.size() ) - 1 );
+      for ( size_t i=0; i<other.m_bins.size(); i++ ) {
+        Bin& b = m_bins[ static_cast< size_t >( other.m_first - m_first ) + i ];
+        const Bin& o = other.m_bins[i];
+        b.livetime  += o.livetime;
+        b.elapsed   += o.elapsed;
+        b.deadzone  += o.deadzone;
+        b.discarded += o.discarded;
+        b.events    += o.events;
+      }
+    }
+    m_intervals += other.m_intervals;
+    m_rejected += other.m_rejected;
+    m_outside += other.m_outside;
+    return true;
+  }
+
+  ExposureBinner::Bin ExposureBinner::total() const
+  {
+    Bin t;
+    for ( size_t i=0; i<m_bins.size(); i++ ) {
+      t.livetime  += m_bins[i].livetime;
+      t.elapsed   += m_bins[i].elapsed;
+      t.deadzone  += m_bins[i].deadzone;
+      t.discarded += m_bins[i].discarded;
+      t.events    += m_bins[i].events;
+    }
+    return t;
+  }
+
+}
@@ -0,0 +1,206 @@
+#include "lsfData/LsfFormatter.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfRunInfo.h"
+#include "lsfData/LsfDatagramInfo.h"
+#include "lsfData/LsfGemScalers.h"
+#include "lsfData/LsfGemTime.h"
+#include "lsfData/LsfTime.h"
+#include "lsfData/LsfKeys.h"
+#include "lsfData/LpaHandler.h"
+
+namespace lsfData {
+
+  TextBuffer& Formatter::field( TextBuffer& b, const std::string& str, const char* name )
+  {
+    return b.append( str ).append( ' ' ).append( name ).append( " = " );
+  }
+
+  void Formatter::format( TextBuffer& b, const LsfCcsds& obj, const std::string& str )
+  {
+    field( b, str, "scid" ).dec( obj.getScid() ).append( '\n' );
+    field( b, str, "apid" ).dec( obj.getApid() ).append( '\n' );
+    field( b, str, "utc " ).fixed( obj.getUtc(), 18, 6 ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const RunInfo& obj )
+  {
+    b.append( " run:      groundid = 0x" ).hex( obj.id(), 8, true )
+     .append( ", started = 0x" ).hex( obj.startTime(), 8, true )
+     .append( " (" ).dec( obj.startTime() ).append( ")\n" );
+    b.append( " run:      platform = (" ).dec( obj.platform() ).append( ")\n" );
+    b.append( " run:      origin = (" ).dec( obj.dataOrigin() ).append( ")\n" );
+    b.append( " dataTransferId: " ).dec( obj.dataTransferId() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const DatagramInfo& obj )
+  {
+    // printed with %d
+    b.append( " open:     nmodes = " ).dec( static_cast< int >( obj.modeChanges() ) )
+     .append( ", ndgms = " ).dec( static_cast< int >( obj.datagrams() ) ).append( '\n' );
+    b.append( " open:     action = (" ).dec( obj.openAction() ).append( ")\n" );
+    b.append( " open:     reason = (" ).dec( obj.openReason() ).append( ")\n" );
+    b.append( " open:     crate = (" ).dec( obj.crate() ).append( ")\n" );
+    b.append( " open:     mode = (" ).dec( obj.mode() ).append( ")\n" );
+    b.append( " close:    action = (" ).dec( obj.closeAction() ).append( ")\n" );
+    b.append( " close:    reason = (" ).dec( obj.closeReason() ).append( ")\n" );
+  }
+
+  void Formatter::format( TextBuffer& b, const GemScalers& obj )
+  {
+    const char* names[6] = { "elapsed  ", "livetime ", "prescaled", "discarded", "sequence ", "deadzone " };
+    const unsigned long long values[6] = { obj.elapsed(), obj.livetime(), obj.prescaled(),
+                                           obj.discarded(), obj.sequence(), obj.deadzone() };
+    for ( int i=0; i<6; i++ ) {
+      b.append( " scalers:  " ).append( names[i] ).append( " = 0x" ).hex( values[i], 16 )
+       .append( " = " ).dec( values[i] ).append( " \n" );
+    }
+  }
+
+  void Formatter::format( TextBuffer& b, const GemTime& obj, const std::string& str )
+  {
+    b.append( str ).append( "tics  = 0x" ).hex( obj.ticks(), 8, true )
+     .append( " (" ).dec( obj.ticks() ).append( ")\n" );
+    b.append( str ).append( "hacks = 0x" ).hex( obj.hacks(), 8, true )
+     .append( " (" ).dec( obj.hacks() ).append( ")\n" );
+  }
+
+  void Formatter::format( TextBuffer& b, const Time& obj )
+  {
+    const std::string indent( " " );
+    b.append( " trigger:  tics = 0x" ).hex( obj.timeTicks(), 8, true )
+     .append( " (" ).dec( obj.timeTicks() ).append( ")\n" );
+    format( b, obj.timeHack(), indent );
+    b.append( " current:  secs = " ).dec( obj.current().timeSecs() ).append( '\n' );
+    format( b, obj.current().timeHack(), indent );
+    b.append( " previous:  secs = " ).dec( obj.previous().timeSecs() ).append( '\n' );
+    format( b, obj.previous().timeHack(), indent );
+  }
+
+  void Formatter::format( TextBuffer& b, const Configuration& obj, const std::string& str )
+  {
+    if ( const LciAcdConfiguration* acd = obj.castToLciAcdConfig() ) {
+      format( b, *acd, str );
+    } else if ( const LciCalConfiguration* cal = obj.castToLciCalConfig() ) {
+      format( b, *cal, str );
+    } else if ( const LciTkrConfiguration* tkr = obj.castToLciTkrConfig() ) {
+      format( b, *tkr, str );
+    } else if ( const LciConfiguration* lci = obj.castToLciConfig() ) {
+      format( b, *lci, str );
+    } else if ( const LpaConfiguration* lpa = obj.castToLpaConfig() ) {
+      format( b, *lpa, str );
+    } else {
+      b.append( str ).append( '\n' );
+    }
+  }
+
+  void Formatter::format( TextBuffer& b, const LpaConfiguration& obj, const std::string& str )
+  {
+    field( b, str, "softwareKey" ).append( "0x" ).hex( obj.softwareKey(), 8 ).append( '\n' );
+    field( b, str, "hardwareKey" ).append( "0x" ).hex( obj.hardwareKey(), 8 ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciConfiguration& obj, const std::string& str )
+  {
+    field( b, str, "softwareKey" ).append( "0x" ).hex( obj.softwareKey(), 8 ).append( '\n' );
+    field( b, str, "writeCfg" ).append( "0x" ).hex( obj.writeCfg(), 8 ).append( '\n' );
+    field( b, str, "readCfg" ).append( "0x" ).hex( obj.readCfg(), 8 ).append( '\n' );
+    field( b, str, "period" ).dec( obj.period() ).append( '\n' );
+    field( b, str, "flags" ).dec( obj.flags() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciAcdConfiguration& obj, const std::string& str )
+  {
+    field( b, str, "injected" ).dec( obj.injected() ).append( '\n' );
+    field( b, str, "threshold" ).dec( obj.threshold() ).append( '\n' );
+    field( b, str, "biasDac" ).dec( obj.biasDac() ).append( '\n' );
+    field( b, str, "holdDelay" ).dec( obj.holdDelay() ).append( '\n' );
+    field( b, str, "hitmapDelay" ).dec( obj.hitmapDelay() ).append( '\n' );
+    field( b, str, "range" ).dec( obj.range() ).append( '\n' );
+    format( b, obj.trigger(), str );
+    format( b, obj.channel(), str );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciCalConfiguration& obj, const std::string& str )
+  {
+    field( b, str, "uld" ).dec( obj.uld() ).append( '\n' );
+    field( b, str, "injected" ).dec( obj.injected() ).append( '\n' );
+    field( b, str, "delay" ).dec( obj.delay() ).append( '\n' );
+    field( b, str, "firstRange" ).dec( obj.firstRange() ).append( '\n' );
+    field( b, str, "threshold" ).dec( obj.threshold() ).append( '\n' );
+    field( b, str, "calibGain" ).dec( obj.calibGain() ).append( '\n' );
+    field( b, str, "highCalEna" ).dec( obj.highCalEna() ).append( '\n' );
+    field( b, str, "highRngEna" ).dec( obj.highRngEna() ).append( '\n' );
+    field( b, str, "highGain" ).dec( obj.highGain() ).append( '\n' );
+    field( b, str, "lowCalEna" ).dec( obj.lowCalEna() ).append( '\n' );
+    field( b, str, "lowRngEna" ).dec( obj.lowRngEna() ).append( '\n' );
+    field( b, str, "lowGain" ).dec( obj.lowGain() ).append( '\n' );
+    format( b, obj.trigger(), str );
+    format( b, obj.channel() );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciTkrConfiguration& obj, const std::string& str )
+  {
+    field( b, str, "injected" ).dec( obj.injected() ).append( '\n' );
+    field( b, str, "delay" ).dec( obj.delay() ).append( '\n' );
+    field( b, str, "threshold" ).dec( obj.threshold() ).append( '\n' );
+    field( b, str, "splitLow" ).dec( obj.splitLow() ).append( '\n' );
+    field( b, str, "splitHigh" ).dec( obj.splitHigh() ).append( '\n' );
+    format( b, obj.channel() );
+  }
+
+  void Formatter::format( TextBuffer& b, const Channel& obj, const std::string& str )
+  {
+    field( b, str, "single" ).dec( obj.single() ).append( '\n' );
+    field( b, str, "all" ).dec( obj.all() ).append( '\n' );
+    field( b, str, "latc" ).dec( obj.latc() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciAcdConfiguration::AcdTrigger& obj, const std::string& str )
+  {
+    field( b, str, "veto" ).dec( obj.veto() ).append( '\n' );
+    field( b, str, "vetoVernier" ).dec( obj.vetoVernier() ).append( '\n' );
+    field( b, str, "highLevelDiscrim" ).dec( obj.highDiscrim() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciCalConfiguration::CalTrigger& obj, const std::string& str )
+  {
+    field( b, str, "le" ).dec( obj.le() ).append( '\n' );
+    field( b, str, "lowTraEna" ).dec( obj.lowTrgEna() ).append( '\n' );
+    field( b, str, "he" ).dec( obj.he() ).append( '\n' );
+    field( b, str, "highTraEna" ).dec( obj.highTrgEna() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LsfKeys& obj, const std::string& str )
+  {
+    if ( const LpaKeys* lpa = obj.castToLpaKeys() ) {
+      format( b, *lpa, str );
+    } else if ( const LciKeys* lci = obj.castToLciKeys() ) {
+      format( b, *lci, str );
+    } else {
+      field( b, str, "LATC_master" ).append( "0x" ).hex( obj.LATC_master(), 8 ).append( '\n' );
+      field( b, str, "LATC_ignore" ).append( "0x" ).hex( obj.LATC_ignore(), 8 ).append( '\n' );
+    }
+  }
+
+  void Formatter::format( TextBuffer& b, const LpaKeys& obj, const std::string& str )
+  {
+    field( b, str, "LATC_master" ).append( "0x" ).hex( obj.LATC_master(), 8 ).append( '\n' );
+    field( b, str, "LATC_ignore" ).append( "0x" ).hex( obj.LATC_ignore(), 8 ).append( '\n' );
+    // std::cout is still in hex here
+    b.append( str ).append( " SBS: " ).hex( obj.sbs() )
+     .append( " LPA_DB: " ).hex( obj.lpa_db() ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LciKeys& obj, const std::string& str )
+  {
+    field( b, str, "LATC_master" ).append( "0x" ).hex( obj.LATC_master(), 8 ).append( '\n' );
+    field( b, str, "LATC_ignore" ).append( "0x" ).hex( obj.LATC_ignore(), 8 ).append( '\n' );
+    field( b, str, "LCI_script" ).append( "0x" ).hex( obj.LCI_script(), 8 ).append( '\n' );
+  }
+
+  void Formatter::format( TextBuffer& b, const LpaHandler& /*obj*/, const std::string& str )
+  {
+    b.append( str ).append( '\n' );
+  }
+
+}
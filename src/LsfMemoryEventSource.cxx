@@ -0,0 +1,74 @@
+#include "lsfData/LsfMemoryEventSource.h"
+
+namespace lsfData {
+
+  bool MemoryEventSource::read( eventFile::LSE_Context&        ctx,
+                                eventFile::EBF_Data&           ebf,
+                                eventFile::LSE_Info::InfoType& infotype,
+                                eventFile::LPA_Info&           pinfo,
+                                eventFile::LCI_ACD_Info&       ainfo,
+                                eventFile::LCI_CAL_Info&       cinfo,
+                                eventFile::LCI_TKR_Info&       tinfo,
+                                eventFile::LSE_Keys::KeysType& ktype,
+                                eventFile::LPA_Keys&           pakeys,
+                                eventFile::LCI_Keys&           cikeys )
+  {
+    if ( m_next >= m_records.size() ) return false;
+    const Record& rec = m_records[m_next++];
+
+    ctx = rec.ctx;
+    ebf = rec.ebf;
+
+    infotype = rec.infotype;
+    switch ( infotype ) {
+    case eventFile::LSE_Info::LPA:
+      pinfo = rec.pinfo;
+      break;
+    case eventFile::LSE_Info::LCI_ACD:
+      ainfo = rec.ainfo;
+      break;
+    case eventFile::LSE_Info::LCI_CAL:
+      cinfo = rec.cinfo;
+      break;
+    case eventFile::LSE_Info::LCI_TKR:
+      tinfo = rec.tinfo;
+      break;
+    default:
+      break;
+    }
+
+    ktype = rec.ktype;
+    switch ( ktype ) {
+    case eventFile::LSE_Keys::LPA:
+      pakeys = rec.pakeys;
+      break;
+    case eventFile::LSE_Keys::LCI:
+      cikeys = rec.cikeys;
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+  unsigned int MemoryEventSource::begSec() const
+  {
+    return m_records.empty() ? 0 : static_cast< unsigned int >( m_records.front().ctx.ccsds.utc );
+  }
+
+  unsigned int MemoryEventSource::endSec() const
+  {
+    return m_records.empty() ? 0 : static_cast< unsigned int >( m_records.back().ctx.ccsds.utc );
+  }
+
+  unsigned long long MemoryEventSource::begGEM() const
+  {
+    return m_records.empty() ? 0 : m_records.front().ctx.scalers.sequence;
+  }
+
+  unsigned long long MemoryEventSource::endGEM() const
+  {
+    return m_records.empty() ? 0 : m_records.back().ctx.scalers.sequence;
+  }
+
+}
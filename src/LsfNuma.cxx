@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "lsfData/LsfNuma.h"
+#include "lsfData/LsfAtomic.h"
+
+namespace {
+
+  volatile unsigned int s_local = 0;
+  volatile unsigned int s_remote = 0;
+  volatile unsigned int s_unknown = 0;
+
+  /// parse a sysfs list such as "0-3,8-11"
+  void parseList( const char* text, std::vector< int >& out )
+  {
+    const char* p = text;
+    while ( *p ) {
+      char* end;
+      const long first = strtol( p, &end, 10 );
+      if ( end == p ) break;
+      long last = first;
+      p = end;
+      if ( *p == '-' ) {
+        last = strtol( p + 1, &end, 10 );
+        p = end;
+      }
+      for ( long i=first; i<=last; i++ ) out.push_back( static_cast< int >( i ) );
+      if ( *p == ',' ) p++;
+      else break;
+    }
+  }
+
+  // memory policies of <linux/mempolicy.h>
+  enum { MPOL_DEFAULT_ = 0, MPOL_PREFERRED_ = 1 };
+
+  /// the node mask and its size in bits, as mbind and set_mempolicy take them
+  struct NodeMask {
+    enum { WORDS = 16, BITS = 8 * sizeof(unsigned long) };
+    explicit NodeMask( int node ) {
+      for ( int i=0; i<WORDS; i++ ) bits[i] = 0;
+      if ( node >= 0 && node < WORDS * BITS ) bits[ node / BITS ] |= 1UL << ( node % BITS );
+    }
+    // the kernel reads one bit less than it is told
+    unsigned long size() const { return WORDS * BITS + 1; }
+    unsigned long bits[ WORDS ];
+  };
+
+  bool readList( const char* path, std::vector< int >& out )
+  {
+    FILE* f = fopen( path, "r" );
+    if ( !f ) return false;
+    char buf[4096];
+    const bool ok = fgets( buf, sizeof(buf), f ) != 0;
+    fclose( f );
+    if ( ok ) parseList( buf, out );
+    return ok;
+  }
+
+}
+
+namespace lsfData {
+
+  int Numa::nodes()
+  {
+    std::vector< int > online;
+    if ( !readList( "/sys/devices/system/node/online", online ) || online.empty() ) return 1;
+    return online.back() + 1;
+  }
+
+  bool Numa::cpus( int node, std::vector< int >& cpus )
+  {
+    cpus.clear();
+    char path[128];
+    sprintf( path, "/sys/devices/system/node/node%d/cpulist", node );
+    return readList( path, cpus ) && !cpus.empty();
+  }
+
+  bool Numa::bindThread( int node )
+  {
+#if defined(__linux__) && defined(CPU_SET)
+    std::vector< int > list;
+    if ( node < 0 || !cpus( node, list ) ) return false;
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for ( size_t i=0; i<list.size(); i++ ) {
+      if ( list[i] < CPU_SETSIZE ) CPU_SET( list[i], &set );
+    }
+    // pid 0 is the calling thread
+    return sched_setaffinity( 0, sizeof(set), &set ) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+  }
+
+  bool Numa::bindMemory( int node )
+  {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    if ( node < 0 ) return syscall( SYS_set_mempolicy, MPOL_DEFAULT_, 0, 0UL ) == 0;
+    const NodeMask mask( node );
+    return syscall( SYS_set_mempolicy, MPOL_PREFERRED_, mask.bits, mask.size() ) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+  }
+
+  bool Numa::bind( int node )
+  {
+    const bool cpus = bindThread( node );
+    return bindMemory( node ) && cpus;
+  }
+
+  void* Numa::allocate( size_t n, int node )
+  {
+#if defined(__linux__) && defined(SYS_mbind)
+    if ( node >= 0 ) {
+      void* p = mmap( 0, n ? n : 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+      if ( p == MAP_FAILED ) return 0;
+      // nothing is touched yet, so every page will be placed by the policy;
+      // if the kernel refuses, the memory is still usable, just not placed
+      const NodeMask mask( node );
+      syscall( SYS_mbind, p, n ? n : 1, MPOL_PREFERRED_, mask.bits, mask.size(), 0U );
+      return p;
+    }
+#else
+    (void)node;
+#endif
+    return ::operator new( n, std::nothrow );
+  }
+
+  void Numa::release( void* p, size_t n, int node )
+  {
+    if ( !p ) return;
+#if defined(__linux__) && defined(SYS_mbind)
+    if ( node >= 0 ) {
+      munmap( p, n ? n : 1 );
+      return;
+    }
+#else
+    (void)n;
+    (void)node;
+#endif
+    ::operator delete( p );
+  }
+
+  int Numa::currentNode()
+  {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0, node = 0;
+    if ( syscall( SYS_getcpu, &cpu, &node, 0 ) == 0 ) return static_cast< int >( node );
+#endif
+    return -1;
+  }
+
+  int Numa::nodeOf( const void* p )
+  {
+#if defined(__linux__) && defined(SYS_move_pages)
+    if ( !p ) return -1;
+    // with no target nodes, move_pages only reports where each page is
+    const unsigned long pagesize = static_cast< unsigned long >( sysconf( _SC_PAGESIZE ) );
+    void* page = reinterpret_cast< void* >( reinterpret_cast< unsigned long >( p ) & ~( pagesize - 1 ) );
+    int status = -1;
+    if ( syscall( SYS_move_pages, 0, 1UL, &page, 0, &status, 0 ) == 0 && status >= 0 ) return status;
+#else
+    (void)p;
+#endif
+    return -1;
+  }
+
+  void Numa::account( const void* p )
+  {
+    const int here = currentNode();
+    const int there = nodeOf( p );
+    if ( here < 0 || there < 0 ) atomic::add( s_unknown, 1 );
+    else if ( here == there ) atomic::add( s_local, 1 );
+    else atomic::add( s_remote, 1 );
+  }
+
+  void Numa::counters( Counters& c )
+  {
+    c.local   = atomic::load( s_local );
+    c.remote  = atomic::load( s_remote );
+    c.unknown = atomic::load( s_unknown );
+  }
+
+  void Numa::resetCounters()
+  {
+    atomic::store( s_local, 0 );
+    atomic::store( s_remote, 0 );
+    atomic::store( s_unknown, 0 );
+  }
+
+}
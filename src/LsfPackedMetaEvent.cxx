@@ -0,0 +1,397 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "lsfData/LsfPackedMetaEvent.h"
+#include "lsfData/LsfMetaEvent.h"
+
+namespace {
+  // the hot record is meant to fill exactly two cache lines
+  typedef char PackedMetaEventIs128Bytes[ sizeof(lsfData::PackedMetaEvent) == 128 ? 1 : -1 ];
+
+  template < class H >
+  void packHandler( const H* h, lsfData::PackedMetaEvent::Handler which, lsfData::PackedMetaEvent& p )
+  {
+    if ( !h ) {
+      p.state[which] = 0;
+      p.prescaler[which] = 0;
+      return;
+    }
+    p.handlers |= static_cast< unsigned char >( 1u << which );
+    p.state[which] = static_cast< unsigned char >( h->state() );
+    p.prescaler[which] = static_cast< unsigned char >( h->prescaler() );
+  }
+
+  void summarize( const lsfData::LpaHandler& h, lsfData::PackedHandler& s )
+  {
+    s.masterKey      = h.masterKey();
+    s.cfgKey         = h.cfgKey();
+    s.cfgId          = h.cfgId();
+    s.version        = h.version();
+    s.prescaleFactor = h.prescaleFactor();
+    s.state          = h.state();
+    s.prescaler      = h.prescaler();
+    s.id             = h.id();
+    s.has            = h.has();
+    s.rsd            = 0;
+    s.status = s.stage = s.energyValid = 0;
+    s.energyInLeus = 0;
+  }
+
+  // the handlers with a single RSD status word
+  template < class H >
+  void summarize( const H& h, lsfData::PackedHandler& s )
+  {
+    summarize( h.lpaHandler(), s );
+    if ( h.rsd() ) {
+      s.rsd = 1;
+      s.status = h.rsd()->status();
+    }
+  }
+
+  void summarize( const lsfData::GammaHandler& h, lsfData::PackedHandler& s )
+  {
+    summarize( h.lpaHandler(), s );
+    if ( h.rsd() ) {
+      s.rsd = 1;
+      s.status       = h.rsd()->status();
+      s.stage        = h.rsd()->stage();
+      s.energyValid  = h.rsd()->energyValid();
+      s.energyInLeus = h.rsd()->energyInLeus();
+    }
+  }
+
+  template < class H >
+  void restore( const lsfData::PackedHandler& s, H& h )
+  {
+    h.set( s.masterKey, s.cfgKey, s.cfgId,
+           static_cast< enums::Lsf::RsdState >( s.state ),
+           static_cast< enums::Lsf::LeakedPrescaler >( s.prescaler ),
+           s.version, static_cast< enums::Lsf::HandlerId >( s.id ), s.has != 0, s.prescaleFactor );
+    if ( s.rsd ) h.setStatus( s.status );
+  }
+
+  void restore( const lsfData::PackedHandler& s, lsfData::GammaHandler& h )
+  {
+    h.set( s.masterKey, s.cfgKey, s.cfgId,
+           static_cast< enums::Lsf::RsdState >( s.state ),
+           static_cast< enums::Lsf::LeakedPrescaler >( s.prescaler ),
+           s.version, static_cast< enums::Lsf::HandlerId >( s.id ), s.has != 0, s.prescaleFactor );
+    if ( s.rsd ) h.setStatus( s.status, s.stage, s.energyValid, s.energyInLeus );
+  }
+
+  void restore( const lsfData::PackedHandler& s, lsfData::LpaHandler& h )
+  {
+    h.set( s.masterKey, s.cfgKey, s.cfgId,
+           static_cast< enums::Lsf::RsdState >( s.state ),
+           static_cast< enums::Lsf::LeakedPrescaler >( s.prescaler ),
+           s.version, static_cast< enums::Lsf::HandlerId >( s.id ), s.has != 0 );
+    h.setPrescaleFactor( s.prescaleFactor );
+  }
+
+  bool sameChannel( const lsfData::Channel& a, const lsfData::Channel& b )
+  {
+    return a.single() == b.single() && a.all() == b.all() && a.latc() == b.latc();
+  }
+
+  bool sameConfiguration( const lsfData::Configuration* a, const lsfData::Configuration* b )
+  {
+    if ( !a || !b ) return a == b;
+    if ( a->type() != b->type() ) return false;
+    if ( const lsfData::LpaConfiguration* pa = a->castToLpaConfig() ) {
+      const lsfData::LpaConfiguration* pb = b->castToLpaConfig();
+      return pa->hardwareKey() == pb->hardwareKey() && pa->softwareKey() == pb->softwareKey();
+    }
+    const lsfData::LciConfiguration* la = a->castToLciConfig();
+    const lsfData::LciConfiguration* lb = b->castToLciConfig();
+    if ( !la || !lb ) return la == lb;
+    if ( la->softwareKey() != lb->softwareKey() || la->writeCfg() != lb->writeCfg()
+         || la->readCfg() != lb->readCfg() || la->period() != lb->period()
+         || la->flags() != lb->flags() ) return false;
+    if ( const lsfData::LciAcdConfiguration* ca = a->castToLciAcdConfig() ) {
+      const lsfData::LciAcdConfiguration* cb = b->castToLciAcdConfig();
+      return ca->injected() == cb->injected() && ca->threshold() == cb->threshold()
+        && ca->biasDac() == cb->biasDac() && ca->holdDelay() == cb->holdDelay()
+        && ca->hitmapDelay() == cb->hitmapDelay() && ca->range() == cb->range()
+        && ca->trigger().veto() == cb->trigger().veto()
+        && ca->trigger().vetoVernier() == cb->trigger().vetoVernier()
+        && ca->trigger().highDiscrim() == cb->trigger().highDiscrim()
+        && sameChannel( ca->channel(), cb->channel() );
+    }
+    if ( const lsfData::LciCalConfiguration* ca = a->castToLciCalConfig() ) {
+      const lsfData::LciCalConfiguration* cb = b->castToLciCalConfig();
+      return ca->uld() == cb->uld() && ca->injected() == cb->injected()
+        && ca->delay() == cb->delay() && ca->firstRange() == cb->firstRange()
+        && ca->threshold() == cb->threshold() && ca->calibGain() == cb->calibGain()
+        && ca->highCalEna() == cb->highCalEna() && ca->highRngEna() == cb->highRngEna()
+        && ca->highGain() == cb->highGain() && ca->lowCalEna() == cb->lowCalEna()
+        && ca->lowRngEna() == cb->lowRngEna() && ca->lowGain() == cb->lowGain()
+        && ca->trigger().le() == cb->trigger().le()
+        && ca->trigger().lowTrgEna() == cb->trigger().lowTrgEna()
+        && ca->trigger().he() == cb->trigger().he()
+        && ca->trigger().highTrgEna() == cb->trigger().highTrgEna()
+        && sameChannel( ca->channel(), cb->channel() );
+    }
+    if ( const lsfData::LciTkrConfiguration* ca = a->castToLciTkrConfig() ) {
+      const lsfData::LciTkrConfiguration* cb = b->castToLciTkrConfig();
+      return ca->injected() == cb->injected() && ca->delay() == cb->delay()
+        && ca->threshold() == cb->threshold() && ca->splitLow() == cb->splitLow()
+        && ca->splitHigh() == cb->splitHigh() && sameChannel( ca->channel(), cb->channel() );
+    }
+    return true;
+  }
+
+  bool sameKeys( const lsfData::LsfKeys* a, const lsfData::LsfKeys* b )
+  {
+    if ( !a || !b ) return a == b;
+    if ( a->type() != b->type() || a->LATC_master() != b->LATC_master()
+         || a->LATC_ignore() != b->LATC_ignore() ) return false;
+    if ( const lsfData::LpaKeys* pa = a->castToLpaKeys() ) {
+      const lsfData::LpaKeys* pb = b->castToLpaKeys();
+      return pb && pa->sbs() == pb->sbs() && pa->lpa_db() == pb->lpa_db();
+    }
+    if ( const lsfData::LciKeys* ca = a->castToLciKeys() ) {
+      const lsfData::LciKeys* cb = b->castToLciKeys();
+      return cb && ca->LCI_script() == cb->LCI_script();
+    }
+    return true;
+  }
+
+  bool sameRun( const lsfData::RunInfo& a, const lsfData::RunInfo& b )
+  {
+    return a.id() == b.id() && a.startTime() == b.startTime()
+      && a.platform() == b.platform() && a.dataOrigin() == b.dataOrigin()
+      && a.dataTransferId() == b.dataTransferId();
+  }
+}
+
+namespace lsfData {
+
+  void PackedMetaEvent::pack( const MetaEvent& meta )
+  {
+    const GemScalers& s = meta.scalers();
+    elapsed   = s.elapsed();
+    livetime  = s.livetime();
+    prescaled = s.prescaled();
+    discarded = s.discarded();
+    sequence  = s.sequence();
+    deadzone  = s.deadzone();
+
+    const Time& t = meta.time();
+    timeTicks = t.timeTicks();
+    hackHacks = t.timeHack().hacks();
+    hackTicks = t.timeHack().ticks();
+    currentSecs        = t.current().timeSecs();
+    currentHacks       = t.current().timeHack().hacks();
+    currentTicks       = t.current().timeHack().ticks();
+    currentIncomplete  = t.current().incomplete();
+    currentFlywheeling = t.current().flywheeling();
+    currentFlags       = t.current().flags();
+    previousSecs        = t.previous().timeSecs();
+    previousHacks       = t.previous().timeHack().hacks();
+    previousTicks       = t.previous().timeHack().ticks();
+    previousIncomplete  = t.previous().incomplete();
+    previousFlywheeling = t.previous().flywheeling();
+    previousFlags       = t.previous().flags();
+
+    handlers = 0;
+    packHandler( meta.gammaFilter(), Gamma, *this );
+    packHandler( meta.mipFilter(), Mip, *this );
+    packHandler( meta.hipFilter(), Hip, *this );
+    packHandler( meta.dgnFilter(), Dgn, *this );
+    packHandler( meta.passthruFilter(), Passthru, *this );
+
+    runType  = static_cast< unsigned char >( meta.configuration() ? meta.configuration()->type()
+                                                                   : enums::Lsf::NoRunType );
+    keysType = static_cast< unsigned char >( meta.keys() ? meta.keys()->type()
+                                                         : enums::Lsf::NoKeysType );
+    memset( pad, 0, sizeof(pad) );
+  }
+
+  PackedEventArray::PackedEventArray( BufferArena::Pages pages )
+    : m_raw(0), m_hot(0), m_size(0), m_capacity(0), m_pages(pages), m_huge(false)
+  {
+  }
+
+  PackedEventArray::~PackedEventArray()
+  {
+    clear();
+    release();
+  }
+
+  void PackedEventArray::release()
+  {
+    if ( m_pages == BufferArena::HugePages ) {
+      BufferArena::unmap( m_raw, m_capacity * sizeof(PackedMetaEvent) );
+    } else {
+      free( m_raw );
+    }
+  }
+
+  void PackedEventArray::reserve( size_t n )
+  {
+    if ( n <= m_capacity ) return;
+    char* raw;
+    PackedMetaEvent* hot;
+    bool huge = false;
+    if ( m_pages == BufferArena::HugePages ) {
+      // mapped blocks start on a huge page boundary
+      raw = static_cast< char* >( BufferArena::map( n * sizeof(PackedMetaEvent), m_pages, huge ) );
+      if ( !raw ) throw std::bad_alloc();
+      hot = reinterpret_cast< PackedMetaEvent* >( raw );
+    } else {
+      // malloc only promises the alignment of the largest basic type
+      raw = static_cast< char* >( malloc( n * sizeof(PackedMetaEvent) + ALIGNMENT ) );
+      if ( !raw ) throw std::bad_alloc();
+      const size_t misalign = reinterpret_cast< size_t >( raw ) % ALIGNMENT;
+      hot = reinterpret_cast< PackedMetaEvent* >( raw + ( misalign ? ALIGNMENT - misalign : 0 ) );
+    }
+    if ( m_size ) memcpy( hot, m_hot, m_size * sizeof(PackedMetaEvent) );
+    release();
+    m_raw = raw;
+    m_hot = hot;
+    m_capacity = n;
+    m_huge = huge;
+    m_cold.reserve( n );
+  }
+
+  unsigned int PackedEventArray::context( const MetaEvent& meta )
+  {
+    // events come in runs, so only the last context is worth comparing with
+    if ( !m_contexts.empty() ) {
+      const PackedContext& last = m_contexts.back();
+      if ( last.mootKey == meta.mootKey() && sameRun( last.run, meta.run() )
+           && sameConfiguration( last.configuration, meta.configuration() )
+           && sameKeys( last.keys, meta.keys() ) && last.mootAlias == meta.mootAlias() ) {
+        return static_cast< unsigned int >( m_contexts.size() - 1 );
+      }
+    }
+    PackedContext c;
+    c.run = meta.run();
+    c.configuration = 0;
+    c.keys = 0;
+    c.mootKey = meta.mootKey();
+    c.mootAlias = meta.mootAlias();
+    m_contexts.push_back( c );
+    PackedContext& added = m_contexts.back();
+    if ( meta.configuration() ) added.configuration = meta.configuration()->clone();
+    if ( meta.keys() ) added.keys = meta.keys()->clone();
+    return static_cast< unsigned int >( m_contexts.size() - 1 );
+  }
+
+  void PackedEventArray::push_back( const MetaEvent& meta )
+  {
+    if ( m_size == m_capacity ) reserve( m_capacity ? 2 * m_capacity : 1024 );
+
+    PackedColdEvent c;
+    c.datagram = meta.datagram();
+    c.compressionLevel = meta.compressionLevel();
+    c.compressedSize = meta.compressedSize();
+    c.context = context( meta );
+    c.handler = static_cast< unsigned int >( m_handlers.size() );
+    c.handlers = 0;
+
+    // the handler summaries, in the order of the bits
+    PackedHandler h;
+    if ( meta.gammaFilter() ) {
+      summarize( *meta.gammaFilter(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedMetaEvent::Gamma;
+    }
+    if ( meta.mipFilter() ) {
+      summarize( *meta.mipFilter(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedMetaEvent::Mip;
+    }
+    if ( meta.hipFilter() ) {
+      summarize( *meta.hipFilter(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedMetaEvent::Hip;
+    }
+    if ( meta.dgnFilter() ) {
+      summarize( *meta.dgnFilter(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedMetaEvent::Dgn;
+    }
+    if ( meta.passthruFilter() ) {
+      summarize( *meta.passthruFilter(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedMetaEvent::Passthru;
+    }
+    if ( meta.lpaHandler() ) {
+      summarize( *meta.lpaHandler(), h );
+      m_handlers.push_back( h );
+      c.handlers |= 1u << PackedColdEvent::Lpa;
+    }
+    m_cold.push_back( c );
+
+    PackedMetaEvent& p = m_hot[m_size++];
+    p.pack( meta );
+    p.cold = static_cast< unsigned int >( m_cold.size() - 1 );
+  }
+
+  void PackedEventArray::clear()
+  {
+    for ( size_t i=0; i<m_contexts.size(); i++ ) {
+      delete m_contexts[i].configuration;
+      delete m_contexts[i].keys;
+    }
+    m_contexts.clear();
+    m_handlers.clear();
+    m_cold.clear();
+    m_size = 0;
+  }
+
+  void PackedEventArray::unpack( size_t i, MetaEvent& meta ) const
+  {
+    const PackedMetaEvent& p = m_hot[i];
+    const PackedColdEvent& c = m_cold[p.cold];
+    const PackedContext& x = m_contexts[c.context];
+
+    meta.clear();
+    meta.setRun( x.run );
+    meta.setDatagram( c.datagram );
+    meta.setScalers( p.scalers() );
+    meta.setTime( p.time() );
+    if ( x.configuration ) meta.setConfiguration( *x.configuration );
+    if ( x.keys ) meta.setKeys( *x.keys );
+
+    const PackedHandler* h = c.handlers ? &m_handlers[c.handler] : 0;
+    if ( c.handlers & ( 1u << PackedMetaEvent::Gamma ) ) {
+      GammaHandler gamma;
+      restore( *h++, gamma );
+      meta.addGammaHandler( gamma );
+    }
+    if ( c.handlers & ( 1u << PackedMetaEvent::Mip ) ) {
+      MipHandler mip;
+      restore( *h++, mip );
+      meta.addMipHandler( mip );
+    }
+    if ( c.handlers & ( 1u << PackedMetaEvent::Hip ) ) {
+      HipHandler hip;
+      restore( *h++, hip );
+      meta.addHipHandler( hip );
+    }
+    if ( c.handlers & ( 1u << PackedMetaEvent::Dgn ) ) {
+      DgnHandler dgn;
+      restore( *h++, dgn );
+      meta.addDgnHandler( dgn );
+    }
+    if ( c.handlers & ( 1u << PackedMetaEvent::Passthru ) ) {
+      PassthruHandler pass;
+      restore( *h++, pass );
+      meta.addPassthruHandler( pass );
+    }
+    if ( c.handlers & ( 1u << PackedColdEvent::Lpa ) ) {
+      LpaHandler lpa;
+      restore( *h++, lpa );
+      meta.addLpaHandler( lpa );
+    }
+
+    meta.setMootKey( x.mootKey );
+    meta.setMootAlias( x.mootAlias.c_str() );
+    meta.setCompressionLevel( c.compressionLevel );
+    meta.setCompressedSize( c.compressedSize );
+  }
+
+}
@@ -0,0 +1,202 @@
+#include <ctime>
+#include <cstring>
+#include <iomanip>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "lsfData/LsfProfile.h"
+#include "lsfData/LsfAtomic.h"
+
+#if defined(_MSC_VER)
+#define LSFDATA_THREAD_LOCAL __declspec(thread)
+#else
+#define LSFDATA_THREAD_LOCAL __thread
+#endif
+
+namespace {
+
+  struct ThreadBlock {
+    unsigned long long calls[ lsfData::Profile::StageCnt ];
+    unsigned long long ticks[ lsfData::Profile::StageCnt ];
+    unsigned long long allocs[ lsfData::Profile::AllocCnt ];
+  };
+
+  // blocks are handed out once per thread and never freed, so a snapshot
+  // can always walk them; threads beyond MAX_THREADS share one more, and
+  // take turns with it
+  enum { MAX_THREADS = 256 };
+  ThreadBlock* volatile s_blocks[MAX_THREADS];
+  volatile unsigned int s_nblocks = 0;
+  ThreadBlock s_overflow;
+  volatile unsigned int s_overflowBusy = 0;
+
+  /// holds the overflow block for the life of the object, if it is block
+  class OverflowLock {
+  public:
+    OverflowLock( const ThreadBlock* block ) : m_locked( block == &s_overflow ) {
+      if ( m_locked ) while ( !lsfData::atomic::cas( s_overflowBusy, 0, 1 ) ) {}
+    }
+    ~OverflowLock() {
+      if ( m_locked ) lsfData::atomic::store( s_overflowBusy, 0 );
+    }
+  private:
+    bool m_locked;
+  };
+
+  LSFDATA_THREAD_LOCAL ThreadBlock* t_block = 0;
+
+  ThreadBlock* threadBlock()
+  {
+    if ( t_block ) return t_block;
+    const unsigned int idx = lsfData::atomic::add( s_nblocks, 1 ) - 1;
+    if ( idx < MAX_THREADS ) {
+      ThreadBlock* block = new ThreadBlock;
+      memset( block, 0, sizeof(ThreadBlock) );
+      lsfData::atomic::fence();
+      s_blocks[idx] = block;
+      t_block = block;
+    } else {
+      t_block = &s_overflow;
+    }
+    return t_block;
+  }
+
+  unsigned int nblocks()
+  {
+    const unsigned int n = lsfData::atomic::load( s_nblocks );
+    return ( n < MAX_THREADS ) ? n : static_cast< unsigned int >( MAX_THREADS );
+  }
+
+  double calibrate()
+  {
+    // count time-stamp ticks over ~20 ms of busy CPU time
+    const std::clock_t c0 = std::clock();
+    std::clock_t c1;
+    while ( ( c1 = std::clock() ) == c0 ) {}
+    const unsigned long long t1 = lsfData::Profile::ticks();
+    std::clock_t c2;
+    while ( ( c2 = std::clock() ) - c1 < CLOCKS_PER_SEC / 50 ) {}
+    const unsigned long long t2 = lsfData::Profile::ticks();
+    return double( t2 - t1 ) * CLOCKS_PER_SEC / double( c2 - c1 );
+  }
+
+  const char* s_stageNames[ lsfData::Profile::StageCnt ] = {
+    "Read", "BaseRead", "TransferCcsds", "TransferContext", "TransferTime",
+    "TransferHandlers", "CloneConfig", "CloneKeys"
+  };
+
+  const char* s_allocNames[ lsfData::Profile::AllocCnt ] = {
+    "ConfigAlloc", "KeysAlloc", "HandlerAlloc", "RsdAlloc"
+  };
+}
+
+namespace lsfData {
+
+  bool Profile::enabled()
+  {
+#ifdef LSFDATA_PROFILE
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  unsigned long long Profile::ticks()
+  {
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+    unsigned int lo, hi;
+    __asm__ __volatile__ ( "rdtsc" : "=a"(lo), "=d"(hi) );
+    return ( static_cast< unsigned long long >( hi ) << 32 ) | lo;
+#elif defined(_MSC_VER)
+    return __rdtsc();
+#else
+    return std::clock();
+#endif
+  }
+
+  void Profile::record( Stage stage, unsigned long long ticks )
+  {
+    ThreadBlock* block = threadBlock();
+    OverflowLock lock( block );
+    block->calls[stage]++;
+    block->ticks[stage] += ticks;
+  }
+
+  void Profile::count( Alloc alloc )
+  {
+    ThreadBlock* block = threadBlock();
+    OverflowLock lock( block );
+    block->allocs[alloc]++;
+  }
+
+  void Profile::snapshot( Snapshot& snap )
+  {
+    static const double tps = calibrate();
+
+    memset( &snap, 0, sizeof(Snapshot) );
+    snap.ticksPerSecond = tps;
+    const unsigned int n = nblocks();
+    for ( unsigned int i=0; i<n; i++ ) {
+      const ThreadBlock* block = s_blocks[i];
+      if ( !block ) continue;        // registered but not yet published
+      snap.threads++;
+      for ( int s=0; s<StageCnt; s++ ) {
+        snap.calls[s] += block->calls[s];
+        snap.ticks[s] += block->ticks[s];
+      }
+      for ( int a=0; a<AllocCnt; a++ ) {
+        snap.allocs[a] += block->allocs[a];
+      }
+    }
+    OverflowLock lock( &s_overflow );
+    for ( int s=0; s<StageCnt; s++ ) {
+      snap.calls[s] += s_overflow.calls[s];
+      snap.ticks[s] += s_overflow.ticks[s];
+    }
+    for ( int a=0; a<AllocCnt; a++ ) {
+      snap.allocs[a] += s_overflow.allocs[a];
+    }
+  }
+
+  void Profile::reset()
+  {
+    const unsigned int n = nblocks();
+    for ( unsigned int i=0; i<n; i++ ) {
+      if ( s_blocks[i] ) memset( s_blocks[i], 0, sizeof(ThreadBlock) );
+    }
+    OverflowLock lock( &s_overflow );
+    memset( &s_overflow, 0, sizeof(ThreadBlock) );
+  }
+
+  const char* Profile::stageName( Stage stage )
+  {
+    return ( stage >= 0 && stage < StageCnt ) ? s_stageNames[stage] : "Unknown";
+  }
+
+  const char* Profile::allocName( Alloc alloc )
+  {
+    return ( alloc >= 0 && alloc < AllocCnt ) ? s_allocNames[alloc] : "Unknown";
+  }
+
+  void Profile::print( const Snapshot& snap, std::ostream& s )
+  {
+    s << "lsfData profile (" << snap.threads << " threads, "
+      << std::fixed << std::setprecision(0) << snap.ticksPerSecond << " ticks/s)\n";
+    for ( int i=0; i<StageCnt; i++ ) {
+      const double secs = snap.ticksPerSecond > 0 ? snap.ticks[i] / snap.ticksPerSecond : 0.;
+      const double mean = snap.calls[i] ? double( snap.ticks[i] ) / snap.calls[i] : 0.;
+      s << "  " << std::left << std::setw(18) << s_stageNames[i] << std::right
+        << std::setw(12) << snap.calls[i] << " calls "
+        << std::setprecision(6) << std::setw(12) << secs << " s "
+        << std::setprecision(1) << std::setw(10) << mean << " ticks/call\n";
+    }
+    for ( int i=0; i<AllocCnt; i++ ) {
+      s << "  " << std::left << std::setw(18) << s_allocNames[i] << std::right
+        << std::setw(12) << snap.allocs[i] << " allocations\n";
+    }
+    s.unsetf( std::ios::floatfield );
+  }
+
+}
@@ -0,0 +1,88 @@
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#include "lsfData/LsfReadAhead.h"
+
+namespace lsfData {
+
+  ReadAhead::ReadAhead( const std::string& filename, size_t window, unsigned int depth,
+                        bool dropBehind )
+    : m_fd(-1), m_size(0), m_window( window ? window : static_cast< size_t >( DEFAULT_WINDOW ) ), m_depth( depth ? depth : 1 ),
+      m_dropBehind(dropBehind), m_ahead(0), m_requested(0), m_dropped(0), m_offset(0)
+  {
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    const std::string path = expand( filename );
+    m_fd = open( path.c_str(), O_RDONLY );
+    if ( m_fd < 0 ) return;
+    struct stat st;
+    if ( fstat( m_fd, &st ) == 0 ) m_size = st.st_size;
+    // the reads themselves are sequential
+    posix_fadvise( m_fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+    advance( 0 );
+#endif
+  }
+
+  ReadAhead::~ReadAhead()
+  {
+#ifndef _WIN32
+    if ( m_fd < 0 ) return;
+#if defined(POSIX_FADV_DONTNEED)
+    // the part of a window the reader had got into
+    if ( m_dropBehind && m_offset > m_dropped ) {
+      posix_fadvise( m_fd, m_dropped, m_offset - m_dropped, POSIX_FADV_DONTNEED );
+      m_dropped = m_offset;
+    }
+#endif
+    close( m_fd );
+#endif
+  }
+
+  void ReadAhead::advance( unsigned long long offset )
+  {
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    if ( m_fd < 0 ) return;
+    // only cross-window moves issue anything, so this is cheap per event
+    const unsigned long long want = offset + m_depth * static_cast< unsigned long long >( m_window );
+    while ( m_ahead < want && ( m_size == 0 || m_ahead < m_size ) ) {
+      posix_fadvise( m_fd, m_ahead, m_window, POSIX_FADV_WILLNEED );
+      m_ahead += m_window;
+      m_requested++;
+    }
+
+    if ( offset > m_offset ) m_offset = offset;
+    if ( m_dropBehind ) {
+      while ( m_dropped + m_window <= m_offset ) {
+        posix_fadvise( m_fd, m_dropped, m_window, POSIX_FADV_DONTNEED );
+        m_dropped += m_window;
+      }
+    }
+#else
+    (void)offset;
+#endif
+  }
+
+  std::string ReadAhead::expand( const std::string& filename )
+  {
+    std::string out;
+    std::string::size_type pos = 0;
+    while ( pos < filename.size() ) {
+      const std::string::size_type beg = filename.find( "$(", pos );
+      const std::string::size_type end = ( beg == std::string::npos ) ? beg : filename.find( ')', beg );
+      if ( end == std::string::npos ) {
+        out.append( filename, pos, std::string::npos );
+        break;
+      }
+      out.append( filename, pos, beg - pos );
+      const char* value = getenv( filename.substr( beg + 2, end - beg - 2 ).c_str() );
+      if ( value ) out += value;
+      pos = end + 1;
+    }
+    return out;
+  }
+
+}
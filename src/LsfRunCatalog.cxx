@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <pthread.h>
+#endif
+
+#include "lsfData/LsfRunCatalog.h"
+#include "lsfData/LsfEventSource.h"
+#include "lsfData/LsfReadAhead.h"
+#include "lsfData/LsfAtomic.h"
+
+namespace {
+
+  typedef lsfData::RunCatalog::Entry Entry;
+
+  const char         MAGIC[8]   = { 'L', 'S', 'F', 'C', 'A', 'T', '0', '2' };
+  const unsigned int ORDER_MARK = 0x01020304;
+
+  bool statFile( const std::string& filename, unsigned long long& size, long long& mtime )
+  {
+    struct stat st;
+    if ( stat( lsfData::ReadAhead::expand( filename ).c_str(), &st ) != 0 ) return false;
+    size = st.st_size;
+    mtime = st.st_mtime;
+    return true;
+  }
+
+  bool endsWith( const std::string& s, const std::string& suffix )
+  {
+    return s.size() >= suffix.size() && s.compare( s.size() - suffix.size(), suffix.size(), suffix ) == 0;
+  }
+
+  void listDirectory( const std::string& directory, const std::string& suffix,
+                      std::vector< std::string >& out )
+  {
+    const std::string dir = lsfData::ReadAhead::expand( directory );
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE h = FindFirstFileA( ( dir + "\\*" ).c_str(), &found );
+    if ( h == INVALID_HANDLE_VALUE ) return;
+    do {
+      const std::string name( found.cFileName );
+      if ( endsWith( name, suffix ) ) out.push_back( directory + "/" + name );
+    } while ( FindNextFileA( h, &found ) );
+    FindClose( h );
+#else
+    DIR* d = opendir( dir.c_str() );
+    if ( !d ) return;
+    while ( struct dirent* e = readdir( d ) ) {
+      const std::string name( e->d_name );
+      if ( name[0] != '.' && endsWith( name, suffix ) ) out.push_back( directory + "/" + name );
+    }
+    closedir( d );
+#endif
+    std::sort( out.begin(), out.end() );
+  }
+
+  /// mark where every stride-th event of the source starts, doubling the
+  /// stride whenever the marks are full; nothing if it cannot tell()
+  void mark( lsfData::EventSource& source, Entry& e )
+  {
+    const unsigned int marks = lsfData::RunCatalog::MARKS;
+    long long at = source.tell();
+    lsfData::EventRecord rec;
+    unsigned long long stride = 1;
+    for ( unsigned long long i=0; at >= 0 && source.readRecord( rec ); i++ ) {
+      if ( i % stride == 0 && e.marks == marks ) {
+        for ( unsigned int k=0; k<marks/2; k++ ) {
+          e.markAt[k] = e.markAt[2*k];
+          e.markSec[k] = e.markSec[2*k];
+        }
+        e.marks = marks/2;
+        stride *= 2;
+      }
+      if ( i % stride == 0 ) {
+        const double utc = rec.ctx.ccsds.utc;
+        e.markAt[ e.marks ] = at;
+        e.markSec[ e.marks ] = utc > 0. ? static_cast< unsigned int >( utc ) : 0;
+        e.marks++;
+      }
+      at = source.tell();
+    }
+  }
+
+  /// as above, keeping the header if the events cannot be read
+  void markFile( lsfData::EventSource& source, Entry& e )
+  {
+    try {
+      mark( source, e );
+    } catch ( ... ) {
+      e.marks = 0;
+    }
+  }
+
+  /// read one header, false if it cannot be read
+  bool scanFile( const lsfData::RunCatalog::Opener& opener, const std::string& filename, Entry& e )
+  {
+    memset( &e, 0, sizeof(e) );
+    if ( !statFile( filename, e.size, e.mtime ) ) return false;
+    lsfData::EventSource* source = 0;
+    try {
+      source = opener.open( filename );
+      if ( !source ) return false;
+      e.runid  = source->runid();
+      e.begSec = source->begSec();
+      e.endSec = source->endSec();
+      e.begGEM = source->begGEM();
+      e.endGEM = source->endGEM();
+      e.evtcnt = source->evtcnt();
+      markFile( *source, e );
+    } catch ( ... ) {
+      delete source;
+      return false;
+    }
+    delete source;
+    return true;
+  }
+
+  /// headers to read, shared by the scanning threads
+  struct ScanJob {
+    const lsfData::RunCatalog::Opener* opener;
+    const std::vector< std::string >*  files;
+    std::vector< Entry >*              entries;
+    std::vector< char >*               ok;
+    volatile unsigned int              next;
+  };
+
+  void scanFiles( ScanJob& job )
+  {
+    const unsigned int n = static_cast< unsigned int >( job.files->size() );
+    while ( true ) {
+      const unsigned int i = lsfData::atomic::add( job.next, 1 ) - 1;
+      if ( i >= n ) break;
+      // each thread writes only the slots it claimed
+      ( *job.ok )[i] = scanFile( *job.opener, ( *job.files )[i], ( *job.entries )[i] );
+    }
+  }
+
+#ifndef _WIN32
+  void* runScan( void* arg )
+  {
+    scanFiles( *static_cast< ScanJob* >( arg ) );
+    return 0;
+  }
+#endif
+
+  struct ByTime {
+    bool operator()( const Entry& a, const Entry& b ) const {
+      if ( a.begSec != b.begSec ) return a.begSec < b.begSec;
+      if ( a.endSec != b.endSec ) return a.endSec < b.endSec;
+      return a.file < b.file;
+    }
+  };
+
+  struct ByRun {
+    const std::vector< Entry >* entries;
+    bool operator()( unsigned int a, unsigned int b ) const {
+      const Entry& x = ( *entries )[a];
+      const Entry& y = ( *entries )[b];
+      return x.runid != y.runid ? x.runid < y.runid : a < b;
+    }
+  };
+
+  template < class T > bool put( FILE* f, const T& x ) { return fwrite( &x, sizeof(x), 1, f ) == 1; }
+  template < class T > bool get( FILE* f, T& x ) { return fread( &x, sizeof(x), 1, f ) == 1; }
+
+}
+
+namespace lsfData {
+
+  EventSource* RunCatalog::Opener::open( const std::string& filename ) const
+  {
+    return new FileEventSource( filename );
+  }
+
+  RunCatalog::RunCatalog( const Opener* opener )
+    : m_opener(opener), m_failed(0)
+  {
+  }
+
+  void RunCatalog::clear()
+  {
+    m_files.clear();
+    m_entries.clear();
+    m_maxEnd.clear();
+    m_byRun.clear();
+  }
+
+  void RunCatalog::table( Table& t ) const
+  {
+    for ( size_t i=0; i<m_entries.size(); i++ ) t[ file( m_entries[i] ) ] = m_entries[i];
+  }
+
+  unsigned int RunCatalog::refresh( const std::string& directory, unsigned int threads,
+                                    const std::string& suffix )
+  {
+    Table t;
+    table( t );
+
+    // drop what is gone, keep what has not changed
+    for ( Table::iterator it = t.begin(); it != t.end(); ) {
+      unsigned long long size;
+      long long mtime;
+      if ( statFile( it->first, size, mtime ) ) ++it;
+      else t.erase( it++ );
+    }
+    std::vector< std::string > listed, changed;
+    listDirectory( directory, suffix, listed );
+    for ( size_t i=0; i<listed.size(); i++ ) {
+      Table::const_iterator it = t.find( listed[i] );
+      unsigned long long size;
+      long long mtime;
+      if ( it == t.end() || !statFile( listed[i], size, mtime ) ||
+           size != it->second.size || mtime != it->second.mtime ) {
+        changed.push_back( listed[i] );
+      }
+    }
+
+    const unsigned int n = scan( changed, threads, t );
+    rebuild( t );
+    return n;
+  }
+
+  unsigned int RunCatalog::add( const std::vector< std::string >& filenames, unsigned int threads )
+  {
+    Table t;
+    table( t );
+    const unsigned int n = scan( filenames, threads, t );
+    rebuild( t );
+    return n;
+  }
+
+  bool RunCatalog::remove( const std::string& filename )
+  {
+    Table t;
+    table( t );
+    if ( t.erase( filename ) == 0 ) return false;
+    rebuild( t );
+    return true;
+  }
+
+  unsigned int RunCatalog::scan( const std::vector< std::string >& files, unsigned int threads, Table& t )
+  {
+    Opener fileOpener;
+    std::vector< Entry > entries( files.size() );
+    std::vector< char > ok( files.size(), 0 );
+    ScanJob job = { m_opener ? m_opener : &fileOpener, &files, &entries, &ok, 0 };
+
+#ifndef _WIN32
+    if ( threads > files.size() ) threads = static_cast< unsigned int >( files.size() );
+    std::vector< pthread_t > tids;
+    for ( unsigned int i=1; i<threads; i++ ) {
+      pthread_t tid;
+      if ( pthread_create( &tid, 0, runScan, &job ) == 0 ) tids.push_back( tid );
+    }
+    scanFiles( job );
+    for ( size_t i=0; i<tids.size(); i++ ) pthread_join( tids[i], 0 );
+#else
+    // no thread pool here, as in Decompressor: the headers are read in turn
+    (void)threads;
+    scanFiles( job );
+#endif
+
+    unsigned int n = 0;
+    m_failed = 0;
+    for ( size_t i=0; i<files.size(); i++ ) {
+      if ( ok[i] ) {
+        t[ files[i] ] = entries[i];
+        n++;
+      } else {
+        t.erase( files[i] );
+        m_failed++;
+      }
+    }
+    return n;
+  }
+
+  void RunCatalog::rebuild( const Table& t )
+  {
+    clear();
+    m_files.reserve( t.size() );
+    m_entries.reserve( t.size() );
+    for ( Table::const_iterator it = t.begin(); it != t.end(); ++it ) {
+      Entry e = it->second;
+      e.file = static_cast< unsigned int >( m_files.size() );
+      m_files.push_back( it->first );
+      m_entries.push_back( e );
+    }
+    std::sort( m_entries.begin(), m_entries.end(), ByTime() );
+
+    m_maxEnd.resize( m_entries.size() );
+    m_byRun.resize( m_entries.size() );
+    unsigned int maxEnd = 0;
+    for ( size_t i=0; i<m_entries.size(); i++ ) {
+      maxEnd = std::max( maxEnd, m_entries[i].endSec );
+      m_maxEnd[i] = maxEnd;
+      m_byRun[i] = static_cast< unsigned int >( i );
+    }
+    // stable within a run, so each run stays in begSec order
+    ByRun byRun = { &m_entries };
+    std::sort( m_byRun.begin(), m_byRun.end(), byRun );
+  }
+
+  void RunCatalog::covering( unsigned int t0, unsigned int t1, std::vector< const Entry* >& out ) const
+  {
+    out.clear();
+    // entries from lo on may end at or after t0, entries from hi on begin after t1
+    const size_t lo = std::lower_bound( m_maxEnd.begin(), m_maxEnd.end(), t0 ) - m_maxEnd.begin();
+    size_t hi = lo, top = m_entries.size();
+    while ( hi < top ) {
+      const size_t mid = hi + ( top - hi ) / 2;
+      if ( m_entries[mid].begSec <= t1 ) hi = mid + 1;
+      else top = mid;
+    }
+    for ( size_t i=lo; i<hi; i++ ) {
+      if ( m_entries[i].endSec >= t0 ) out.push_back( &m_entries[i] );
+    }
+  }
+
+  void RunCatalog::forRun( unsigned int runid, std::vector< const Entry* >& out ) const
+  {
+    out.clear();
+    size_t lo = 0, top = m_byRun.size();
+    while ( lo < top ) {
+      const size_t mid = lo + ( top - lo ) / 2;
+      if ( m_entries[ m_byRun[mid] ].runid < runid ) lo = mid + 1;
+      else top = mid;
+    }
+    for ( size_t i=lo; i<m_byRun.size() && m_entries[ m_byRun[i] ].runid == runid; i++ ) {
+      out.push_back( &m_entries[ m_byRun[i] ] );
+    }
+  }
+
+  bool RunCatalog::save( const std::string& filename ) const
+  {
+    // written beside the catalog and renamed over it, so a reader or a
+    // crash never sees half a catalog
+    const std::string path = ReadAhead::expand( filename );
+    const std::string temp = path + ".tmp";
+    FILE* f = fopen( temp.c_str(), "wb" );
+    if ( !f ) return false;
+    const unsigned int entrySize = sizeof(Entry);
+    const unsigned int nfiles = static_cast< unsigned int >( m_files.size() );
+    bool ok = fwrite( MAGIC, sizeof(MAGIC), 1, f ) == 1 &&
+      put( f, ORDER_MARK ) && put( f, entrySize ) && put( f, nfiles );
+    for ( unsigned int i=0; ok && i<nfiles; i++ ) {
+      const unsigned int length = static_cast< unsigned int >( m_files[i].size() );
+      ok = put( f, length ) && fwrite( m_files[i].data(), 1, length, f ) == length;
+    }
+    if ( ok && nfiles > 0 ) ok = fwrite( &m_entries[0], sizeof(Entry), nfiles, f ) == nfiles;
+    ok = fclose( f ) == 0 && ok;
+#ifdef _WIN32
+    // rename() does not replace an existing file here
+    ok = ok && MoveFileExA( temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+    ok = ok && rename( temp.c_str(), path.c_str() ) == 0;
+#endif
+    if ( !ok ) ::remove( temp.c_str() );
+    return ok;
+  }
+
+  bool RunCatalog::load( const std::string& filename )
+  {
+    clear();
+    FILE* f = fopen( ReadAhead::expand( filename ).c_str(), "rb" );
+    if ( !f ) return false;
+    char magic[ sizeof(MAGIC) ];
+    unsigned int order = 0, entrySize = 0, nfiles = 0;
+    bool ok = fread( magic, sizeof(magic), 1, f ) == 1 && memcmp( magic, MAGIC, sizeof(MAGIC) ) == 0 &&
+      get( f, order ) && order == ORDER_MARK &&
+      get( f, entrySize ) && entrySize == sizeof(Entry) && get( f, nfiles );
+    std::vector< std::string > files;
+    for ( unsigned int i=0; ok && i<nfiles; i++ ) {
+      unsigned int length = 0;
+      ok = get( f, length ) && length < ( 1u << 16 );
+      if ( ok ) {
+        std::vector< char > name( length + 1, 0 );
+        ok = fread( &name[0], 1, length, f ) == length;
+        files.push_back( std::string( &name[0], length ) );
+      }
+    }
+    std::vector< Entry > entries( ok ? nfiles : 0 );
+    if ( ok && nfiles > 0 ) ok = fread( &entries[0], sizeof(Entry), nfiles, f ) == nfiles;
+    fclose( f );
+
+    Table t;
+    for ( unsigned int i=0; ok && i<nfiles; i++ ) {
+      ok = entries[i].file < nfiles;
+      if ( ok ) t[ files[ entries[i].file ] ] = entries[i];
+    }
+    if ( !ok ) return false;
+    rebuild( t );
+    return true;
+  }
+
+}
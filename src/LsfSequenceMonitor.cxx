@@ -0,0 +1,126 @@
+#include <cstdio>
+#include <cstring>
+
+#include "lsfData/LsfSequenceMonitor.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+
+namespace lsfData {
+
+  SequenceMonitor::SequenceMonitor( Sequence sequence )
+    : m_sequence(sequence)
+  {
+    reset();
+  }
+
+  void SequenceMonitor::reset()
+  {
+    memset( m_state, 0, sizeof(m_state) );
+    memset( &m_merged, 0, sizeof(m_merged) );
+    for ( unsigned int i=0; i<MAX_APIDS; i++ ) {
+      atomic::store( m_events[i], 0 );
+      atomic::store( m_missing[i], 0 );
+      for ( unsigned int t=0; t<GapTypeCnt; t++ ) {
+        atomic::store( m_gaps[t][i], 0 );
+      }
+    }
+    atomic::store( m_totalEvents, 0 );
+    for ( unsigned int t=0; t<GapTypeCnt; t++ ) {
+      atomic::store( m_totalGaps[t], 0 );
+    }
+    for ( unsigned int i=0; i<MAX_GAPS; i++ ) {
+      atomic::store( m_ring[i].stamp, 0 );
+    }
+    atomic::store( m_gapCount, 0 );
+    m_ordinal = 0;
+  }
+
+  void SequenceMonitor::update( const LsfCcsds& ccsds, const MetaEvent& meta )
+  {
+    const unsigned int apid = ccsds.getApid() & (MAX_APIDS-1);
+    const unsigned long long seq = meta.scalers().sequence();
+    const unsigned int dgm = meta.datagram().datagrams();
+    const unsigned int run = meta.run().startTime();
+
+    ApidState& st = m_state[apid];
+    ApidState& sq = m_sequence == Merged ? m_merged : st;
+
+    // a new run restarts both counters, so there is nothing to compare to
+    if ( sq.seen && sq.run == run ) {
+      if ( seq > sq.sequence + 1 ) {
+        record( apid, SequenceGap, sq.sequence + 1, seq, dgm, ccsds.getUtc() );
+        atomic::bump( m_missing[apid], static_cast< unsigned int >( seq - sq.sequence - 1 ) );
+      } else if ( seq <= sq.sequence ) {
+        record( apid, SequenceBackward, sq.sequence + 1, seq, dgm, ccsds.getUtc() );
+      }
+    }
+    if ( st.seen && st.run == run && dgm > st.datagram + 1 ) {
+      record( apid, DatagramGap, st.datagram + 1, dgm, dgm, ccsds.getUtc() );
+    }
+
+    sq.sequence = seq;
+    sq.run      = run;
+    sq.seen     = true;
+    st.datagram = dgm;
+    st.run      = run;
+    st.seen     = true;
+
+    atomic::bump( m_events[apid] );
+    atomic::bump( m_totalEvents );
+    m_ordinal++;
+  }
+
+  void SequenceMonitor::record( unsigned int apid, GapType type,
+                                unsigned long long expected, unsigned long long found,
+                                unsigned int datagram, double utc )
+  {
+    atomic::bump( m_gaps[type][apid] );
+    atomic::bump( m_totalGaps[type] );
+
+    // seqlock-style publication: odd stamp while the slot is inconsistent
+    const unsigned int n = m_gapCount;
+    GapSlot& slot = m_ring[ n % MAX_GAPS ];
+    atomic::store( slot.stamp, 2*n + 1 );
+    atomic::fence();
+    slot.gap.apid     = apid;
+    slot.gap.type     = type;
+    slot.gap.expected = expected;
+    slot.gap.found    = found;
+    slot.gap.event    = m_ordinal;
+    slot.gap.datagram = datagram;
+    slot.gap.utc      = utc;
+    atomic::store( slot.stamp, 2*n + 2 );
+    atomic::store( m_gapCount, n + 1 );
+  }
+
+  unsigned int SequenceMonitor::recentGaps( Gap* out, unsigned int max ) const
+  {
+    const unsigned int n = atomic::load( m_gapCount );
+    unsigned int first = ( n > MAX_GAPS ) ? n - MAX_GAPS : 0;
+    if ( n - first > max ) first = n - max;
+
+    unsigned int copied = 0;
+    for ( unsigned int i=first; i<n; i++ ) {
+      const GapSlot& slot = m_ring[ i % MAX_GAPS ];
+      const unsigned int stamp = atomic::load( slot.stamp );
+      if ( stamp != 2*i + 2 ) continue;        // overwritten since we looked
+      Gap g;
+      memcpy( &g, &slot.gap, sizeof(Gap) );
+      atomic::fence();
+      if ( atomic::load( slot.stamp ) != stamp ) continue;
+      out[copied++] = g;
+    }
+    return copied;
+  }
+
+  void SequenceMonitor::print() const
+  {
+    for ( unsigned int i=0; i<MAX_APIDS; i++ ) {
+      if ( events(i) == 0 ) continue;
+      printf( "apid %04u: %10u events, %10u sequence gaps (%u missing), %10u backward, %10u datagram gaps\n",
+              i, events(i), gaps(i, SequenceGap), missing(i),
+              gaps(i, SequenceBackward), gaps(i, DatagramGap) );
+    }
+  }
+
+}
@@ -0,0 +1,101 @@
+#include <cstring>
+
+#include "lsfData/LsfTextBuffer.h"
+
+namespace {
+  const char s_lower[] = "0123456789abcdef";
+  const char s_upper[] = "0123456789ABCDEF";
+}
+
+namespace lsfData {
+
+  TextBuffer::TextBuffer( FILE* out, size_t capacity )
+    : m_out(out), m_buf( capacity ? capacity : 1 ), m_size(0)
+  {
+  }
+
+  TextBuffer::~TextBuffer()
+  {
+    flush();
+  }
+
+  void TextBuffer::reserve( size_t n )
+  {
+    if ( m_size + n <= m_buf.size() ) return;
+    flush();
+    if ( m_size + n > m_buf.size() ) {
+      // no output, or a single piece larger than the buffer
+      size_t cap = m_buf.size();
+      while ( cap < m_size + n ) cap *= 2;
+      m_buf.resize( cap );
+    }
+  }
+
+  void TextBuffer::flush()
+  {
+    if ( !m_out || m_size == 0 ) return;
+    fwrite( &m_buf[0], 1, m_size, m_out );
+    m_size = 0;
+  }
+
+  TextBuffer& TextBuffer::append( const char* s )
+  {
+    return append( s, strlen( s ) );
+  }
+
+  TextBuffer& TextBuffer::append( const char* s, size_t n )
+  {
+    if ( n == 0 ) return *this;
+    reserve( n );
+    memcpy( &m_buf[m_size], s, n );
+    m_size += n;
+    return *this;
+  }
+
+  TextBuffer& TextBuffer::dec( int v )
+  {
+    if ( v < 0 ) {
+      append( '-' );
+      // negate in unsigned arithmetic so INT_MIN is handled
+      return dec( 0ULL - static_cast< unsigned long long >( static_cast< long long >( v ) ) );
+    }
+    return dec( static_cast< unsigned long long >( v ) );
+  }
+
+  TextBuffer& TextBuffer::dec( unsigned long long v )
+  {
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    do {
+      *--p = static_cast< char >( '0' + v % 10 );
+      v /= 10;
+    } while ( v );
+    return append( p, tmp + sizeof(tmp) - p );
+  }
+
+  TextBuffer& TextBuffer::hex( unsigned long long v, unsigned int width, bool upper )
+  {
+    const char* digits = upper ? s_upper : s_lower;
+    char tmp[16];
+    char* p = tmp + sizeof(tmp);
+    do {
+      *--p = digits[v & 0xF];
+      v >>= 4;
+    } while ( v );
+    const size_t n = tmp + sizeof(tmp) - p;
+    for ( size_t i=n; i<width; i++ ) append( '0' );
+    return append( p, n );
+  }
+
+  TextBuffer& TextBuffer::fixed( double v, int width, int precision )
+  {
+    // rare and rounding-sensitive, so left to the C library; the largest
+    // double has 309 integer digits
+    if ( width > 64 ) width = 64;
+    if ( precision > 64 ) precision = 64;
+    char tmp[512];
+    const int n = sprintf( tmp, "%*.*f", width, precision, v );
+    return n > 0 ? append( tmp, n ) : *this;
+  }
+
+}
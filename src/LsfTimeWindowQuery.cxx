@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+
+#include "lsfData/LsfTimeWindowQuery.h"
+#include "lsfData/LSFReader.h"
+#include "lsfData/LsfTime.h"
+
+namespace {
+
+  const eventFile::LSE_Info* infoOf( const lsfData::EventRecord& rec )
+  {
+    switch ( rec.infotype ) {
+    case eventFile::LSE_Info::LPA:     return &rec.pinfo;
+    case eventFile::LSE_Info::LCI_ACD: return &rec.ainfo;
+    case eventFile::LSE_Info::LCI_CAL: return &rec.cinfo;
+    case eventFile::LSE_Info::LCI_TKR: return &rec.tinfo;
+    default:                           return 0;
+    }
+  }
+
+  /// events of a file before start, by its header, assuming a steady
+  /// event rate and starting a little early
+  unsigned long long before( const lsfData::RunCatalog::Entry& e, double start )
+  {
+    if ( start <= e.begSec || e.endSec <= e.begSec || e.evtcnt == 0 ) return 0;
+    const double fraction = ( start - e.begSec ) / ( e.endSec - e.begSec );
+    const double slack = e.evtcnt / 64.;
+    const double estimate = fraction * e.evtcnt - slack;
+    if ( estimate <= 0. ) return 0;
+    return static_cast< unsigned long long >( std::min( estimate, double( e.evtcnt ) ) );
+  }
+
+  /// the last mark of a file whose event came before start, -1 if none
+  int lastMark( const lsfData::RunCatalog::Entry& e, double start )
+  {
+    int k = -1;
+    for ( unsigned int i=0; i<e.marks && e.markSec[i] + 1. <= start; i++ ) k = static_cast< int >( i );
+    return k;
+  }
+
+  /// clamp a time in seconds to the range of header seconds
+  unsigned int seconds( double t )
+  {
+    if ( t <= 0. ) return 0;
+    if ( t >= 4294967295. ) return 4294967295u;
+    return static_cast< unsigned int >( t );
+  }
+
+}
+
+namespace lsfData {
+
+  TimeWindowQuery::TimeWindowQuery( const RunCatalog& catalog, double begin, double end, Clock clock,
+                                    double margin, const RunCatalog::Opener* opener )
+    : m_opener( opener ? opener : &m_fileOpener ), m_next(0), m_catalog(&catalog),
+      m_begin(begin), m_end(end), m_clock(clock), m_margin( margin > 0. ? margin : 0. ),
+      m_source(0), m_reader(0), m_pending(false),
+      m_opened(0), m_skipped(0), m_examined(0), m_matched(0)
+  {
+    if ( m_begin <= m_end ) {
+      catalog.covering( seconds( m_begin - m_margin ), seconds( std::ceil( m_end + m_margin ) ), m_entries );
+    }
+  }
+
+  TimeWindowQuery::~TimeWindowQuery()
+  {
+    close();
+  }
+
+  double TimeWindowQuery::time( const EventRecord& rec ) const
+  {
+    if ( m_clock == Utc ) return rec.ctx.ccsds.utc;
+    const eventFile::LSE_Info* info = infoOf( rec );
+    const unsigned int ticks = info ? info->timeTics : rec.ctx.current.timeHack.tics;
+    return Time::met( rec.ctx.current.timeSecs, rec.ctx.current.timeHack.tics,
+                      rec.ctx.previous.timeSecs, rec.ctx.previous.timeHack.tics, ticks );
+  }
+
+  void TimeWindowQuery::close()
+  {
+    delete m_reader;
+    delete m_source;
+    m_reader = 0;
+    m_source = 0;
+    m_pending = false;
+  }
+
+  bool TimeWindowQuery::openNext( EventRecord& rec )
+  {
+    while ( m_next < m_entries.size() ) {
+      const RunCatalog::Entry& e = *m_entries[ m_next++ ];
+      const std::string& filename = m_catalog->file( e );
+
+      unsigned long long n = 0;
+      int mark = -1;
+      bool first = true;
+      while ( true ) {
+        try {
+          m_source = m_opener->open( filename );
+        } catch ( ... ) {
+          m_source = 0;
+        }
+        if ( !m_source ) break;
+        m_opened++;
+        m_reader = new LSFReader( m_source );
+        if ( first ) {
+          // without seeking a skip costs as much as reading, so read once
+          first = false;
+          if ( m_source->canSeek() ) n = before( e, m_begin - m_margin );
+          else if ( m_source->tell() >= 0 ) mark = lastMark( e, m_begin - m_margin );
+        }
+
+        if ( mark >= 0 && !m_source->seek( e.markAt[ mark ] ) ) {
+          // start over without seeking
+          close();
+          mark = -1;
+          continue;
+        }
+        const unsigned long long skipped = m_source->skip( n );
+        m_skipped += skipped;
+        const bool more = m_reader->readRecord( rec );
+        if ( ( n == 0 && mark < 0 ) || ( more && time( rec ) < m_begin ) ) {
+          if ( !more ) break;
+          m_pending = true;
+          return true;
+        }
+        // landed inside the window or past the end of the file: events
+        // before the landing point may be wanted, try again from earlier
+        close();
+        if ( mark >= 0 ) mark--;
+        else n /= 2;
+      }
+      close();
+    }
+    return false;
+  }
+
+  bool TimeWindowQuery::readRecord( EventRecord& rec )
+  {
+    while ( true ) {
+      if ( !m_source ) {
+        if ( !openNext( rec ) ) return false;
+      }
+      if ( m_pending ) {
+        m_pending = false;
+      } else if ( !m_reader->readRecord( rec ) ) {
+        close();
+        continue;
+      }
+      m_examined++;
+      const double t = time( rec );
+      if ( t < m_begin ) continue;
+      if ( t > m_end + m_margin ) {
+        // the rest of the file is later still, but for events out of
+        // order by less than the margin, which were read up to here
+        close();
+        continue;
+      }
+      if ( t > m_end ) continue;
+      m_matched++;
+      return true;
+    }
+  }
+
+  bool TimeWindowQuery::read( LsfCcsds& ccsds, MetaEvent& meta, eventFile::EBF_Data& ebf )
+  {
+    if ( !readRecord( m_record ) ) return false;
+    m_reader->decode( m_record, ccsds, meta );
+    ebf = m_record.ebf;
+    return true;
+  }
+
+}
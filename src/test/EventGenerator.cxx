@@ -0,0 +1,320 @@
+#include <string.h>
+
+#include "EventGenerator.h"
+
+#include "enums/Lsf.h"
+#include "eventFile/LSEWriter.h"
+
+namespace {
+  // GEM time ticks are a 25 bit counter of the nominally 20 MHz LAT clock
+  const unsigned int TICKS_MASK       = 0x1FFFFFF;
+  const unsigned int TICKS_PER_SECOND = 20000000;
+
+  const char* s_mixNames[ lsfData::EventGenerator::MixCnt ] = {
+    "LpaHeavy", "LciMix", "Mixed"
+  };
+
+  /// give a handler rsd as its result summary data
+  template< class Rsd > void setRsd( eventFile::LPA_Handler& h, const Rsd& rsd )
+  {
+    memcpy( h.rsd, &rsd, sizeof(Rsd) );
+    h.rsdLen = sizeof(Rsd);
+    h.has    = true;
+  }
+
+  template< class Rsd > void setGammaRsd( eventFile::LPA_Handler& h, unsigned int status,
+                                          unsigned int energyValid, int energyInLeus )
+  {
+    Rsd rsd;
+    memset( &rsd, 0, sizeof(Rsd) );
+    rsd.status       = status;
+    rsd.energyValid  = energyValid;
+    rsd.energyInLeus = energyInLeus;
+    setRsd( h, rsd );
+  }
+
+  template< class Rsd > void setStatusRsd( eventFile::LPA_Handler& h, unsigned int status )
+  {
+    Rsd rsd;
+    memset( &rsd, 0, sizeof(Rsd) );
+    rsd.status = status;
+    setRsd( h, rsd );
+  }
+}
+
+namespace lsfData {
+
+  EventGenerator::EventGenerator( Mix mix, unsigned int seed )
+    : m_mix(mix), m_state(seed ? seed : 1), m_runid(239557417),
+      m_sequence(0), m_elapsed(0), m_livetime(0),
+      m_datagram(0), m_inDatagram(0),
+      m_seconds(239557417), m_hacks(0), m_ticks(0)
+  {
+  }
+
+  const char* EventGenerator::mixName( Mix mix )
+  {
+    return ( mix >= 0 && mix < MixCnt ) ? s_mixNames[mix] : "Unknown";
+  }
+
+  unsigned int EventGenerator::random()
+  {
+    // xorshift32, so the stream does not depend on the C library's rand()
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+  }
+
+  void EventGenerator::next( Record& rec )
+  {
+    // advance the GEM by ~0.5 ms of which ~92% is live
+    const unsigned int dt = 5000 + random() % 10000;
+    m_elapsed  += dt;
+    m_livetime += dt - dt / 12;
+    m_sequence += 1 + ( ( random() & 0xFF ) == 0 );   // rare prescaled gaps
+    m_ticks = ( m_ticks + dt ) & TICKS_MASK;
+    if ( ( m_elapsed / TICKS_PER_SECOND ) != ( ( m_elapsed - dt ) / TICKS_PER_SECOND ) ) {
+      m_seconds++;
+      m_hacks++;
+    }
+
+    // roughly 200 events per datagram
+    if ( ++m_inDatagram > 150 + random() % 100 ) {
+      m_datagram++;
+      m_inDatagram = 0;
+    }
+
+    fillContext( rec );
+
+    unsigned int pick = static_cast< unsigned int >( m_sequence % 8 );
+    if ( m_mix == LpaHeavy || ( m_mix == Mixed && pick != 7 ) ) {
+      rec.infotype = eventFile::LSE_Info::LPA;
+      rec.ktype    = eventFile::LSE_Keys::LPA;
+      fillLpa( rec );
+      fillPayload( rec, 100, 1000 );
+    } else {
+      rec.ktype = eventFile::LSE_Keys::LCI;
+      rec.cikeys.LATC_master = 0x2000 + m_runid % 97;
+      rec.cikeys.LATC_ignore = 0x2100;
+      rec.cikeys.LCI_script  = 0x2200;
+      switch ( m_sequence % 3 ) {
+      case 0:
+        rec.infotype = eventFile::LSE_Info::LCI_ACD;
+        fillLci( rec.ainfo );
+        rec.ainfo.injected    = random() & 0xFFF;
+        rec.ainfo.threshold   = random() & 0x3F;
+        rec.ainfo.biasDac     = random() & 0x7;
+        rec.ainfo.holdDelay   = random() & 0x3F;
+        rec.ainfo.hitmapDelay = random() & 0x1F;
+        rec.ainfo.range       = random() & 0x1;
+        rec.ainfo.trigger.veto        = random() & 0x3F;
+        rec.ainfo.trigger.vetoVernier = random() & 0x3F;
+        rec.ainfo.trigger.hld         = random() & 0x3F;
+        fillPayload( rec, 200, 600 );
+        break;
+      case 1:
+        rec.infotype = eventFile::LSE_Info::LCI_CAL;
+        fillLci( rec.cinfo );
+        rec.cinfo.uld        = random() & 0x7F;
+        rec.cinfo.injected   = random() & 0xFFF;
+        rec.cinfo.delay      = random() & 0xFF;
+        rec.cinfo.firstRange = random() & 0x3;
+        rec.cinfo.threshold  = random() & 0x7F;
+        rec.cinfo.calibGain  = random() & 0x1;
+        rec.cinfo.highCalEna = random() & 0x1;
+        rec.cinfo.highRngEna = random() & 0x1;
+        rec.cinfo.highGain   = random() & 0xF;
+        rec.cinfo.lowCalEna  = random() & 0x1;
+        rec.cinfo.lowRngEna  = random() & 0x1;
+        rec.cinfo.lowGain    = random() & 0x7;
+        rec.cinfo.trigger.le         = random() & 0x7F;
+        rec.cinfo.trigger.lowTrgEna  = random() & 0x1;
+        rec.cinfo.trigger.he         = random() & 0x7F;
+        rec.cinfo.trigger.highTrgEna = random() & 0x1;
+        fillPayload( rec, 1000, 4000 );
+        break;
+      default:
+        rec.infotype = eventFile::LSE_Info::LCI_TKR;
+        fillLci( rec.tinfo );
+        rec.tinfo.injected  = random() & 0x3F;
+        rec.tinfo.delay     = random() & 0xFF;
+        rec.tinfo.threshold = random() & 0x3F;
+        rec.tinfo.splitLow  = random() % 24;
+        rec.tinfo.splitHigh = random() % 24;
+        fillPayload( rec, 500, 3000 );
+        break;
+      }
+    }
+  }
+
+  void EventGenerator::fillContext( Record& rec )
+  {
+    eventFile::LSE_Context& ctx = rec.ctx;
+    ctx.ccsds.scid = 77;
+    ctx.ccsds.apid = 956 + static_cast< int >( m_datagram % 2 );
+    ctx.ccsds.utc  = 2.0e8 + m_elapsed / double( TICKS_PER_SECOND );
+
+    ctx.open.action      = 1;
+    ctx.open.reason      = 1;
+    ctx.open.crate       = 1 + static_cast< int >( m_datagram % 2 );
+    ctx.open.mode        = 1;
+    ctx.open.datagrams   = m_datagram;
+    ctx.open.modeChanges = 0;
+    ctx.close.action     = 1;
+    ctx.close.reason     = 1;
+
+    ctx.run.platform  = 1;
+    ctx.run.origin    = 1;
+    ctx.run.groundId  = 77004200;
+    ctx.run.startedAt = m_runid;
+
+    ctx.scalers.elapsed   = m_elapsed;
+    ctx.scalers.livetime  = m_livetime;
+    ctx.scalers.prescaled = m_sequence / 256;
+    ctx.scalers.discarded = m_sequence / 40;
+    ctx.scalers.sequence  = m_sequence;
+    ctx.scalers.deadzone  = m_sequence / 5000;
+
+    ctx.current.incomplete      = 0;
+    ctx.current.timeSecs        = m_seconds;
+    ctx.current.flywheeling     = 0;
+    ctx.current.missingCpuPps   = false;
+    ctx.current.missingLatPps   = false;
+    ctx.current.missingTimeTone = false;
+    ctx.current.earlyEvent      = false;
+    ctx.current.sourceGps       = true;
+    ctx.current.timeHack.hacks  = m_hacks;
+    ctx.current.timeHack.tics   = static_cast< unsigned int >( ( m_elapsed / TICKS_PER_SECOND ) * TICKS_PER_SECOND ) & TICKS_MASK;
+
+    ctx.previous = ctx.current;
+    ctx.previous.timeSecs       = m_seconds - 1;
+    ctx.previous.timeHack.hacks = m_hacks - 1;
+    ctx.previous.timeHack.tics  = ( ctx.current.timeHack.tics - TICKS_PER_SECOND ) & TICKS_MASK;
+  }
+
+  void EventGenerator::fillTime( eventFile::LSE_Info& info )
+  {
+    info.timeHack.hacks    = m_hacks;
+    info.timeHack.tics     = m_ticks;
+    info.timeTics          = m_ticks;
+    info.compressionLevel  = 0;
+    info.compressedSize    = 0;
+  }
+
+  void EventGenerator::fillLpa( Record& rec )
+  {
+    eventFile::LPA_Info& info = rec.pinfo;
+    fillTime( info );
+    info.hardwareKey = 0x1000 + m_runid % 89;
+    info.softwareKey = 0x1100 + m_runid % 83;
+
+    static const unsigned int ids[] = { enums::Lsf::PASS_THRU, enums::Lsf::GAMMA,
+                                        enums::Lsf::MIP, enums::Lsf::HIP, enums::Lsf::DGN };
+    info.handlers.resize( 5 );
+    for ( unsigned int i=0; i<5; i++ ) {
+      eventFile::LPA_Handler& h = info.handlers[i];
+      h.id        = ids[i];
+      h.masterKey = 0x3000 + i;
+      h.cfgKey    = 0x3100 + i;
+      h.cfgId     = i;
+      h.state     = random() % 6;
+      h.prescaler = random() % 32;
+      h.version   = 0;
+      const unsigned int status = random();
+      switch ( ids[i] ) {
+      case enums::Lsf::GAMMA:
+        // every RSD version the reader knows, mostly the current one
+        h.version = ( random() & 3 ) ? 3 : random() % 3;
+        {
+          const unsigned int valid = random() & 1;
+          const int energy = static_cast< int >( random() % 200000 ) - 1000;
+          switch ( h.version ) {
+          case 0:  setGammaRsd< eventFile::GammaHandlerRsdV0 >( h, status, valid, energy ); break;
+          case 1:  setGammaRsd< eventFile::GammaHandlerRsdV1 >( h, status, valid, energy ); break;
+          case 2:  setGammaRsd< eventFile::GammaHandlerRsdV2 >( h, status, valid, energy ); break;
+          default: setGammaRsd< eventFile::GammaHandlerRsdV3 >( h, status, valid, energy ); break;
+          }
+        }
+        break;
+      case enums::Lsf::MIP: setStatusRsd< eventFile::MipHandlerRsdV0 >( h, status ); break;
+      case enums::Lsf::HIP: setStatusRsd< eventFile::HipHandlerRsdV0 >( h, status ); break;
+      case enums::Lsf::DGN: setStatusRsd< eventFile::DgnHandlerRsdV0 >( h, status ); break;
+      default:              setStatusRsd< eventFile::PassthruHandlerRsdV0 >( h, status ); break;
+      }
+    }
+
+    rec.pakeys.LATC_master = info.hardwareKey;
+    rec.pakeys.LATC_ignore = 0x1200;
+    rec.pakeys.SBS         = 0x1300;
+    rec.pakeys.LPA_db      = 0x1400;
+  }
+
+  void EventGenerator::fillLci( eventFile::LCI_Info& info )
+  {
+    fillTime( info );
+    info.softwareKey      = 0x4000 + m_runid % 79;
+    info.writeCfg         = 0x4100;
+    info.readCfg          = 0x4200;
+    info.periodicPrescale = 10000;
+    info.autoRange        = ( random() & 1 ) != 0;
+    info.zeroSupression   = ( random() & 1 ) != 0;
+    info.strobe           = ( random() & 1 ) != 0;
+    info.channel.single   = random() % 12;
+    info.channel.all      = false;
+    info.channel.latc     = false;
+  }
+
+  void EventGenerator::fillPayload( Record& rec, unsigned int minWords, unsigned int maxWords )
+  {
+    const unsigned int words = minWords + random() % ( maxWords - minWords + 1 );
+    m_payload.resize( 4 * words );
+    for ( unsigned int i=0; i<words; i++ ) {
+      const unsigned int w = random();
+      m_payload[4*i]   = static_cast< unsigned char >( w );
+      m_payload[4*i+1] = static_cast< unsigned char >( w >> 8 );
+      m_payload[4*i+2] = static_cast< unsigned char >( w >> 16 );
+      m_payload[4*i+3] = static_cast< unsigned char >( w >> 24 );
+    }
+    rec.ebf = eventFile::EBF_Data( &m_payload[0], m_payload.size() );
+  }
+
+  void EventGenerator::fill( MemoryEventSource& source, unsigned long long nevents )
+  {
+    Record rec;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      next( rec );
+      source.add( rec );
+    }
+  }
+
+  unsigned long long EventGenerator::writeFile( const std::string& filename, unsigned long long nevents )
+  {
+    eventFile::LSEWriter writer( filename, m_runid );
+    Record rec;
+    unsigned long long bytes = 0;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      next( rec );
+      const eventFile::EBF_Data& ebf = rec.ebf;
+      bytes += ebf.size();
+      switch ( rec.infotype ) {
+      case eventFile::LSE_Info::LPA:
+        writer.write( rec.ctx, ebf, &rec.pinfo, &rec.pakeys );
+        break;
+      case eventFile::LSE_Info::LCI_ACD:
+        writer.write( rec.ctx, ebf, &rec.ainfo, &rec.cikeys );
+        break;
+      case eventFile::LSE_Info::LCI_CAL:
+        writer.write( rec.ctx, ebf, &rec.cinfo, &rec.cikeys );
+        break;
+      case eventFile::LSE_Info::LCI_TKR:
+        writer.write( rec.ctx, ebf, &rec.tinfo, &rec.cikeys );
+        break;
+      default:
+        break;
+      }
+    }
+    return bytes;
+  }
+
+}
@@ -0,0 +1,82 @@
+#ifndef LSFDATA_EVENTGENERATOR_H
+#define LSFDATA_EVENTGENERATOR_H 1
+
+#include <string>
+#include <vector>
+
+#include "eventFile/LPA_Handler.h"
+
+#include "lsfData/LsfMemoryEventSource.h"
+
+/** @class EventGenerator
+* @brief Deterministic synthetic LSF event source for tests and benchmarks
+*
+* Produces the native eventFile records (context, info, keys and an EBF
+* payload) for a reproducible stream of events, using its own random
+* number generator so the output only depends on the seed.  The event
+* mix selects which info types are generated:
+*  - LpaHeavy: LPA events carrying all five filter handlers, each with
+*              the result summary data (RSD) of its type; gamma RSDs
+*              come in all four versions, mostly the latest
+*  - LciMix:   LCI_ACD, LCI_CAL and LCI_TKR events in rotation
+*  - Mixed:    mostly LPA with an LCI event every eighth
+*
+* The EBF payload is filler of a realistic size distribution; it is not a
+* decodable LDF event.
+*
+* $Header$
+*/
+
+namespace lsfData {
+
+  class EventGenerator {
+
+  public:
+
+    enum Mix { LpaHeavy = 0, LciMix, Mixed, MixCnt };
+
+    typedef MemoryEventSource::Record Record;
+
+    EventGenerator( Mix mix, unsigned int seed = 20080611 );
+
+    /// fill the records for the next event of the stream
+    void next( Record& rec );
+
+    /// write nevents to an LSF file, returns the number of payload bytes
+    unsigned long long writeFile( const std::string& filename, unsigned long long nevents );
+
+    /// append nevents to an in-memory source
+    void fill( MemoryEventSource& source, unsigned long long nevents );
+
+    /// run id used in the generated contexts and file headers
+    unsigned int runid() const { return m_runid; }
+
+    static const char* mixName( Mix mix );
+
+  private:
+
+    unsigned int random();
+    void fillContext( Record& rec );
+    void fillTime( eventFile::LSE_Info& info );
+    void fillLpa( Record& rec );
+    void fillLci( eventFile::LCI_Info& info );
+    void fillPayload( Record& rec, unsigned int minWords, unsigned int maxWords );
+
+    Mix                m_mix;
+    unsigned int       m_state;
+    unsigned int       m_runid;
+    unsigned long long m_sequence;
+    unsigned long long m_elapsed;
+    unsigned long long m_livetime;
+    unsigned int       m_datagram;
+    unsigned int       m_inDatagram;
+    unsigned int       m_seconds;
+    unsigned int       m_hacks;
+    unsigned int       m_ticks;
+
+    std::vector<unsigned char> m_payload;   // scratch for fillPayload
+  };
+
+}
+
+#endif    // LSFDATA_EVENTGENERATOR_H
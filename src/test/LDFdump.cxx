@@ -68,6 +68,64 @@ extern "C" {
 #include "ASCtileContributionIterator.h"
 #include "ASCcontributionIterator.h"
 
+#include "lsfData/LsfTextBuffer.h"
+
+extern "C" {
+#include <stdarg.h>
+}
+
+#if defined(_MSC_VER)
+#define LSFDATA_THREAD_LOCAL __declspec(thread)
+#else
+#define LSFDATA_THREAD_LOCAL __thread
+#endif
+
+/*
+** The dump classes below print with printf.  dumpEvent renders events on
+** several threads, so each thread can install a TextBuffer that receives
+** its printf output in place of stdout (see LDFdumpTo).  Error reports
+** still go straight to stderr.
+*/
+
+static LSFDATA_THREAD_LOCAL lsfData::TextBuffer* s_sink = 0;
+
+void LDFdumpTo(lsfData::TextBuffer* sink)
+{
+  s_sink = sink;
+}
+
+static int LDFprintf(const char* fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  if (!s_sink)
+  {
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+  }
+
+  char line[512];
+  int  n = vsnprintf(line, sizeof(line), fmt, ap);
+  va_end(ap);
+  if (n < (int)sizeof(line))
+  {
+    if (n > 0)  s_sink->append(line, n);
+    return n;
+  }
+
+  // longer than any line the dumps print, but be safe
+  char* big = new char[n + 1];
+  va_start(ap, fmt);
+  vsnprintf(big, n + 1, fmt, ap);
+  va_end(ap);
+  s_sink->append(big, n);
+  delete [] big;
+  return n;
+}
+
+#define printf LDFprintf
+
 class MyLATPcellHeader : public LATPcellHeader
 {
 public:
@@ -1404,7 +1462,7 @@ int MyLATdatagramIterator::process(LATdatagram* datagram)
   printf("\n<Return> for next event, 'q' to quit: ");
   response=getchar();
   printf("\n");
-  if (response=='' || response=='q' || response=='Q')  return 1;
+  if (response=='\003' || response=='q' || response=='Q')  return 1;
 
   return _lci.status();
 }
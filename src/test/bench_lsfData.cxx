@@ -0,0 +1,646 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <cmath>
+#include <new>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "eventFile/EBF_Data.h"
+
+#include "lsfData/LSFReader.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfMemoryEventSource.h"
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfProfile.h"
+#include "lsfData/LsfTextBuffer.h"
+#include "lsfData/LsfEventExporter.h"
+#include "lsfData/Ebf.h"
+#include "lsfData/LsfPackedMetaEvent.h"
+#include "lsfData/LsfDecompressor.h"
+#include "lsfData/LsfBufferArena.h"
+#include "lsfData/LsfEventPool.h"
+#include "lsfData/LsfExposureBinner.h"
+#include "lsfData/LsfSequenceMonitor.h"
+
+#include "EventGenerator.h"
+
+// count every heap allocation made by the program, so each benchmark can
+// report allocations per operation; the count is only exact for the single
+// threaded benchmarks
+static unsigned long long s_allocs = 0;
+
+#if __cplusplus >= 201103L
+#define BENCH_THROWS_BAD_ALLOC
+#define BENCH_NOTHROW noexcept
+#else
+#define BENCH_THROWS_BAD_ALLOC throw( std::bad_alloc )
+#define BENCH_NOTHROW throw()
+#endif
+
+// kept out of line, or gcc pairs the inlined free() with the operator new
+// at the call site and warns of a mismatch
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static void* counted( size_t size )
+{
+  s_allocs++;
+  void* p = malloc( size ? size : 1 );
+  if ( !p ) throw std::bad_alloc();
+  return p;
+}
+
+BENCH_NOINLINE void* operator new( size_t size ) BENCH_THROWS_BAD_ALLOC { return counted( size ); }
+BENCH_NOINLINE void* operator new[]( size_t size ) BENCH_THROWS_BAD_ALLOC { return counted( size ); }
+BENCH_NOINLINE void operator delete( void* p ) BENCH_NOTHROW { free( p ); }
+BENCH_NOINLINE void operator delete[]( void* p ) BENCH_NOTHROW { free( p ); }
+#if __cplusplus >= 201402L
+BENCH_NOINLINE void operator delete( void* p, size_t ) BENCH_NOTHROW { free( p ); }
+BENCH_NOINLINE void operator delete[]( void* p, size_t ) BENCH_NOTHROW { free( p ); }
+#endif
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + 1.e-6 * tv.tv_usec;
+}
+
+/// timing and allocation count of one benchmark
+class Measure {
+public:
+  Measure() : m_start(now()), m_allocs(s_allocs) {}
+  void report( const char* mix, const char* what, unsigned long long ops,
+               unsigned long long bytes = 0 ) const
+  {
+    const double secs = now() - m_start;
+    const unsigned long long allocs = s_allocs - m_allocs;
+    printf( "%-9s %-22s %10llu ops %9.3f s %12.0f ops/s",
+            mix, what, ops, secs, secs > 0 ? ops / secs : 0. );
+    if ( bytes > 0 ) {
+      printf( " %9.1f MB/s", secs > 0 ? bytes / secs / 1.e6 : 0. );
+    } else {
+      printf( " %12s", "" );
+    }
+    printf( " %7.2f allocs/op\n", ops ? double( allocs ) / ops : 0. );
+  }
+private:
+  double             m_start;
+  unsigned long long m_allocs;
+};
+
+static void transfer( lsfData::LSFReader& reader, const lsfData::MemoryEventSource::Record& rec,
+                      lsfData::LsfCcsds& ccsds, lsfData::MetaEvent& meta )
+{
+  reader.transferCcsds( rec.ctx, ccsds );
+  reader.transferContext( rec.ctx, meta );
+  switch ( rec.infotype ) {
+  case eventFile::LSE_Info::LPA:
+    reader.transferInfo( rec.ctx, rec.pinfo, meta );
+    reader.transferKeys( rec.pakeys, meta );
+    break;
+  case eventFile::LSE_Info::LCI_ACD:
+    reader.transferInfo( rec.ctx, rec.ainfo, meta );
+    reader.transferKeys( rec.cikeys, meta );
+    break;
+  case eventFile::LSE_Info::LCI_CAL:
+    reader.transferInfo( rec.ctx, rec.cinfo, meta );
+    reader.transferKeys( rec.cikeys, meta );
+    break;
+  case eventFile::LSE_Info::LCI_TKR:
+    reader.transferInfo( rec.ctx, rec.tinfo, meta );
+    reader.transferKeys( rec.cikeys, meta );
+    break;
+  default:
+    break;
+  }
+}
+
+/// drop a file from the page cache, so that the next read of it comes from
+/// the device; false where that cannot be done
+static bool evict( const std::string& filename )
+{
+#if defined(__linux__) && defined(POSIX_FADV_DONTNEED)
+  const int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 ) return false;
+  fdatasync( fd );   // dirty pages are not dropped
+  const bool ok = posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED ) == 0;
+  close( fd );
+  return ok;
+#else
+  (void)filename;
+  return false;
+#endif
+}
+
+/// seconds to read every event of source through reader, passes times
+static double readMemory( lsfData::LSFReader& reader, lsfData::MemoryEventSource& source, unsigned int passes )
+{
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent meta;
+  eventFile::EBF_Data ebf;
+  const double start = now();
+  for ( unsigned int p=0; p<passes; p++ ) {
+    source.rewind();
+    while ( reader.read( ccsds, meta, ebf ) ) {}
+  }
+  return now() - start;
+}
+
+static void benchMix( lsfData::EventGenerator::Mix mix, unsigned long long nevents,
+                      const std::string& dir )
+{
+  const char* name = lsfData::EventGenerator::mixName( mix );
+  const std::string filename = dir + "/bench_lsfData_" + name + ".lsf";
+
+  // deterministic input file
+  lsfData::EventGenerator gen( mix );
+  const unsigned long long bytes = gen.writeFile( filename, nevents );
+
+  lsfData::LSFReader* reader = 0;
+  try {
+    reader = new lsfData::LSFReader( filename );
+  } catch( const std::runtime_error& e ) {
+    printf( "%s\n", e.what() );
+    return;
+  }
+
+  // full read path: file -> LsfCcsds, MetaEvent and EBF_Data
+  {
+    lsfData::LsfCcsds ccsds;
+    lsfData::MetaEvent meta;
+    eventFile::EBF_Data ebf;
+    unsigned long long nread = 0, nbytes = 0;
+    Measure m;
+    try {
+      while ( reader->read( ccsds, meta, ebf ) ) {
+        nread++;
+        nbytes += ebf.size();
+      }
+    } catch( const std::runtime_error& e ) {
+      printf( "%s\n", e.what() );
+    }
+    m.report( name, "LSFReader::read", nread, nbytes );
+    if ( nread != nevents || nbytes != bytes ) {
+      printf( "%-9s read back %llu events, %llu bytes of %llu, %llu written\n",
+              name, nread, nbytes, nevents, bytes );
+    }
+  }
+  delete reader;
+
+  // the file read from the device with each kind of I/O, which is where
+  // read-ahead can make a difference
+  {
+    const lsfData::FileEventSource::Io ios[3] = {
+      lsfData::FileEventSource::StandardIo, lsfData::FileEventSource::ReadAheadIo,
+      lsfData::FileEventSource::StreamingIo };
+    const char* what[3] = { "read cold StandardIo", "read cold ReadAheadIo", "read cold StreamingIo" };
+    for ( int i=0; i<3 && evict( filename ); i++ ) {
+      lsfData::LsfCcsds ccsds;
+      lsfData::MetaEvent meta;
+      eventFile::EBF_Data ebf;
+      unsigned long long nread = 0, nbytes = 0;
+      Measure m;
+      try {
+        lsfData::LSFReader cold( filename, ios[i] );
+        while ( cold.read( ccsds, meta, ebf ) ) {
+          nread++;
+          nbytes += ebf.size();
+        }
+      } catch( const std::runtime_error& e ) {
+        printf( "%s\n", e.what() );
+      }
+      m.report( name, what[i], nread, nbytes );
+    }
+  }
+
+  // the same events regenerated in memory, so the remaining benchmarks
+  // exclude the file I/O
+  const unsigned int nmem = nevents < 4096 ? static_cast< unsigned int >( nevents ) : 4096;
+  const unsigned int passes = static_cast< unsigned int >( ( nevents + nmem - 1 ) / nmem );
+  lsfData::MemoryEventSource source( gen.runid() );
+  lsfData::EventGenerator memgen( mix );
+  memgen.fill( source, nmem );
+  const std::vector< lsfData::MemoryEventSource::Record >& records = source.records();
+  lsfData::LSFReader memreader( &source );
+
+  // full read path from memory: record copy plus conversion
+  {
+    lsfData::LsfCcsds ccsds;
+    lsfData::MetaEvent meta;
+    eventFile::EBF_Data ebf;
+    unsigned long long nread = 0, nbytes = 0;
+    Measure m;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      source.rewind();
+      while ( memreader.read( ccsds, meta, ebf ) ) {
+        nread++;
+        nbytes += ebf.size();
+      }
+    }
+    m.report( name, "LSFReader::read memory", nread, nbytes );
+  }
+
+  // the same with a SequenceMonitor attached; the best of several rounds
+  // of each, alternating, so warm-up and noise do not decide the difference
+  {
+    lsfData::SequenceMonitor monitor;
+    double plain = 0., monitored = 0.;
+    for ( int round=0; round<5; round++ ) {
+      for ( int withMonitor=0; withMonitor<2; withMonitor++ ) {
+        memreader.setMonitor( withMonitor ? &monitor : 0 );
+        const double secs = readMemory( memreader, source, passes );
+        double& best = withMonitor ? monitored : plain;
+        if ( round == 0 || secs < best ) best = secs;
+      }
+    }
+    memreader.setMonitor( 0 );
+    const unsigned long long n = static_cast< unsigned long long >( passes ) * nmem;
+    printf( "%-9s %-22s %10llu ops %9.3f s %12.0f ops/s, %+.2f%% over plain reads\n", name, "read memory + monitor",
+            n, monitored, monitored > 0 ? n / monitored : 0., plain > 0. ? 100. * ( monitored - plain ) / plain : 0. );
+  }
+
+  // handler and info decoding into a reused MetaEvent
+  std::vector< lsfData::MetaEvent > metas( nmem );
+  {
+    lsfData::LsfCcsds ccsds;
+    lsfData::MetaEvent meta;
+    Measure m;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      for ( unsigned int i=0; i<nmem; i++ ) {
+        transfer( memreader, records[i], ccsds, meta );
+      }
+    }
+    m.report( name, "transfer (decode)", static_cast< unsigned long long >( passes ) * nmem );
+  }
+  std::vector< lsfData::LsfCcsds > ccsds( nmem );
+  for ( unsigned int i=0; i<nmem; i++ ) {
+    transfer( memreader, records[i], ccsds[i], metas[i] );
+  }
+
+  // JSON Lines and CSV export of the decoded events, formatting only
+  for ( int f=0; f<2; f++ ) {
+    const lsfData::EventExporter::Format format =
+      f == 0 ? lsfData::EventExporter::JsonLines : lsfData::EventExporter::Csv;
+    lsfData::TextBuffer out( 0 );
+    lsfData::EventExporter exporter( out, format );
+    unsigned long long nbytes = 0;
+    Measure m;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      for ( unsigned int i=0; i<nmem; i++ ) {
+        exporter.write( ccsds[i], metas[i] );
+      }
+      nbytes += out.size();
+      out.clear();
+    }
+    m.report( name, f == 0 ? "export JSON Lines" : "export CSV", exporter.events(), nbytes );
+  }
+
+  // scan for passed gamma filter events, over MetaEvents and packed events
+  {
+    unsigned long long n = 0, live = 0;
+    Measure m;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      for ( unsigned int i=0; i<nmem; i++ ) {
+        const lsfData::GammaHandler* gamma = metas[i].gammaFilter();
+        if ( gamma && gamma->state() == enums::Lsf::PASSED ) {
+          n++;
+          live += metas[i].scalers().livetime();
+        }
+      }
+    }
+    m.report( name, "scan MetaEvent", static_cast< unsigned long long >( passes ) * nmem );
+    lsfData::PackedEventArray packed;
+    packed.reserve( nmem );
+    Measure mpush;
+    for ( unsigned int i=0; i<nmem; i++ ) packed.push_back( metas[i] );
+    mpush.report( name, "PackedEventArray push", nmem );
+    unsigned long long np = 0, livep = 0;
+    Measure mp;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      const lsfData::PackedMetaEvent* e = packed.begin();
+      for ( unsigned int i=0; i<nmem; i++ ) {
+        if ( e[i].has( lsfData::PackedMetaEvent::Gamma )
+             && e[i].state[lsfData::PackedMetaEvent::Gamma] == enums::Lsf::PASSED ) {
+          np++;
+          livep += e[i].livetime;
+        }
+      }
+    }
+    mp.report( name, "scan PackedMetaEvent", static_cast< unsigned long long >( passes ) * nmem );
+    if ( n != np || live != livep ) {
+      printf( "%-9s packed scan found %llu events, MetaEvent scan %llu\n", name, np, n );
+    }
+  }
+
+  // MetaEvent copy construction and clear
+  {
+    volatile unsigned long long sink = 0;
+    Measure m;
+    for ( unsigned int p=0; p<passes; p++ ) {
+      for ( unsigned int i=0; i<nmem; i++ ) {
+        lsfData::MetaEvent copy( metas[i] );
+        sink += copy.scalers().sequence();
+      }
+    }
+    m.report( name, "MetaEvent copy", static_cast< unsigned long long >( passes ) * nmem );
+  }
+  {
+    Measure m;
+    for ( unsigned int i=0; i<nmem; i++ ) {
+      metas[i].clear();
+    }
+    m.report( name, "MetaEvent clear", nmem );
+  }
+
+  remove( filename.c_str() );
+}
+
+static void benchEbf( unsigned long long nevents )
+{
+  static const unsigned int sizes[] = { 512, 4096, 16384, 65536 };
+  for ( unsigned int s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+    std::vector< char > payload( sizes[s], 'x' );
+    lsfData::Ebf ebf;
+    char what[32];
+    sprintf( what, "Ebf::set %u B", sizes[s] );
+    Measure m;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      ebf.set( &payload[0], sizes[s] );
+    }
+    m.report( "-", what, nevents, nevents * sizes[s] );
+  }
+}
+
+/// run-length coding, (count, byte) pairs: a stand-in for the flight
+/// software compression, with a similar cost per output byte
+class RunLengthCodec : public lsfData::PayloadCodec {
+public:
+  virtual bool decompress( const char* data, unsigned int length, int,
+                           std::vector< char >& out ) const {
+    if ( length % 2 ) return false;
+    for ( unsigned int i=0; i<length; i+=2 ) {
+      out.insert( out.end(), static_cast< unsigned char >( data[i] ), data[i+1] );
+    }
+    return true;
+  }
+
+  static void compress( const std::vector< char >& in, std::vector< char >& out ) {
+    out.clear();
+    for ( size_t i=0; i<in.size(); ) {
+      size_t n = 1;
+      while ( n < 255 && i + n < in.size() && in[i+n] == in[i] ) n++;
+      out.push_back( static_cast< char >( n ) );
+      out.push_back( in[i] );
+      i += n;
+    }
+  }
+};
+
+static void benchDecompress( unsigned long long nevents )
+{
+  // a 16 kB payload of short runs
+  std::vector< char > raw( 16384 ), packed;
+  for ( size_t i=0; i<raw.size(); i++ ) raw[i] = static_cast< char >( ( i / ( 3 + i % 5 ) ) & 0x7f );
+  RunLengthCodec::compress( raw, packed );
+
+  RunLengthCodec codec;
+  static const unsigned int threads[] = { 0, 1, 2, 4, 8 };
+  for ( unsigned int t=0; t<sizeof(threads)/sizeof(threads[0]); t++ ) {
+    lsfData::Decompressor pool( codec, threads[t] );
+    std::vector< char > out;
+    unsigned long long bytes = 0;
+    char what[32];
+    sprintf( what, "decompress %u thr", pool.threads() );
+    Measure m;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      if ( pool.full() ) {
+        pool.pop( out );
+        bytes += out.size();
+      }
+      pool.push( &packed[0], static_cast< unsigned int >( packed.size() ), 1 );
+    }
+    while ( pool.pop( out ) != lsfData::Decompressor::Empty ) bytes += out.size();
+    m.report( "-", what, nevents, bytes );
+  }
+}
+
+/// data TLB load misses of this thread, where perf events are allowed
+class TlbMisses {
+public:
+  TlbMisses() : m_fd(-1) {
+#if defined(__linux__) && defined(SYS_perf_event_open)
+    struct perf_event_attr attr;
+    memset( &attr, 0, sizeof(attr) );
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+      | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd = static_cast< int >( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+    if ( m_fd >= 0 ) ioctl( m_fd, PERF_EVENT_IOC_RESET, 0 );
+#endif
+  }
+  ~TlbMisses() {
+#if defined(__linux__)
+    if ( m_fd >= 0 ) close( m_fd );
+#endif
+  }
+  /// misses since construction, -1 if not available
+  long long count() const {
+    long long n = -1;
+#if defined(__linux__)
+    if ( m_fd < 0 || read( m_fd, &n, sizeof(n) ) != sizeof(n) ) n = -1;
+#endif
+    return n;
+  }
+private:
+  int m_fd;
+};
+
+// keeps the compiler from dropping the scan loops
+static volatile unsigned long long s_sink = 0;
+
+static void benchArena( unsigned long long nevents )
+{
+  // a 64 MB batch of 4 kB payloads, visited in a scattered order as a
+  // coincidence search or time-ordering window would
+  const unsigned int size = 4096, count = 16384;
+  std::vector< char > payload( size, 'x' );
+  static const char* names[] = { "batch scan 4k pages", "batch scan huge pages" };
+  for ( int p=0; p<2; p++ ) {
+    const lsfData::BufferArena::Pages pages =
+      p == 0 ? lsfData::BufferArena::SmallPages : lsfData::BufferArena::HugePages;
+    lsfData::BufferArena arena( 64 << 20, pages );
+    std::vector< const char* > batch( count );
+    for ( unsigned int i=0; i<count; i++ ) {
+      char* b = static_cast< char* >( arena.allocate( size, 64 ) );
+      memcpy( b, &payload[0], size );
+      b[0] = static_cast< char >( i );
+      batch[i] = b;
+    }
+
+    unsigned long long sum = 0;
+    const unsigned long long ops = nevents * 50;
+    TlbMisses tlb;
+    Measure m;
+    unsigned int k = 0;
+    for ( unsigned long long i=0; i<ops; i++ ) {
+      k = ( k * 1103515245u + 12345u ) & ( count - 1 );
+      sum += static_cast< unsigned char >( batch[k][0] ) + static_cast< unsigned char >( batch[k][size / 2] );
+    }
+    m.report( "-", names[p], ops );
+    s_sink = sum;
+    const long long misses = tlb.count();
+    const char* backing = arena.hugePages() ? "on huge pages" : "on small pages";
+    if ( misses >= 0 ) {
+      printf( "%-9s %-22s %10lld dTLB misses, %s\n", "-", names[p], misses, backing );
+    } else {
+      printf( "%-9s %-22s dTLB misses not available, %s\n", "-", names[p], backing );
+    }
+  }
+}
+
+static void fillEvent( lsfData::QueuedEvent& e, const lsfData::GammaHandler& gamma,
+                       const std::vector< char >& payload, unsigned int seq )
+{
+  e.meta.setConfiguration( lsfData::LpaConfiguration( seq, seq ) );
+  e.meta.setKeys( lsfData::LpaKeys( seq, 0, 0, 0 ) );
+  e.meta.addGammaHandler( gamma );
+  e.ebf.set( const_cast< char* >( &payload[0] ), static_cast< unsigned int >( payload.size() ) );
+  e.ebf.setSequence( seq );
+}
+
+static void benchPool( unsigned long long nevents )
+{
+  // a window of 64 buffered events, the oldest dropped as each new one arrives
+  const unsigned int window = 64;
+  std::vector< char > payload( 4096, 'x' );
+  lsfData::GammaHandler gamma;
+  gamma.set( 0, 0, 0, enums::Lsf::PASSED, enums::Lsf::UNSUPPORTED, 1, enums::Lsf::GAMMA, true );
+  gamma.setStatus( 0, 0, 0, 0 );
+
+  std::vector< lsfData::QueuedEvent* > ring( window, static_cast< lsfData::QueuedEvent* >( 0 ) );
+  {
+    Measure m;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      lsfData::QueuedEvent*& slot = ring[ i % window ];
+      delete slot;
+      slot = new lsfData::QueuedEvent;
+      fillEvent( *slot, gamma, payload, static_cast< unsigned int >( i ) );
+    }
+    m.report( "-", "event new/delete", nevents );
+    for ( unsigned int i=0; i<window; i++ ) {
+      delete ring[i];
+      ring[i] = 0;
+    }
+  }
+  {
+    lsfData::EventPool pool( window );
+    // one pass to give every pooled event its buffers
+    for ( unsigned int i=0; i<window; i++ ) {
+      ring[i] = pool.acquire();
+      fillEvent( *ring[i], gamma, payload, i );
+    }
+    for ( unsigned int i=0; i<window; i++ ) {
+      pool.release( ring[i] );
+      ring[i] = 0;
+    }
+    Measure m;
+    for ( unsigned long long i=0; i<nevents; i++ ) {
+      lsfData::QueuedEvent*& slot = ring[ i % window ];
+      pool.release( slot );
+      slot = pool.acquire();
+      fillEvent( *slot, gamma, payload, static_cast< unsigned int >( i ) );
+    }
+    m.report( "-", "event pool", nevents );
+    for ( unsigned int i=0; i<window; i++ ) pool.release( ring[i] );
+  }
+}
+
+static void benchExposure( unsigned long long nevents )
+{
+  // a run's worth of events at ~500 Hz, with 28 bit scalers rolling over,
+  // binned by one thread and by two halves merged
+  const unsigned long long ops = nevents * 50;
+  std::vector< double > times( ops );
+  std::vector< lsfData::GemScalers > scalers( ops );
+  const unsigned long long mask = ( 1ULL << 28 ) - 1;
+  unsigned long long elapsed = 0, live = 0, dead = 0;
+  unsigned int state = 1;
+  for ( unsigned long long i=0; i<ops; i++ ) {
+    state = state * 1103515245u + 12345u;
+    const unsigned long long dt = 20000 + ( state >> 16 ) % 40000;
+    elapsed += dt;
+    live += dt - 500;
+    dead += ( state >> 8 ) & 1;
+    times[i] = elapsed / double( lsfData::Time::TICKS_PER_SECOND );
+    scalers[i] = lsfData::GemScalers( elapsed & mask, live & mask, 0, 0, 0, dead & mask );
+  }
+
+  double livetime = 0.;
+  {
+    lsfData::ExposureBinner binner( 30., 0., 28 );
+    Measure m;
+    for ( unsigned long long i=0; i<ops; i++ ) binner.add( times[i], scalers[i] );
+    m.report( "-", "exposure bins", ops );
+    livetime = binner.total().livetime;
+  }
+  {
+    lsfData::ExposureBinner first( 30., 0., 28 ), second( 30., 0., 28 );
+    Measure m;
+    for ( unsigned long long i=0; i<ops/2; i++ ) first.add( times[i], scalers[i] );
+    second.restart( times[ops/2-1], scalers[ops/2-1] );
+    for ( unsigned long long i=ops/2; i<ops; i++ ) second.add( times[i], scalers[i] );
+    first.merge( second );
+    m.report( "-", "exposure bins merged", ops );
+    if ( std::fabs( first.total().livetime - livetime ) > 1e-3 ) {
+      printf( "%-9s exposure merge disagrees: %f vs %f s\n", "-", first.total().livetime, livetime );
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  // bench_lsfData [nevents [scratch directory]]
+  unsigned long long nevents = 20000;
+  std::string dir( "/tmp" );
+  if ( argc >= 2 ) nevents = strtoull( argv[1], 0, 10 );
+  if ( argc >= 3 ) dir = argv[2];
+  if ( nevents == 0 ) nevents = 1;
+
+  printf( "lsfData benchmarks, %llu events per mix, scratch files in %s\n",
+          nevents, dir.c_str() );
+  for ( int mix=0; mix<lsfData::EventGenerator::MixCnt; mix++ ) {
+    benchMix( static_cast< lsfData::EventGenerator::Mix >( mix ), nevents, dir );
+  }
+  benchEbf( nevents );
+  benchDecompress( nevents );
+  benchArena( nevents );
+  benchPool( nevents );
+  benchExposure( nevents );
+
+  lsfData::Diagnostics::summary( std::cout );
+  if ( lsfData::Profile::enabled() ) {
+    lsfData::Profile::Snapshot snap;
+    lsfData::Profile::snapshot( snap );
+    lsfData::Profile::print( snap, std::cout );
+  }
+  return 0;
+}
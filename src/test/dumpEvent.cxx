@@ -1,8 +1,14 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 #include "eventFile/EBF_Data.h"
 #include "eventFile/LPA_Handler.h"
@@ -16,6 +22,8 @@
 #include "lsfData/LsfTime.h"
 #include "lsfData/LsfTimeTone.h"
 #include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfTextBuffer.h"
+#include "lsfData/LsfFormatter.h"
 
 #include "LATdatagramIterator.h"
 #include "EBFeventIterator.h"
@@ -34,6 +42,216 @@ private:
   MyLATcomponentIterator* _lci;
 };
 
+// in LDFdump.cxx: send this thread's dump output to sink, or stdout if 0
+void LDFdumpTo( lsfData::TextBuffer* sink );
+
+namespace {
+
+#ifndef _WIN32
+  // Nothing in the LDF library says its iterators may run on several
+  // threads at once, so the EBF walk is done by one thread at a time; the
+  // workers still format the CCSDS and event info sections in parallel.
+  pthread_mutex_t s_ldfMutex = PTHREAD_MUTEX_INITIALIZER;
+
+  class LdfLock {
+  public:
+    LdfLock() { pthread_mutex_lock( &s_ldfMutex ); }
+    ~LdfLock() { pthread_mutex_unlock( &s_ldfMutex ); }
+  };
+#else
+  class LdfLock {};
+#endif
+
+  // render one event exactly as the single threaded dump prints it
+  void dumpEvent( lsfData::TextBuffer& out, const lsfData::LsfCcsds& lccsds,
+                  const lsfData::MetaEvent& lmeta, const eventFile::EBF_Data& ebf )
+  {
+    using lsfData::Formatter;
+    const unsigned long long seq = lmeta.scalers().sequence();
+
+    // print out the context
+    out.append( "==========================================\n" );
+    out.append( "\nEvent " ).dec( seq ).append( " CCSDS:" );
+    out.append( "\n------------------\n" );
+    Formatter::format( out, lccsds );
+
+    out.append( "\nEvent " ).dec( seq ).append( " info:" );
+    out.append( "\n---------------\n" );
+    Formatter::format( out, lmeta.run() );
+    Formatter::format( out, lmeta.datagram() );
+    Formatter::format( out, lmeta.scalers() );
+    Formatter::format( out, lmeta.time() );
+    if ( lmeta.configuration() ) Formatter::format( out, *lmeta.configuration() );
+
+    // iterate over the contributions and print them out
+    out.append( "\nEvent " ).dec( seq ).append( " data:" );
+    out.append( "\n---------------\n" );
+    out.dec( static_cast< unsigned long long >( ebf.size() ) ).append( " bytes of EBF\n" );
+    {
+      LdfLock lock;
+      LDFdumpTo( &out );
+      MyEBFeventIterator eei;
+      eei.iterate( const_cast< EBFevent* >( ebf.start() ),
+		   const_cast< EBFevent* >( ebf.end() ) );
+      LDFdumpTo( 0 );
+    }
+    out.append( '\n' );
+  }
+
+#ifndef _WIN32
+
+  /** Renders batches of events on a set of worker threads.  The caller
+      fills the slots of a batch, calls start(), then collects the rendered
+      text slot by slot with wait(), so output keeps the file order while
+      later events are still being rendered. */
+  class DumpPool {
+  public:
+
+    struct Slot {
+      Slot() : text( 0, 64*1024 ), done( false ) {}
+      lsfData::LsfCcsds   ccsds;
+      lsfData::MetaEvent  meta;
+      eventFile::EBF_Data ebf;
+      lsfData::TextBuffer text;
+      bool                done;
+    };
+
+    DumpPool( unsigned nthreads, unsigned batch )
+      : m_count( 0 ), m_next( 0 ), m_quit( false )
+    {
+      pthread_mutex_init( &m_mutex, 0 );
+      pthread_cond_init( &m_work, 0 );
+      pthread_cond_init( &m_done, 0 );
+      for ( unsigned i=0; i<batch; i++ ) m_slots.push_back( new Slot );
+      for ( unsigned i=0; i<nthreads; i++ ) {
+	pthread_t tid;
+	if ( pthread_create( &tid, 0, &DumpPool::run, this ) == 0 ) {
+	  m_threads.push_back( tid );
+	}
+      }
+    }
+
+    ~DumpPool()
+    {
+      pthread_mutex_lock( &m_mutex );
+      m_quit = true;
+      pthread_cond_broadcast( &m_work );
+      pthread_mutex_unlock( &m_mutex );
+      for ( size_t i=0; i<m_threads.size(); i++ ) pthread_join( m_threads[i], 0 );
+      for ( size_t i=0; i<m_slots.size(); i++ ) delete m_slots[i];
+      pthread_cond_destroy( &m_done );
+      pthread_cond_destroy( &m_work );
+      pthread_mutex_destroy( &m_mutex );
+    }
+
+    bool ok() const { return !m_threads.empty(); }
+    size_t capacity() const { return m_slots.size(); }
+    Slot& slot( size_t i ) { return *m_slots[i]; }
+
+    /// hand the first n slots to the workers
+    void start( size_t n )
+    {
+      pthread_mutex_lock( &m_mutex );
+      for ( size_t i=0; i<n; i++ ) m_slots[i]->done = false;
+      m_count = n;
+      m_next = 0;
+      pthread_cond_broadcast( &m_work );
+      pthread_mutex_unlock( &m_mutex );
+    }
+
+    /// block until slot i of the current batch has been rendered
+    Slot& wait( size_t i )
+    {
+      pthread_mutex_lock( &m_mutex );
+      while ( !m_slots[i]->done ) pthread_cond_wait( &m_done, &m_mutex );
+      pthread_mutex_unlock( &m_mutex );
+      return *m_slots[i];
+    }
+
+  private:
+
+    static void* run( void* arg )
+    {
+      static_cast< DumpPool* >( arg )->work();
+      return 0;
+    }
+
+    void work()
+    {
+      pthread_mutex_lock( &m_mutex );
+      while ( true ) {
+	while ( !m_quit && m_next == m_count ) {
+	  pthread_cond_wait( &m_work, &m_mutex );
+	}
+	if ( m_quit ) break;
+	while ( m_next < m_count ) {
+	  Slot& s = *m_slots[m_next++];
+	  pthread_mutex_unlock( &m_mutex );
+	  s.text.clear();
+	  dumpEvent( s.text, s.ccsds, s.meta, s.ebf );
+	  pthread_mutex_lock( &m_mutex );
+	  s.done = true;
+	  pthread_cond_broadcast( &m_done );
+	}
+      }
+      pthread_mutex_unlock( &m_mutex );
+    }
+
+    // no copies
+    DumpPool( const DumpPool& );
+    DumpPool& operator=( const DumpPool& );
+
+    std::vector< Slot* >     m_slots;
+    std::vector< pthread_t > m_threads;
+    pthread_mutex_t          m_mutex;
+    pthread_cond_t           m_work;
+    pthread_cond_t           m_done;
+    size_t                   m_count;    // slots in the current batch
+    size_t                   m_next;     // next slot to render
+    bool                     m_quit;
+  };
+
+  /// dump every remaining event with nthreads workers; false on a read error
+  bool dumpAll( lsfData::LSFReader& lsf, unsigned nthreads )
+  {
+    DumpPool pool( nthreads, 64 * nthreads );
+    if ( !pool.ok() ) return false;
+
+    bool bmore = true;
+    std::string error;
+    while ( bmore ) {
+      size_t n = 0;
+      while ( n < pool.capacity() ) {
+	DumpPool::Slot& s = pool.slot( n );
+	try {
+	  bmore = lsf.read( s.ccsds, s.meta, s.ebf );
+	} catch( std::runtime_error e ) {
+	  error = e.what();
+	  bmore = false;
+	}
+	if ( !bmore ) break;
+	n++;
+      }
+      if ( n == 0 ) break;
+
+      // write each event as soon as it and those before it are rendered
+      pool.start( n );
+      for ( size_t i=0; i<n; i++ ) {
+	DumpPool::Slot& s = pool.wait( i );
+	fwrite( s.text.data(), 1, s.text.size(), stdout );
+      }
+    }
+    if ( !error.empty() ) {
+      fflush( stdout );
+      std::cout << error << std::endl;
+    }
+    return true;
+  }
+
+#endif
+
+}
+
 int main( int argc, char* argv[] )
 {
   // create the LPA_File object from which input will be read
@@ -41,20 +259,24 @@ int main( int argc, char* argv[] )
   std::string lsefile( "$(EVENTFILEROOT)/src/test/events.lpa" );
   std::string idbase;
   std::string idstr;
+  unsigned nthreads = 1;
   if ( argc >= 4 ) {
     lsefile = argv[1];
     idbase = argv[2];
     idstr  = argv[3];
+    if ( argc >= 5 ) nthreads = atoi( argv[4] );
   } else {
-    printf( "usage: dumpEvent file.evt gem|file eventid\n" );
+    printf( "usage: dumpEvent file.evt gem|file eventid|all [threads]\n" );
+    printf( "       threads > 1 dumps all events in parallel, in file order\n" );
     exit( 1 );
   }
   try {
     pLSF = new lsfData::LSFReader( lsefile );
   } catch( std::runtime_error e ) {
     std::cout << e.what() << std::endl;
+    return 1;
   }
-   
+
   // get the event id and the base
   bool bgem = true;
   if ( idbase == "file" ) bgem = false;
@@ -92,6 +314,7 @@ int main( int argc, char* argv[] )
   lsfData::LsfCcsds lccsds;
   lsfData::MetaEvent lmeta;
   eventFile::EBF_Data ebf;
+  lsfData::TextBuffer out( stdout );
 
   // retrieve each event in turn
   unsigned long long fileid = 0;
@@ -100,6 +323,7 @@ int main( int argc, char* argv[] )
     try {
       bmore = pLSF->read( lccsds, lmeta, ebf );
     } catch( std::runtime_error e ) {
+      out.flush();
       std::cout << e.what() << std::endl;
       break;
     }
@@ -116,35 +340,25 @@ int main( int argc, char* argv[] )
       }
     }
 
-    // print out the context
-    printf( "==========================================\n" );
-    printf( "\nEvent %lld CCSDS:", lmeta.scalers().sequence() );
-    printf( "\n------------------\n" );
-    lccsds.print();
-
-    printf( "\nEvent %lld info:", lmeta.scalers().sequence() );
-    printf( "\n---------------\n" );
-    lmeta.run().print();
-    lmeta.datagram().print();
-    lmeta.scalers().print();
-    lmeta.time().print();
-    lmeta.configuration()->print();
+    dumpEvent( out, lccsds, lmeta, ebf );
+    out.flush();
 
-    // iterate over the contributions and print them out
-    printf( "\nEvent %lld data:", lmeta.scalers().sequence() );
-    printf( "\n---------------\n" );
-    printf( "%d bytes of EBF\n", ebf.size() );
-    MyEBFeventIterator eei;
-    eei.iterate( const_cast< EBFevent* >( ebf.start() ), 
-		 const_cast< EBFevent* >( ebf.end() ) );
-    printf( "\n" );
-
-    // break after dumping one event 
+    // break after dumping one event
     if ( !ball ) {
       break;
     }
 
+#ifndef _WIN32
+    // the rest in parallel, if asked for
+    if ( nthreads > 1 ) {
+      if ( dumpAll( *pLSF, nthreads ) ) break;
+      nthreads = 1;
+    }
+#endif
+
   } while ( true );
+  out.flush();
+  fflush( stdout );
   delete pLSF;
 
   // all done
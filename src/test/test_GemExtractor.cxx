@@ -0,0 +1,191 @@
+#include <stdio.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "eventFile/EBF_Data.h"
+
+#include "lsfData/LSFReader.h"
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfGemExtractor.h"
+#include "lsfData/LsfEbfIndexer.h"
+#include "lsfData/Ebf.h"
+
+#include "EBFeventIterator.h"
+#include "EBFcontributionIterator.h"
+
+// Checks GemExtractor against the GEM contribution handed out by the LDF
+// contribution iterator, field by field, for every event of a file, and
+// checks that the batch extractor agrees with the single event one.
+
+static int failures = 0;
+
+static void check( bool ok, unsigned long long event, const char* what )
+{
+  if ( !ok ) {
+    if ( failures < 20 ) printf( "FAILED: event %llu: %s\n", event, what );
+    failures++;
+  }
+}
+
+class GemFinder : public EBFcontributionIterator
+{
+public:
+  GemFinder() : EBFcontributionIterator(), gem( 0 ), count( 0 ) {}
+  virtual ~GemFinder() {}
+
+  virtual int handleError( EBFevent*, unsigned code, unsigned = 0, unsigned = 0 ) const { return code; }
+  virtual int handleError( EBFcontribution*, unsigned code, unsigned = 0, unsigned = 0 ) const { return code; }
+
+  virtual int UDF( EBFevent*, EBFcontribution* ) { return 0; }
+  virtual int OSW( EBFevent*, OSWcontribution* ) { return 0; }
+  virtual int GLT( EBFevent*, GLTcontribution* ) { return 0; }
+  virtual int GEM( EBFevent*, GEMcontribution* c ) { if ( !gem ) gem = c; count++; return 0; }
+  virtual int ACD( EBFevent*, AEMcontribution* ) { return 0; }
+  virtual int TEM( EBFevent*, TEMcontribution* ) { return 0; }
+
+  GEMcontribution* gem;
+  unsigned         count;
+};
+
+class GemEventIterator : public EBFeventIterator
+{
+public:
+  virtual ~GemEventIterator() {}
+  virtual int handleError( EBFevent*, unsigned code, unsigned = 0, unsigned = 0 ) const { return code; }
+  virtual int process( EBFevent* event ) { finder.iterate( event ); return 0; }
+  GemFinder finder;
+};
+
+static void compare( unsigned long long event, GEMcontribution& g, const lsfData::GemSummary& s )
+{
+  check( s.valid, event, "extractor found no GEM" );
+  check( s.roiVector == g.roiVector(), event, "roiVector" );
+  check( s.tkrVector == g.tkrVector(), event, "tkrVector" );
+  check( s.calHEvector == g.calHEvector(), event, "calHEvector" );
+  check( s.calLEvector == g.calLEvector(), event, "calLEvector" );
+  check( s.cnoVector == g.cnoVector(), event, "cnoVector" );
+  check( s.conditionSummary == g.conditionSummary(), event, "conditionSummary" );
+  check( s.missed == g.missed(), event, "missed" );
+  check( s.tileXZM == g.tileList()->XZM() && s.tileXZP == g.tileList()->XZP(), event, "tiles XZ" );
+  check( s.tileYZM == g.tileList()->YZM() && s.tileYZP == g.tileList()->YZP(), event, "tiles YZ" );
+  check( s.tileXY == g.tileList()->XY(), event, "tiles XY" );
+  check( s.tileRBN == g.tileList()->RBN() && s.tileNA == g.tileList()->NA(), event, "tiles RBN/NA" );
+  check( s.liveTime == g.liveTime(), event, "liveTime" );
+  check( s.prescaled == g.prescaled(), event, "prescaled" );
+  check( s.discarded == g.discarded(), event, "discarded" );
+  check( s.condArrTime == g.condArrTime().datum(), event, "condArrTime" );
+  check( s.condArrRoi == g.condArrTime().roi() && s.condArrTkr == g.condArrTime().tkr(), event, "condArr roi/tkr" );
+  check( s.condArrExternal == g.condArrTime().external() && s.condArrCno == g.condArrTime().cno(),
+         event, "condArr external/cno" );
+  check( s.condArrCalHE == g.condArrTime().calHE() && s.condArrCalLE == g.condArrTime().calLE(),
+         event, "condArr calHE/calLE" );
+  check( s.triggerTime == g.triggerTime(), event, "triggerTime" );
+  check( s.onePPSseconds == g.onePPStime().seconds(), event, "onePPS seconds" );
+  check( s.onePPStimebase == g.onePPStime().timebase(), event, "onePPS timebase" );
+  check( s.deltaWindowOpenTime == g.deltaWindowOpenTime(), event, "deltaWindowOpenTime" );
+  check( s.deltaEventTime == g.deltaEventTime(), event, "deltaEventTime" );
+  check( s.eventNumber == EventSummary::eventNumber( g.summary() ), event, "eventNumber" );
+  check( s.tag == EventSummary::tag( g.summary() ), event, "tag" );
+}
+
+static bool same( const lsfData::GemSummary& a, const lsfData::GemSummary& b )
+{
+  return a.valid == b.valid && a.roiVector == b.roiVector && a.conditionSummary == b.conditionSummary
+    && a.tileXY == b.tileXY && a.liveTime == b.liveTime && a.prescaled == b.prescaled
+    && a.discarded == b.discarded && a.triggerTime == b.triggerTime && a.eventNumber == b.eventNumber
+    && a.tag == b.tag;
+}
+
+int main( int argc, char* argv[] )
+{
+  std::string lsefile( "$(EVENTFILEROOT)/src/test/events.lpa" );
+  if ( argc >= 2 ) {
+    lsefile = argv[1];
+  }
+  lsfData::LSFReader* pLSF = NULL;
+  try {
+    pLSF = new lsfData::LSFReader( lsefile );
+  } catch( const std::runtime_error& e ) {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+
+  const unsigned BATCH = 64;
+  std::vector< eventFile::EBF_Data > batch;
+  std::vector< lsfData::GemSummary > single;
+  std::vector< lsfData::GemSummary > batched( BATCH );
+
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent meta;
+  eventFile::EBF_Data ebf;
+  lsfData::GemSummary fast, indexed;
+  unsigned long long nevt = 0, ngem = 0;
+  bool bmore = true;
+  while ( bmore ) {
+    try {
+      bmore = pLSF->read( ccsds, meta, ebf );
+    } catch( const std::runtime_error& e ) {
+      std::cout << e.what() << std::endl;
+      break;
+    }
+    if ( bmore ) {
+      nevt++;
+
+      // reference: the contribution iterator
+      GemEventIterator eei;
+      eei.iterate( const_cast< EBFevent* >( ebf.start() ),
+                   const_cast< EBFevent* >( ebf.end() ) );
+
+      // fast path, walking up to the GEM only
+      const bool found = lsfData::GemExtractor::extract( ebf, fast );
+      check( found == ( eei.finder.gem != 0 ), nevt, "GEM presence" );
+      if ( eei.finder.gem ) {
+        ngem++;
+        compare( nevt, *eei.finder.gem, fast );
+      }
+
+      // through a full index, as for an Ebf that has one
+      lsfData::Ebf indexedEbf( const_cast< char* >( reinterpret_cast< const char* >( ebf.start() ) ),
+                               static_cast< unsigned int >( ebf.size() ) );
+      lsfData::EbfIndexer::build( indexedEbf );
+      check( lsfData::GemExtractor::extract( indexedEbf, indexed ) == found && same( fast, indexed ),
+             nevt, "indexed extraction" );
+
+      // a payload cut inside the GEM has none
+      if ( eei.finder.gem ) {
+        const char* base = reinterpret_cast< const char* >( ebf.start() );
+        const unsigned int cut = static_cast< unsigned int >( reinterpret_cast< const char* >( eei.finder.gem ) - base ) + 4;
+        lsfData::GemSummary truncated;
+        check( !lsfData::GemExtractor::extract( base, cut, truncated ) && !truncated.valid, nevt, "truncated GEM" );
+      }
+
+      batch.push_back( ebf );
+      single.push_back( fast );
+    }
+
+    // the batch extractor must agree with the single event one
+    if ( batch.size() == BATCH || ( !bmore && !batch.empty() ) ) {
+      const unsigned n = lsfData::GemExtractor::extract( &batch[0], batch.size(), &batched[0] );
+      unsigned nvalid = 0;
+      for ( unsigned i=0; i<batch.size(); i++ ) {
+        check( same( single[i], batched[i] ), nevt - batch.size() + i + 1, "batch extraction" );
+        if ( single[i].valid ) nvalid++;
+      }
+      check( n == nvalid, nevt, "batch count" );
+      batch.clear();
+      single.clear();
+    }
+  }
+  delete pLSF;
+
+  printf( "%llu events, %llu with a GEM contribution\n", nevt, ngem );
+  if ( failures ) {
+    printf( "%d check(s) failed\n", failures );
+    return 1;
+  }
+  printf( "all checks passed\n" );
+  return 0;
+}
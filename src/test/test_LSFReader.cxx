@@ -16,6 +16,11 @@
 #include "lsfData/LsfTime.h"
 #include "lsfData/LsfTimeTone.h"
 #include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfSequenceMonitor.h"
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfProfile.h"
+#include "lsfData/LsfTextBuffer.h"
+#include "lsfData/LsfFormatter.h"
 
 int main( int argc, char* argv[] )
 {
@@ -51,10 +56,15 @@ int main( int argc, char* argv[] )
   }
   printf( "\n" );
 
+  // watch for sequence and datagram gaps while reading
+  lsfData::SequenceMonitor monitor;
+  pLSF->setMonitor( &monitor );
+
   // declare objects to receive the event information
   lsfData::LsfCcsds lccsds;
   lsfData::MetaEvent lmeta;
   eventFile::EBF_Data ebf;
+  lsfData::TextBuffer out( stdout );
 
   // retrieve each event in turn
   bool bmore = true;
@@ -62,35 +72,57 @@ int main( int argc, char* argv[] )
     try {
       bmore = pLSF->read( lccsds, lmeta, ebf );
     } catch( std::runtime_error e ) {
+      out.flush();
       std::cout << e.what() << std::endl;
       break;
     }
     if ( !bmore ) break;
 
-    // print out the context
-    printf( "==========================================\n" );
-    printf( "\nEvent %lld CCSDS:", lmeta.scalers().sequence() );
-    printf( "\n------------------\n" );
-    lccsds.print();
+    // print out the context, buffered and written in large blocks
+    const unsigned long long seq = lmeta.scalers().sequence();
+    out.append( "==========================================\n" );
+    out.append( "\nEvent " ).dec( seq ).append( " CCSDS:" );
+    out.append( "\n------------------\n" );
+    lsfData::Formatter::format( out, lccsds );
 
-    printf( "\nEvent %lld info:", lmeta.scalers().sequence() );
-    printf( "\n---------------\n" );
-    lmeta.run().print();
-    lmeta.datagram().print();
-    lmeta.scalers().print();
-    lmeta.time().print();
-    lmeta.configuration()->print();
-    lmeta.keys()->print();
+    out.append( "\nEvent " ).dec( seq ).append( " info:" );
+    out.append( "\n---------------\n" );
+    lsfData::Formatter::format( out, lmeta.run() );
+    lsfData::Formatter::format( out, lmeta.datagram() );
+    lsfData::Formatter::format( out, lmeta.scalers() );
+    lsfData::Formatter::format( out, lmeta.time() );
+    lsfData::Formatter::format( out, *lmeta.configuration() );
+    lsfData::Formatter::format( out, *lmeta.keys() );
 
     // iterate over the contributions and print them out
-    printf( "\nEvent %lld data:", lmeta.scalers().sequence() );
-    printf( "\n---------------\n" );
-    printf( "%d bytes of EBF\n", ebf.size() );
-    printf( "\n" );
+    out.append( "\nEvent " ).dec( seq ).append( " data:" );
+    out.append( "\n---------------\n" );
+    out.dec( static_cast< unsigned int >( ebf.size() ) ).append( " bytes of EBF\n" );
+    out.append( '\n' );
 
   } while ( true );
+  out.flush();
   delete pLSF;
 
+  // summarize what the monitor saw
+  printf( "%u events read\n", monitor.totalEvents() );
+  monitor.print();
+  lsfData::SequenceMonitor::Gap gaps[ lsfData::SequenceMonitor::MAX_GAPS ];
+  unsigned ngaps = monitor.recentGaps( gaps, lsfData::SequenceMonitor::MAX_GAPS );
+  for ( unsigned i=0; i<ngaps; i++ ) {
+    printf( "apid %04u gap type %u at event %llu (datagram %u, utc %18.6f): expected %llu, found %llu\n",
+            gaps[i].apid, gaps[i].type, gaps[i].event, gaps[i].datagram, gaps[i].utc,
+            gaps[i].expected, gaps[i].found );
+  }
+  lsfData::Diagnostics::summary( std::cout );
+
+  // per-stage timings, if the library was built with LSFDATA_PROFILE
+  if ( lsfData::Profile::enabled() ) {
+    lsfData::Profile::Snapshot snap;
+    lsfData::Profile::snapshot( snap );
+    lsfData::Profile::print( snap, std::cout );
+  }
+
   // all done
   return 0;
 }
@@ -1,3 +1,1569 @@
-int main() {
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#endif
+
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "eventFile/LSEWriter.h"
+
+#include "lsfData/LsfCcsds.h"
+#include "lsfData/LsfMetaEvent.h"
+#include "lsfData/LsfSequenceMonitor.h"
+#include "lsfData/LsfDiagnostics.h"
+#include "lsfData/LsfMemoryEventSource.h"
+#include "lsfData/LsfContextObserver.h"
+#include "lsfData/LsfEventRange.h"
+#include "lsfData/LSFReader.h"
+#include "lsfData/LsfRunInfo.h"
+#include "lsfData/LsfDatagramInfo.h"
+#include "lsfData/LsfGemScalers.h"
+#include "lsfData/LsfTime.h"
+#include "lsfData/LsfKeys.h"
+#include "lsfData/LsfTextBuffer.h"
+#include "lsfData/LsfFormatter.h"
+#include "lsfData/LsfEventExporter.h"
+#include "lsfData/LsfEbfIndex.h"
+#include "lsfData/Ebf.h"
+#include "lsfData/LsfPackedMetaEvent.h"
+#include "lsfData/LsfReadAhead.h"
+#include "lsfData/LsfDecompressor.h"
+#include "lsfData/LsfMetaEventSnapshot.h"
+#include "lsfData/LsfEventQueue.h"
+#include "lsfData/LsfEventPool.h"
+#include "lsfData/LsfNuma.h"
+#include "lsfData/LsfBufferArena.h"
+#include "lsfData/LsfRunCatalog.h"
+#include "lsfData/LsfTimeWindowQuery.h"
+#include "lsfData/LsfExposureBinner.h"
+
+static int failures = 0;
+
+static void check( bool ok, const char* what )
+{
+  if ( !ok ) {
+    printf( "FAILED: %s\n", what );
+    failures++;
+  }
+}
+
+static void feed( lsfData::SequenceMonitor& mon, int apid,
+                  unsigned long long seq, unsigned int dgm )
+{
+  lsfData::LsfCcsds ccsds;
+  ccsds.initialize( 0x4D, apid, 1000.0 + seq );
+  lsfData::MetaEvent meta;
+  meta.setScalers( lsfData::GemScalers( 0, 0, 0, 0, seq, 0 ) );
+  lsfData::DatagramInfo dgmInfo;
+  dgmInfo.setDatagrams( dgm );
+  meta.setDatagram( dgmInfo );
+  mon.update( ccsds, meta );
+}
+
+static void testSequenceMonitor()
+{
+  lsfData::SequenceMonitor mon;
+  feed( mon, 956, 10, 1 );
+  feed( mon, 956, 11, 1 );
+  feed( mon, 956, 15, 3 );   // 3 sequence numbers and 1 datagram missing
+  feed( mon, 956, 14, 3 );   // backwards
+  feed( mon, 957, 100, 7 );  // first event on another apid is never a gap
+
+  check( mon.totalEvents() == 5, "monitor event count" );
+  check( mon.events(956) == 4 && mon.events(957) == 1, "monitor per-apid events" );
+  check( mon.gaps(956, lsfData::SequenceMonitor::SequenceGap) == 1, "monitor sequence gap" );
+  check( mon.missing(956) == 3, "monitor missing count" );
+  check( mon.gaps(956, lsfData::SequenceMonitor::SequenceBackward) == 1, "monitor backward jump" );
+  check( mon.gaps(956, lsfData::SequenceMonitor::DatagramGap) == 1, "monitor datagram gap" );
+  check( mon.gaps(957, lsfData::SequenceMonitor::SequenceGap) == 0, "monitor new apid" );
+
+  lsfData::SequenceMonitor::Gap gaps[4];
+  unsigned int n = mon.recentGaps( gaps, 4 );
+  check( n == 3, "monitor gap records" );
+  check( n > 0 && gaps[0].event == 2 && gaps[0].expected == 12 && gaps[0].found == 15,
+         "monitor gap location" );
+
+  // two EPUs sharing the triggers: gaps on each apid, none in the merged stream
+  lsfData::SequenceMonitor perApid, merged( lsfData::SequenceMonitor::Merged );
+  for ( unsigned int i=0; i<6; i++ ) {
+    feed( perApid, 956 + i % 2, 20 + i, 1 + i / 2 );
+    feed( merged, 956 + i % 2, 20 + i, 1 + i / 2 );
+  }
+  feed( merged, 957, 30, 4 );
+  check( perApid.totalGaps( lsfData::SequenceMonitor::SequenceGap ) == 4, "monitor per-apid sequence" );
+  check( merged.gaps( 956, lsfData::SequenceMonitor::SequenceGap ) == 0 &&
+         merged.gaps( 957, lsfData::SequenceMonitor::SequenceGap ) == 1 && merged.missing( 957 ) == 4 &&
+         merged.totalGaps( lsfData::SequenceMonitor::DatagramGap ) == 0, "monitor merged sequence" );
+}
+
+#ifndef _WIN32
+namespace {
+  void* reportAnomalies( void* )
+  {
+    for ( int i=0; i<1000; i++ ) {
+      lsfData::Diagnostics::report( lsfData::Diagnostics::NoGammaRsd, 7 );
+    }
     return 0;
+  }
+}
+#endif
+
+static void testDiagnostics()
+{
+  std::ostringstream log;
+  lsfData::Diagnostics::reset();
+  lsfData::Diagnostics::setStream( &log );
+  lsfData::Diagnostics::setLogLimit( 2 );
+
+  for ( int i=0; i<100; i++ ) {
+    lsfData::GammaHandler gam;
+    gam.set( 0, 0, 0, enums::Lsf::PASSED, enums::Lsf::UNSUPPORTED, 9,
+             enums::Lsf::GAMMA, true );
+    gam.setStatus( 0, 0, 0, 0 );
+    check( gam.rsd() == 0, "diagnostics unknown gamma version has no rsd" );
+  }
+  check( lsfData::Diagnostics::count( lsfData::Diagnostics::InvalidGammaVersion ) == 100,
+         "diagnostics count" );
+  check( lsfData::Diagnostics::total() == 100, "diagnostics total" );
+
+  // 2 messages, the suppression notice, then one each at 4, 8, 16, 32 and 64
+  unsigned int lines = 0;
+  std::string text = log.str();
+  for ( std::string::size_type i=0; i<text.size(); i++ ) {
+    if ( text[i] == '\n' ) lines++;
+  }
+  check( lines == 8, "diagnostics rate limit" );
+
+#ifndef _WIN32
+  // every line logged whole from several threads at once
+  std::ostringstream shared;
+  lsfData::Diagnostics::reset();
+  lsfData::Diagnostics::setStream( &shared );
+  lsfData::Diagnostics::setLogLimit( 4000 );
+  pthread_t tids[4];
+  for ( int i=0; i<4; i++ ) pthread_create( &tids[i], 0, reportAnomalies, 0 );
+  for ( int i=0; i<4; i++ ) pthread_join( tids[i], 0 );
+  std::istringstream in( shared.str() );
+  std::string line;
+  unsigned int whole = 0;
+  while ( std::getline( in, line ) ) {
+    if ( line == "LSEReader ERROR:  No matching GammaRsd found! version is: 7" ) whole++;
+  }
+  check( whole == 4000 && lsfData::Diagnostics::count( lsfData::Diagnostics::NoGammaRsd ) == 4000,
+         "diagnostics threads" );
+#endif
+
+  lsfData::Diagnostics::setStream( &std::cout );
+  lsfData::Diagnostics::setLogLimit( 10 );
+  lsfData::Diagnostics::reset();
+}
+
+static void testMemoryEventSource()
+{
+  lsfData::MemoryEventSource source( 77000123 );
+  lsfData::MemoryEventSource::Record rec;
+  memset( &rec.ctx, 0, sizeof(rec.ctx) );
+  rec.ctx.ccsds.scid = 0x4D;
+  rec.ctx.ccsds.apid = 956;
+  rec.ctx.ccsds.utc  = 1000.5;
+  rec.ctx.run.startedAt = 77000100;
+  rec.ctx.scalers.sequence = 42;
+  rec.infotype = eventFile::LSE_Info::LCI_TKR;
+  rec.tinfo.injected  = 3;
+  rec.tinfo.threshold = 7;
+  rec.tinfo.timeTics  = 1234;
+  rec.tinfo.compressionLevel = 0;
+  rec.tinfo.compressedSize   = 0;
+  rec.ktype = eventFile::LSE_Keys::LCI;
+  rec.cikeys.LATC_master = 11;
+  rec.cikeys.LATC_ignore = 12;
+  rec.cikeys.LCI_script  = 13;
+  source.add( rec );
+  rec.ctx.scalers.sequence = 43;
+  rec.ctx.ccsds.utc = 1001.5;
+  source.add( rec );
+
+  lsfData::LSFReader reader( &source );
+  check( reader.evtcnt() == 2 && reader.runid() == 77000123, "memory source header" );
+  check( reader.begGEM() == 42 && reader.endGEM() == 43, "memory source GEM range" );
+  check( reader.begSec() == 1000 && reader.endSec() == 1001, "memory source time range" );
+  check( reader.source() == &source && reader.lseReader() == 0, "memory source has no LSEReader" );
+  bool thrown = false;
+  try {
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+    eventFile::LSEReader& lse = reader;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+    (void)lse;
+  } catch ( const std::runtime_error& ) {
+    thrown = true;
+  }
+  check( thrown, "memory source as LSEReader throws" );
+
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent meta;
+  eventFile::EBF_Data ebf;
+  unsigned int n = 0;
+  while ( reader.read( ccsds, meta, ebf ) ) {
+    n++;
+    check( ccsds.getApid() == 956, "memory source ccsds" );
+    check( meta.run().startTime() == 77000100 && meta.run().dataTransferId() == 77000123,
+           "memory source run" );
+    check( meta.scalers().sequence() == 41 + n, "memory source scalers" );
+    check( meta.time().timeTicks() == 1234, "memory source time" );
+    check( meta.configuration() != 0 && meta.configuration()->castToLciTkrConfig() != 0 &&
+           meta.configuration()->castToLciTkrConfig()->injected() == 3,
+           "memory source configuration" );
+    check( meta.keys() != 0 && meta.keys()->type() == enums::Lsf::LciKeys, "memory source keys" );
+  }
+  check( n == 2, "memory source event count" );
+
+  source.rewind();
+  check( reader.read( ccsds, meta, ebf ) && meta.scalers().sequence() == 42,
+         "memory source rewind" );
+}
+
+namespace {
+  struct CountingObserver : public lsfData::ContextObserver {
+    CountingObserver() : runs(0), datagrams(0), modes(0), lastDatagram(0) {}
+    virtual void onNewRun( const lsfData::RunInfo& ) { runs++; }
+    virtual void onNewDatagram( const lsfData::DatagramInfo& d ) { datagrams++; lastDatagram = d.datagrams(); }
+    virtual void onModeChange( const lsfData::DatagramInfo& ) { modes++; }
+    unsigned int runs, datagrams, modes, lastDatagram;
+  };
+}
+
+static void testContextObserver()
+{
+  lsfData::MemoryEventSource source( 77000125 );
+  lsfData::MemoryEventSource::Record rec;
+  memset( &rec.ctx, 0, sizeof(rec.ctx) );
+  rec.infotype = eventFile::LSE_Info::NoInfo;
+  rec.ktype = eventFile::LSE_Keys::NoKeys;
+  rec.ctx.run.groundId = 100;
+  rec.ctx.run.startedAt = 77000000;
+  rec.ctx.open.datagrams = 1;
+  source.add( rec );
+  source.add( rec );
+  rec.ctx.open.datagrams = 2;             // new datagram
+  source.add( rec );
+  rec.ctx.open.modeChanges = 1;           // mode change within the datagram
+  source.add( rec );
+  rec.ctx.run.groundId = 101;             // new run
+  rec.ctx.open.datagrams = 0;
+  rec.ctx.open.modeChanges = 0;
+  source.add( rec );
+
+  lsfData::LSFReader reader( &source );
+  CountingObserver obs;
+  reader.setObserver( &obs );
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent meta;
+  eventFile::EBF_Data ebf;
+
+  const unsigned int datagrams[5] = { 1, 1, 2, 2, 0 };
+  unsigned int n = 0;
+  while ( n < 5 && reader.read( ccsds, meta, ebf ) ) {
+    check( meta.datagram().datagrams() == datagrams[n], "context datagram" );
+    n++;
+    check( meta.run().id() == ( n < 5 ? 100u : 101u ) && meta.run().dataTransferId() == 77000125,
+           "context run" );
+    if ( n == 1 ) meta.clear();   // a cleared MetaEvent must be refilled
+  }
+  check( n == 5 && !reader.read( ccsds, meta, ebf ), "context event count" );
+  check( obs.runs == 2 && obs.datagrams == 3 && obs.modes == 1 && obs.lastDatagram == 0,
+         "context observer calls" );
+}
+
+static bool evenSequence( const lsfData::EventRecord& rec ) { return rec.ctx.scalers.sequence % 2 == 0; }
+static bool notSix( const lsfData::LsfCcsds&, const lsfData::MetaEvent& meta ) { return meta.scalers().sequence() != 6; }
+
+static void testEventRange()
+{
+  lsfData::MemoryEventSource source( 77000126 );
+  lsfData::MemoryEventSource::Record rec;
+  memset( &rec.ctx, 0, sizeof(rec.ctx) );
+  rec.infotype = eventFile::LSE_Info::NoInfo;
+  rec.ktype = eventFile::LSE_Keys::NoKeys;
+  for ( unsigned int i=0; i<20; i++ ) {
+    rec.ctx.scalers.sequence = i;
+    source.add( rec );
+  }
+
+  lsfData::LSFReader reader( &source );
+  {
+    lsfData::EventRange events( reader );
+    events.filter( evenSequence ).filter( notSix ).take( 4 );
+    unsigned long long want[4] = { 0, 2, 4, 8 };
+    unsigned int n = 0;
+    for ( lsfData::EventRange::iterator it = events.begin(); it != events.end(); ++it, n++ ) {
+      check( n < 4 && it->meta().scalers().sequence() == want[n], "range filter order" );
+    }
+    check( n == 4 && events.taken() == 4, "range take" );
+    check( events.skippedRaw() == 4 && events.skipped() == 5, "range skipped" );
+    // take() stops reading at the fourth accepted event
+    check( source.position() == 9, "range short-circuit" );
+  }
+
+  source.rewind();
+  {
+    lsfData::EventRange events( reader );
+    lsfData::EventRange::ChunkRange chunks = events.chunk( 8 );
+    unsigned int nchunk = 0, nevt = 0;
+    for ( lsfData::EventRange::ChunkRange::iterator it = chunks.begin(); it != chunks.end(); ++it ) {
+      for ( size_t i=0; i<it->size(); i++ ) {
+        check( (*it)[i].meta().scalers().sequence() == nevt, "range chunk order" );
+        nevt++;
+      }
+      nchunk++;
+    }
+    check( nchunk == 3 && nevt == 20, "range chunks" );
+  }
+}
+
+static void testTimeToneCache()
+{
+  lsfData::MemoryEventSource source( 77000124 );
+  lsfData::MemoryEventSource::Record rec;
+  memset( &rec.ctx, 0, sizeof(rec.ctx) );
+  rec.infotype = eventFile::LSE_Info::LPA;
+  rec.pinfo.timeHack.hacks = 0;
+  rec.pinfo.timeHack.tics  = 0;
+  rec.pinfo.hardwareKey = 0;
+  rec.pinfo.softwareKey = 0;
+  rec.pinfo.compressionLevel = 0;
+  rec.pinfo.compressedSize   = 0;
+  rec.ktype = eventFile::LSE_Keys::NoKeys;
+  rec.ctx.current.timeSecs = 500;
+  rec.ctx.current.timeHack.hacks = 7;
+  rec.ctx.current.sourceGps = 1;
+  rec.ctx.previous.timeSecs = 499;
+  rec.pinfo.timeTics = 10;
+  source.add( rec );
+  rec.pinfo.timeTics = 20;
+  source.add( rec );
+  rec.ctx.current.timeSecs = 501;
+  rec.ctx.previous.timeSecs = 500;
+  rec.pinfo.timeTics = 30;
+  source.add( rec );
+  rec.ctx.current.missingLatPps = 1;
+  rec.pinfo.timeTics = 40;
+  source.add( rec );
+
+  lsfData::LSFReader reader( &source );
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent meta;
+  eventFile::EBF_Data ebf;
+
+  check( reader.read( ccsds, meta, ebf ) && meta.time().timeTicks() == 10, "timetone first event" );
+  check( meta.time().current().timeSecs() == 500 && meta.time().current().timeHack().hacks() == 7 &&
+         meta.time().current().sourceGps() && meta.time().previous().timeSecs() == 499,
+         "timetone converted" );
+
+  // a cleared MetaEvent must get the cached tones back
+  meta.clear();
+  check( reader.read( ccsds, meta, ebf ) && meta.time().timeTicks() == 20 &&
+         meta.time().current().timeSecs() == 500 && meta.time().current().sourceGps(),
+         "timetone cached" );
+
+  check( reader.read( ccsds, meta, ebf ) && meta.time().timeTicks() == 30 &&
+         meta.time().current().timeSecs() == 501 && meta.time().previous().timeSecs() == 500,
+         "timetone changed" );
+
+  // the same second with other flags is another timetone
+  check( reader.read( ccsds, meta, ebf ) && meta.time().timeTicks() == 40 &&
+         meta.time().current().timeSecs() == 501 && meta.time().current().missingLatPps(),
+         "timetone flags changed" );
+}
+
+#ifndef _WIN32
+// what obj.print() writes to stdout, through printf or std::cout
+template < class T > static std::string printed( const T& obj )
+{
+  fflush( stdout );
+  FILE* tmp = tmpfile();
+  const int saved = dup( 1 );
+  dup2( fileno( tmp ), 1 );
+  obj.print();
+  std::cout.flush();
+  fflush( stdout );
+  dup2( saved, 1 );
+  close( saved );
+  std::cout << std::dec << std::setfill(' ');   // LsfKeys::print leaves hex behind
+
+  std::string text;
+  rewind( tmp );
+  char buf[4096];
+  size_t n;
+  while ( ( n = fread( buf, 1, sizeof(buf), tmp ) ) > 0 ) text.append( buf, n );
+  fclose( tmp );
+  return text;
+}
+
+template < class T > static std::string formatted( const T& obj )
+{
+  lsfData::TextBuffer b( 0 );
+  lsfData::Formatter::format( b, obj );
+  return b.str();
+}
+
+template < class T > static void checkFormat( const T& obj, const char* what )
+{
+  const std::string want = printed( obj );
+  const std::string got  = formatted( obj );
+  if ( want != got ) {
+    printf( "print():\n%sformat():\n%s", want.c_str(), got.c_str() );
+  }
+  check( !want.empty() && want == got, what );
+}
+#endif
+
+static void testFormatter()
+{
+  lsfData::TextBuffer b( 0, 8 );
+  b.dec( -2147483647 - 1 ).append( ' ' ).dec( 4294967295u ).append( ' ' )
+   .dec( 18446744073709551615ULL ).append( ' ' ).hex( 0xBEEF, 8, true ).append( ' ' )
+   .hex( 0 ).append( ' ' ).fixed( 1.5, 6, 2 );
+  check( b.str() == "-2147483648 4294967295 18446744073709551615 0000BEEF 0   1.50",
+         "text buffer formatting" );
+
+#ifndef _WIN32
+  lsfData::LsfCcsds ccsds;
+  ccsds.initialize( 0x4D, 956, 239557417.123456 );
+  checkFormat( ccsds, "format LsfCcsds" );
+  checkFormat( lsfData::RunInfo( enums::Lsf::Platform(1), enums::Lsf::DataOrigin(2),
+                                 0x1234, 239557000, 77000123 ), "format RunInfo" );
+  lsfData::DatagramInfo dgm;
+  dgm.setDatagrams( 4000000000u );
+  checkFormat( dgm, "format DatagramInfo" );
+  checkFormat( lsfData::GemScalers( 1ULL << 40, 12345, 6, 7, 8, 9 ), "format GemScalers" );
+  lsfData::Time time( lsfData::TimeTone( 0, 100, 0, 0, lsfData::GemTime( 5, 0xABCDE ) ),
+                      lsfData::TimeTone( 0, 99, 0, 0, lsfData::GemTime( 4, 0x1234 ) ),
+                      lsfData::GemTime( 5, 0xBCDEF ), 0x1FFFFFF );
+  checkFormat( time, "format Time" );
+
+  const lsfData::LpaConfiguration lpa( 0xDEAD, 0xBEEF );
+  const lsfData::LciAcdConfiguration acd( 1, 2, 3, 4, 5, 6,
+                                          lsfData::LciAcdConfiguration::AcdTrigger( 7, 8, 9 ),
+                                          lsfData::Channel( 10, true, false ) );
+  const lsfData::LciCalConfiguration cal( 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                          lsfData::LciCalConfiguration::CalTrigger( 13, 1, 14, 0 ),
+                                          lsfData::Channel( 15, false, true ) );
+  const lsfData::LciTkrConfiguration tkr( 1, 2, 3, 4, 5, lsfData::Channel( 6, true, true ) );
+  const lsfData::Configuration* cfgs[4] = { &lpa, &acd, &cal, &tkr };
+  for ( int i=0; i<4; i++ ) {
+    checkFormat( *cfgs[i], "format Configuration" );
+  }
+
+  const lsfData::LpaKeys lpaKeys( 0x100, 0x200, 300, 400 );
+  const lsfData::LciKeys lciKeys( 0x100, 0x200, 0x300 );
+  checkFormat( static_cast< const lsfData::LsfKeys& >( lpaKeys ), "format LpaKeys" );
+  checkFormat( static_cast< const lsfData::LsfKeys& >( lciKeys ), "format LciKeys" );
+#endif
+}
+
+static void testEventExporter()
+{
+  lsfData::LsfCcsds ccsds;
+  ccsds.initialize( 0x4D, 956, 1000.25 );
+  lsfData::MetaEvent meta;
+  meta.setScalers( lsfData::GemScalers( 0, 0, 0, 0, 42, 0 ) );
+  meta.setMootAlias( "nominal, \"v2\"" );
+  meta.setConfiguration( lsfData::LpaConfiguration( 0x10, 0x20 ) );
+  meta.setKeys( lsfData::LpaKeys( 1, 2, 3, 4 ) );
+  lsfData::PassthruHandler pass;
+  pass.set( 0, 0, 0, enums::Lsf::PASSED, enums::Lsf::UNSUPPORTED, 0, enums::Lsf::PASS_THRU, true );
+  meta.addPassthruHandler( pass );
+
+  lsfData::TextBuffer json( 0 );
+  lsfData::EventExporter jx( json, lsfData::EventExporter::JsonLines );
+  check( jx.select( "apid, sequence,utc,mootAlias,hardwareKey,writeCfg,SBS,passthruState,passthruStatus,gammaState" ),
+         "exporter column names" );
+  jx.header();
+  jx.write( ccsds, meta );
+  char want[512];
+  sprintf( want, "{\"apid\":956,\"sequence\":42,\"utc\":1000.250000,"
+           "\"mootAlias\":\"nominal, \\\"v2\\\"\",\"hardwareKey\":16,\"writeCfg\":null,"
+           "\"SBS\":3,\"passthruState\":%d,\"passthruStatus\":null,\"gammaState\":null}\n",
+           static_cast< int >( enums::Lsf::PASSED ) );
+  check( json.str() == want, "exporter json" );
+
+  lsfData::TextBuffer csv( 0 );
+  lsfData::EventExporter cx( csv, lsfData::EventExporter::Csv );
+  check( cx.select( "apid,mootAlias,writeCfg,SBS" ), "exporter csv columns" );
+  cx.header();
+  cx.write( ccsds, meta );
+  cx.write( ccsds, meta );
+  check( csv.str() == "apid,mootAlias,writeCfg,SBS\n"
+                      "956,\"nominal, \"\"v2\"\"\",,3\n"
+                      "956,\"nominal, \"\"v2\"\"\",,3\n", "exporter csv" );
+  check( cx.events() == 2, "exporter event count" );
+  check( !cx.select( "apid,nonsense" ) && cx.columns().size() == 4, "exporter unknown column" );
+
+  bool named = true;
+  for ( int i=0; i<lsfData::EventExporter::ColumnCnt; i++ ) {
+    lsfData::EventExporter::Column c;
+    const lsfData::EventExporter::Column want = static_cast< lsfData::EventExporter::Column >( i );
+    named = named && lsfData::EventExporter::column( lsfData::EventExporter::columnName( want ), c ) && c == want;
+  }
+  check( named, "exporter names every column once" );
+
+  // the whole CAL configuration, the previous timetone, and a time that is not a number
+  lsfData::MetaEvent cal;
+  cal.setConfiguration( lsfData::LciCalConfiguration( 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                                      lsfData::LciCalConfiguration::CalTrigger( 13, 1, 14, 0 ),
+                                                      lsfData::Channel( 15, false, true ) ) );
+  cal.setTime( lsfData::Time( lsfData::TimeTone( 0, 100, 0, 0, lsfData::GemTime( 5, 0 ) ),
+                              lsfData::TimeTone( 3, 99, 7, 0, lsfData::GemTime( 4, 0 ) ),
+                              lsfData::GemTime( 5, 0 ), 0 ) );
+  lsfData::LsfCcsds nan;
+  nan.initialize( 0x4D, 956, std::sqrt( -1. ) );
+  lsfData::TextBuffer full( 0 );
+  lsfData::EventExporter fx( full, lsfData::EventExporter::JsonLines );
+  check( fx.select( "utc,previousIncomplete,previousFlywheeling,uld,firstRange,calibGain,highCalEna,"
+                    "highRngEna,highGain,lowCalEna,lowRngEna,lowGain,le,lowTrgEna,he,highTrgEna,"
+                    "channelSingle,channelAll,channelLatc,biasDac,splitLow" ), "exporter configuration columns" );
+  fx.write( nan, cal );
+  check( full.str() == "{\"utc\":null,\"previousIncomplete\":3,\"previousFlywheeling\":7,\"uld\":1,"
+                       "\"firstRange\":4,\"calibGain\":6,\"highCalEna\":7,\"highRngEna\":8,\"highGain\":9,"
+                       "\"lowCalEna\":10,\"lowRngEna\":11,\"lowGain\":12,\"le\":13,\"lowTrgEna\":1,"
+                       "\"he\":14,\"highTrgEna\":0,\"channelSingle\":15,\"channelAll\":0,\"channelLatc\":1,"
+                       "\"biasDac\":null,\"splitLow\":null}\n", "exporter configuration json" );
+}
+
+static void testEbfIndex()
+{
+  lsfData::EbfIndex index;
+  check( !index.built() && index.size() == 0 && index.gem() == 0, "ebf index empty" );
+  index.add( lsfData::EbfIndex::GLT, 17, 16, 16 );
+  index.add( lsfData::EbfIndex::GEM, 17, 32, 64 );
+  index.add( lsfData::EbfIndex::TEM, 3, 96, 128 );
+  index.add( lsfData::EbfIndex::TEM, 0, 224, 32 );
+  index.add( lsfData::EbfIndex::ACD, 16, 256, 48 );
+  index.setBuilt();
+  check( index.built() && index.size() == 5, "ebf index size" );
+  check( index.gem() && index.gem()->offset == 32 && index.gem()->length == 64, "ebf index gem" );
+  check( index.acd() && index.acd()->source == 16, "ebf index acd" );
+  check( index.tem( 3 ) && index.tem( 3 )->offset == 96, "ebf index tower 3" );
+  check( index.tem( 0 ) && index.tem( 0 )->offset == 224, "ebf index tower 0" );
+  check( index.tem( 1 ) == 0 && index.tem( 99 ) == 0 && index.osw() == 0, "ebf index missing" );
+  check( index.towers() == 0x9, "ebf index tower mask" );
+
+  for ( int i=0; i<lsfData::EbfIndex::MAX_ENTRIES; i++ ) index.add( lsfData::EbfIndex::UDF, 0, 0, 0 );
+  check( index.size() == lsfData::EbfIndex::MAX_ENTRIES, "ebf index full" );
+
+  char data[300];
+  for ( unsigned i=0; i<sizeof(data); i++ ) data[i] = static_cast< char >( i );
+  lsfData::Ebf ebf( data, sizeof(data) );
+  ebf.index().add( lsfData::EbfIndex::GEM, 17, 32, 64 );
+  ebf.index().setBuilt();
+  const char* gem = ebf.contribution( ebf.index().gem() );
+  check( gem && gem[0] == 32, "ebf contribution" );
+  check( ebf.contribution( ebf.index().acd() ) == 0, "ebf missing contribution" );
+  ebf.set( data, 100 );
+  check( !ebf.index().built() && ebf.index().gem() == 0, "ebf set drops index" );
+}
+
+static void testPackedMetaEvent()
+{
+  check( sizeof(lsfData::PackedMetaEvent) == 128, "packed event size" );
+
+  lsfData::MetaEvent meta;
+  meta.setRun( lsfData::RunInfo( enums::Lsf::Lat, enums::Lsf::Orbit, 77, 1234 ) );
+  meta.setScalers( lsfData::GemScalers( 1, 2, 3, 4, 5, 6 ) );
+  meta.setTime( lsfData::Time( lsfData::TimeTone( 0, 100, 2, 3, lsfData::GemTime( 7, 8 ) ),
+                               lsfData::TimeTone( 1, 99, 1, 4, lsfData::GemTime( 9, 10 ) ),
+                               lsfData::GemTime( 11, 12 ), 13 ) );
+  meta.setMootKey( 42 );
+  meta.setMootAlias( "nominal" );
+  meta.setConfiguration( lsfData::LpaConfiguration( 0x10, 0x20 ) );
+  meta.setKeys( lsfData::LpaKeys( 1, 2, 3, 4 ) );
+  lsfData::PassthruHandler pass;
+  pass.set( 0, 0, 0, enums::Lsf::PASSED, enums::Lsf::UNSUPPORTED, 0, enums::Lsf::PASS_THRU, true );
+  pass.setStatus( 5 );
+  meta.addPassthruHandler( pass );
+
+  lsfData::PackedEventArray events;
+  for ( unsigned i=0; i<3000; i++ ) {
+    meta.setScalers( lsfData::GemScalers( 1, 2, 3, 4, i, 6 ) );
+    events.push_back( meta );
+  }
+  check( events.size() == 3000, "packed array size" );
+  check( reinterpret_cast< size_t >( events.begin() ) % lsfData::PackedEventArray::ALIGNMENT == 0,
+         "packed array alignment" );
+  check( events[2999].sequence == 2999 && events[0].currentSecs == 100 && events[0].previousFlags == 4,
+         "packed hot fields" );
+  check( events[7].has( lsfData::PackedMetaEvent::Passthru ) && !events[7].has( lsfData::PackedMetaEvent::Gamma ),
+         "packed handler mask" );
+  check( events[7].state[lsfData::PackedMetaEvent::Passthru] == enums::Lsf::PASSED, "packed handler state" );
+  check( events[7].runType == enums::Lsf::LPA && events[7].keysType == enums::Lsf::LpaKeys, "packed types" );
+  check( events.context( 7 ).mootAlias == "nominal" && events.context( 7 ).mootKey == 42
+         && events.cold( 7 ).handlers == ( 1u << lsfData::PackedMetaEvent::Passthru ),
+         "packed cold fields" );
+  check( events.contexts() == 1, "packed context shared" );
+
+  // unpacking gives back the same event, column for column
+  lsfData::LsfCcsds ccsds;
+  lsfData::MetaEvent back;
+  events.unpack( 2999, back );
+  lsfData::TextBuffer a( 0 ), b( 0 );
+  lsfData::EventExporter ea( a ), eb( b );
+  ea.write( ccsds, meta );
+  eb.write( ccsds, back );
+  check( a.str() == b.str(), "packed round trip" );
+
+  // a new configuration starts a new context; the gamma RSD comes back whole
+  meta.setConfiguration( lsfData::LpaConfiguration( 0x10, 0x21 ) );
+  lsfData::GammaHandler gamma;
+  gamma.set( 1, 2, 3, enums::Lsf::LEAKED, enums::Lsf::OUTPUT, 3, enums::Lsf::GAMMA, true, 50 );
+  gamma.setStatus( 0x1234, 2, 1, -7 );
+  meta.addGammaHandler( gamma );
+  events.push_back( meta );
+  check( events.contexts() == 2 && events.context( 3000 ).configuration
+         && events.context( 3000 ).configuration->castToLpaConfig()->softwareKey() == 0x21,
+         "packed new context" );
+  events.unpack( 3000, back );
+  check( back.gammaFilter() && back.gammaFilter()->rsd()
+         && back.gammaFilter()->rsd()->energyInLeus() == -7 && back.gammaFilter()->prescaleFactor() == 50
+         && back.passthruFilter() && back.passthruFilter()->rsd()->status() == 5,
+         "packed handler summaries" );
+
+  events.clear();
+  check( events.empty(), "packed clear" );
+}
+
+static void testReadAhead()
+{
+#ifndef _WIN32
+  setenv( "LSFDATA_TEST_DIR", "/tmp", 1 );
+  check( lsfData::ReadAhead::expand( "$(LSFDATA_TEST_DIR)/x.lsf" ) == "/tmp/x.lsf", "read-ahead expand" );
+  check( lsfData::ReadAhead::expand( "plain/$(x" ) == "plain/$(x", "read-ahead expand unterminated" );
+
+  char name[] = "/tmp/lsfDataReadAheadXXXXXX";
+  const int fd = mkstemp( name );
+  if ( fd < 0 ) return;
+  std::string block( 1 << 20, 'x' );
+  const bool written = write( fd, block.data(), block.size() ) == static_cast< ssize_t >( block.size() );
+  close( fd );
+
+  {
+    lsfData::ReadAhead ra( name, 64 << 10, 4 );
+    if ( written && ra.active() ) {
+      check( ra.size() == block.size() && ra.requested() == 4, "read-ahead initial depth" );
+      ra.advance( 100 << 10 );
+      check( ra.requested() == 6, "read-ahead window" );
+      ra.advance( 100 << 10 );
+      check( ra.requested() == 6, "read-ahead no repeat" );
+      ra.advance( ra.size() );
+      check( ra.requested() == 16, "read-ahead stops at end of file" );
+    }
+  }
+  {
+    lsfData::ReadAhead ra( name, 64 << 10, 2, true );
+    if ( written && ra.active() ) {
+      ra.advance( 60 << 10 );
+      check( ra.dropped() == 0, "drop-behind keeps the window being read" );
+      ra.advance( 300 << 10 );
+      check( ra.dropped() == ( 256 << 10 ) && ra.requested() == 7, "drop-behind" );
+      ra.advance( 200 << 10 );
+      check( ra.dropped() == ( 256 << 10 ), "drop-behind never goes back" );
+    }
+  }
+  unlink( name );
+
+  lsfData::ReadAhead missing( "/nonexistent/lsfData/file.lsf" );
+  check( !missing.active() && missing.requested() == 0, "read-ahead fallback" );
+
+  // StreamingIo through a FileEventSource, on a file written by LSEWriter
+  char lsf[] = "/tmp/lsfDataStreamingXXXXXX";
+  const int lfd = mkstemp( lsf );
+  if ( lfd < 0 ) return;
+  close( lfd );
+  const unsigned int nevents = 64;
+  {
+    eventFile::LSEWriter writer( lsf, 77000126 );
+    lsfData::MemoryEventSource::Record rec;
+    memset( &rec.ctx, 0, sizeof(rec.ctx) );
+    rec.pinfo.timeHack.hacks = 0;
+    rec.pinfo.timeHack.tics  = 0;
+    rec.pinfo.timeTics = 0;
+    rec.pinfo.hardwareKey = 0;
+    rec.pinfo.softwareKey = 0;
+    rec.pinfo.compressionLevel = 0;
+    rec.pinfo.compressedSize   = 0;
+    rec.pakeys.LATC_master = 0;
+    rec.pakeys.LATC_ignore = 0;
+    rec.pakeys.SBS = 0;
+    rec.pakeys.LPA_db = 0;
+    std::vector< unsigned char > payload( 16 << 10, 0x5a );
+    for ( unsigned int i=0; i<nevents; i++ ) {
+      rec.ctx.scalers.sequence = i;
+      writer.write( rec.ctx, eventFile::EBF_Data( &payload[0], payload.size() ), &rec.pinfo, &rec.pakeys );
+    }
+  }
+  struct stat st;
+  const bool lsfWritten = stat( lsf, &st ) == 0 && st.st_size > 0;
+  {
+    lsfData::FileEventSource source( lsf, lsfData::FileEventSource::StreamingIo );
+    lsfData::EventRecord rec;
+    unsigned int n = 0;
+    while ( source.readRecord( rec ) ) n++;
+    // without eventFile's writer (a stub build) there is nothing to read
+    check( !lsfWritten || n == nevents, "streaming read count" );
+    const lsfData::ReadAhead* ra = source.readAhead();
+    check( source.io() == lsfData::FileEventSource::StreamingIo
+           ? ra && ra->requested() > 0 && ra->dropped() <= ra->size()
+           : ra == 0, "streaming read-ahead" );
+  }
+  unlink( lsf );
+#endif
+}
+
+namespace {
+  // each byte stands for `level` copies of itself; a leading '!' is corrupt
+  struct RepeatCodec : public lsfData::PayloadCodec {
+    virtual bool decompress( const char* data, unsigned int length, int level,
+                             std::vector< char >& out ) const {
+      if ( length > 0 && data[0] == '!' ) return false;
+      for ( unsigned int i=0; i<length; i++ ) out.insert( out.end(), level, data[i] );
+      return true;
+    }
+  };
+}
+
+static void testDecompressor()
+{
+  RepeatCodec codec;
+  const unsigned int threads[] = { 0, 1, 3 };
+  for ( unsigned int t=0; t<sizeof(threads)/sizeof(threads[0]); t++ ) {
+    lsfData::Decompressor pool( codec, threads[t], 4 );
+    std::vector< char > out;
+    unsigned int popped = 0;
+    bool ordered = true, statuses = true;
+    for ( unsigned int i=0; i<=50; i++ ) {
+      if ( i < 50 ) {
+        const char payload[2] = { static_cast< char >( ( i % 7 == 3 ) ? '!' : 'a' + i % 26 ), 'z' };
+        pool.push( payload, 2, i % 5 );     // level 0: not compressed
+      }
+      while ( pool.full() || ( i == 50 && pool.pending() > 0 ) ) {
+        const lsfData::Decompressor::Status st = pool.pop( out );
+        const unsigned int n = popped++;
+        const int level = n % 5;
+        if ( n % 7 == 3 && level > 0 ) {
+          statuses = statuses && st == lsfData::Decompressor::Failed && out.empty();
+        } else if ( level == 0 ) {
+          statuses = statuses && st == lsfData::Decompressor::PassedThrough && out.size() == 2;
+        } else {
+          statuses = statuses && st == lsfData::Decompressor::Decompressed;
+          ordered = ordered && out.size() == static_cast< size_t >( 2 * level ) &&
+            out[0] == static_cast< char >( 'a' + n % 26 ) && out[level] == 'z';
+        }
+      }
+    }
+    check( popped == 50 && pool.pending() == 0, "decompressor count" );
+    check( ordered, "decompressor order" );
+    check( statuses, "decompressor status" );
+    check( pool.pop( out ) == lsfData::Decompressor::Empty, "decompressor empty" );
+  }
+}
+
+#ifndef _WIN32
+static void* readSnapshot( void* arg )
+{
+  // each thread holds its own handle, made from the one it was given
+  lsfData::MetaEventSnapshot mine( *static_cast< const lsfData::MetaEventSnapshot* >( arg ) );
+  unsigned long long sum = 0;
+  for ( unsigned int i=0; i<10000; i++ ) {
+    lsfData::MetaEventSnapshot copy( mine );
+    sum += copy->scalers().sequence();
+  }
+  return sum == 10000ULL * 42 ? arg : 0;
+}
+#endif
+
+static void testMetaEventSnapshot()
+{
+  lsfData::MetaEvent meta;
+  meta.setScalers( lsfData::GemScalers( 1, 2, 3, 4, 42, 5 ) );
+  meta.setMootAlias( "nominal" );
+  lsfData::LciTkrConfiguration cfg;
+  meta.setConfiguration( cfg );
+  const lsfData::Configuration* config = meta.configuration();
+
+  lsfData::MetaEventSnapshot snap = lsfData::MetaEventSnapshot::adopt( meta );
+  check( snap.valid() && snap.useCount() == 1, "snapshot adopt" );
+  check( snap->configuration() == config && snap->mootAlias() == "nominal" &&
+         snap->scalers().sequence() == 42, "snapshot adopt without cloning" );
+  check( meta.configuration() == 0 && meta.mootAlias().empty(), "snapshot leaves the source empty" );
+
+  {
+    lsfData::MetaEventSnapshot a( snap ), b;
+    b = a;
+    check( snap.useCount() == 3 && b.get() == snap.get(), "snapshot sharing" );
+    b.reset();
+    check( snap.useCount() == 2 && !b.valid(), "snapshot reset" );
+  }
+  check( snap.useCount() == 1, "snapshot release" );
+
+  lsfData::MetaEventSnapshot copied( *snap );
+  check( copied.get() != snap.get() && copied->configuration() != config &&
+         copied->configuration() != 0, "snapshot deep copy" );
+
+#ifndef _WIN32
+  pthread_t tids[4];
+  for ( int i=0; i<4; i++ ) pthread_create( &tids[i], 0, readSnapshot, &snap );
+  bool ok = true;
+  for ( int i=0; i<4; i++ ) {
+    void* r = 0;
+    pthread_join( tids[i], &r );
+    ok = ok && r != 0;
+  }
+  check( ok && snap.useCount() == 1, "snapshot threads" );
+#endif
+}
+
+#ifndef _WIN32
+namespace {
+  const unsigned int QUEUE_EVENTS = 20000;
+
+  struct QueueWork {
+    lsfData::EventQueue* queue;
+    unsigned int         producer;
+    unsigned long long   taken;
+    unsigned long long   sum;
+  };
+
+  void* produceEvents( void* arg )
+  {
+    QueueWork& w = *static_cast< QueueWork* >( arg );
+    for ( unsigned int i=1; i<=QUEUE_EVENTS; i++ ) {
+      lsfData::QueuedEvent* e = w.queue->acquire();
+      if ( !e ) break;
+      e->meta.setScalers( lsfData::GemScalers( 0, 0, 0, 0, i, w.producer ) );
+      w.queue->publish( e );
+    }
+    return 0;
+  }
+
+  void* consumeEvents( void* arg )
+  {
+    QueueWork& w = *static_cast< QueueWork* >( arg );
+    while ( lsfData::QueuedEvent* e = w.queue->take() ) {
+      w.taken++;
+      w.sum += e->meta.scalers().sequence();
+      w.queue->recycle( e );
+    }
+    return 0;
+  }
+}
+#endif
+
+#ifndef _WIN32
+namespace {
+  void* takeOne( void* arg )
+  {
+    return static_cast< lsfData::EventQueue* >( arg )->take();
+  }
+}
+#endif
+
+static void testEventQueue()
+{
+  {
+    lsfData::EventQueue queue( 5 );
+    check( queue.capacity() == 8, "queue capacity" );
+    std::vector< lsfData::QueuedEvent* > held;
+    while ( lsfData::QueuedEvent* e = queue.tryAcquire() ) held.push_back( e );
+    check( held.size() == 8 && queue.tryTake() == 0, "queue backpressure" );
+    for ( size_t i=0; i<held.size(); i++ ) {
+      held[i]->meta.setScalers( lsfData::GemScalers( 0, 0, 0, 0, i, 0 ) );
+      queue.publish( held[i] );
+    }
+    bool fifo = true;
+    for ( size_t i=0; i<held.size(); i++ ) {
+      lsfData::QueuedEvent* e = queue.tryTake();
+      fifo = fifo && e == held[i] && e->meta.scalers().sequence() == i;
+      queue.recycle( e );
+    }
+    check( fifo, "queue order" );
+    queue.close();
+    check( queue.acquire() == 0 && queue.take() == 0, "queue close" );
+  }
+
+#ifndef _WIN32
+  lsfData::EventQueue queue( 64 );
+  QueueWork producers[3], consumers[4];
+  pthread_t ptid[3], ctid[4];
+  for ( int i=0; i<4; i++ ) {
+    QueueWork w = { &queue, 0, 0, 0 };
+    consumers[i] = w;
+    pthread_create( &ctid[i], 0, consumeEvents, &consumers[i] );
+  }
+  for ( unsigned int i=0; i<3; i++ ) {
+    QueueWork w = { &queue, i, 0, 0 };
+    producers[i] = w;
+    pthread_create( &ptid[i], 0, produceEvents, &producers[i] );
+  }
+  for ( int i=0; i<3; i++ ) pthread_join( ptid[i], 0 );
+  queue.close();
+  unsigned long long taken = 0, sum = 0;
+  for ( int i=0; i<4; i++ ) {
+    pthread_join( ctid[i], 0 );
+    taken += consumers[i].taken;
+    sum += consumers[i].sum;
+  }
+  const unsigned long long n = QUEUE_EVENTS;
+  check( taken == 3 * n && sum == 3 * n * ( n + 1 ) / 2, "queue threads" );
+
+  {
+    // a slot acquired before close() and published after it is still taken
+    lsfData::EventQueue late( 4 );
+    lsfData::QueuedEvent* e = late.acquire();
+    late.close();
+    pthread_t tid;
+    pthread_create( &tid, 0, takeOne, &late );
+    usleep( 20000 );
+    late.publish( e );
+    void* got = 0;
+    pthread_join( tid, &got );
+    check( got == e && late.take() == 0, "queue publish after close" );
+
+    lsfData::EventQueue cancelled( 4 );
+    e = cancelled.acquire();
+    cancelled.close();
+    cancelled.cancel( e );
+    check( cancelled.take() == 0, "queue cancel after close" );
+  }
+
+  {
+    // an idle consumer parks instead of spinning, and a publish wakes it
+    lsfData::EventQueue idle( 4 );
+    pthread_t tid;
+    pthread_create( &tid, 0, takeOne, &idle );
+    usleep( 20000 );
+    const clock_t cpu = clock();
+    usleep( 100000 );
+    const double spent = double( clock() - cpu ) / CLOCKS_PER_SEC;
+    lsfData::QueuedEvent* e = idle.acquire();
+    idle.publish( e );
+    void* got = 0;
+    pthread_join( tid, &got );
+    check( got == e && spent < 0.05, "queue idle consumer parks" );
+  }
+#endif
+}
+
+static void testNuma()
+{
+  check( lsfData::Numa::nodes() >= 1, "numa nodes" );
+
+  std::vector< char > buffer( 1 << 16, 1 );
+  lsfData::Numa::resetCounters();
+  lsfData::Numa::account( &buffer[0] );
+  lsfData::Numa::Counters c;
+  lsfData::Numa::counters( c );
+  check( c.local + c.remote + c.unknown == 1, "numa account" );
+
+  std::vector< int > cpus;
+  if ( lsfData::Numa::cpus( 0, cpus ) && lsfData::Numa::bindThread( 0 ) ) {
+    // bound to node 0, so a freshly touched buffer is local
+    std::vector< char > local( 1 << 16, 1 );
+    check( lsfData::Numa::currentNode() == 0, "numa bind" );
+    const int node = lsfData::Numa::nodeOf( &local[0] );
+    check( node == -1 || node == 0, "numa first touch" );
+  }
+  check( !lsfData::Numa::bindThread( -1 ), "numa bind invalid node" );
+  lsfData::Numa::resetCounters();
+
+  // node-placed memory, whoever touches it first
+  const size_t size = 1 << 16;
+  char* placed = static_cast< char* >( lsfData::Numa::allocate( size, 0 ) );
+  check( placed != 0, "numa allocate" );
+  memset( placed, 1, size );
+  const int node = lsfData::Numa::nodeOf( placed );
+  check( node == -1 || node == 0, "numa allocate placement" );
+  lsfData::Numa::release( placed, size, 0 );
+  if ( lsfData::Numa::bindMemory( 0 ) ) check( lsfData::Numa::bindMemory( -1 ), "numa memory policy" );
+
+  // pool and queue with their events on node 0
+  lsfData::EventPool pool( 3, 0 );
+  check( pool.node() == 0 && pool.available() == 3, "numa pool" );
+  std::vector< lsfData::QueuedEvent* > held;
+  for ( int i=0; i<5; i++ ) held.push_back( pool.acquire() );
+  check( pool.inUse() == 5 && pool.created() >= 5, "numa pool grows" );
+  for ( size_t i=0; i<held.size(); i++ ) pool.release( held[i] );
+  check( pool.inUse() == 0, "numa pool release" );
+
+  lsfData::EventQueue queue( 4, 0 );
+  lsfData::QueuedEvent* e = queue.acquire();
+  e->ccsds.initialize( 7, 0, 0. );
+  queue.publish( e );
+  lsfData::QueuedEvent* t = queue.take();
+  check( t == e && t->ccsds.getScid() == 7, "numa queue" );
+  queue.recycle( t );
+}
+
+static void testBufferArena()
+{
+  const lsfData::BufferArena::Pages pages[] = { lsfData::BufferArena::SmallPages,
+                                                lsfData::BufferArena::HugePages };
+  for ( int p=0; p<2; p++ ) {
+    lsfData::BufferArena arena( 1 << 20, pages[p] );
+    char* a = static_cast< char* >( arena.allocate( 100 ) );
+    char* b = static_cast< char* >( arena.allocate( 100, 64 ) );
+    check( a != 0 && b != 0 && b >= a + 100 && reinterpret_cast< size_t >( b ) % 64 == 0,
+           "arena alignment" );
+    memset( a, 1, 100 );
+    memset( b, 2, 100 );
+    char* big = static_cast< char* >( arena.allocate( 3 << 20 ) );
+    big[ (3 << 20) - 1 ] = 3;
+    check( arena.used() == 200 + ( 3 << 20 ) && arena.reserved() >= ( 5u << 20 ), "arena chunks" );
+    check( pages[p] == lsfData::BufferArena::HugePages || !arena.hugePages(), "arena small pages" );
+
+    const size_t reserved = arena.reserved();
+    arena.reset();
+    check( arena.used() == 0 && arena.allocate( 100 ) == a && arena.reserved() == reserved,
+           "arena reset reuses chunks" );
+  }
+
+  lsfData::PackedEventArray events( lsfData::BufferArena::HugePages );
+  lsfData::MetaEvent meta;
+  for ( unsigned int i=0; i<3000; i++ ) {
+    meta.setScalers( lsfData::GemScalers( 0, 0, 0, 0, i, 0 ) );
+    events.push_back( meta );
+  }
+  check( events.size() == 3000 && events[2999].sequence == 2999 && events[0].sequence == 0,
+         "packed array on huge pages" );
+}
+
+static void fillPooled( lsfData::QueuedEvent& e, unsigned int seq, char* payload, unsigned int length )
+{
+  e.meta.setConfiguration( lsfData::LpaConfiguration( seq, seq + 1 ) );
+  e.meta.setKeys( lsfData::LpaKeys( seq, 0, 0, 0 ) );
+  lsfData::GammaHandler gamma;
+  gamma.set( seq, 0, 0, enums::Lsf::PASSED, enums::Lsf::UNSUPPORTED, 1, enums::Lsf::GAMMA, true );
+  gamma.setStatus( seq, 0, 0, 0 );
+  e.meta.addGammaHandler( gamma );
+  e.ebf.set( payload, length );
+  e.ebf.setSequence( seq );
+}
+
+static void testEventPool()
+{
+  lsfData::EventPool pool( 2 );
+  check( pool.created() == 2 && pool.available() == 2, "pool reserve" );
+
+  char payload[256];
+  memset( payload, 7, sizeof(payload) );
+  lsfData::QueuedEvent* e = pool.acquire();
+  fillPooled( *e, 1, payload, sizeof(payload) );
+  const lsfData::Configuration* config = e->meta.configuration();
+  const lsfData::LsfKeys* keys = e->meta.keys();
+  const lsfData::GammaHandler* gamma = e->meta.gammaFilter();
+  const lsfData::GammaRsd* rsd = gamma->rsd();
+  unsigned int length = 0;
+  const char* buffer = e->ebf.get( length );
+  pool.release( e );
+  check( e->meta.configuration() == 0 && e->meta.gammaFilter() == 0 && e->ebf.capacity() == 256,
+         "pool release clears" );
+
+  // the last event released is the next one out, and refilling it with a
+  // smaller payload reuses everything it allocated before
+  lsfData::QueuedEvent* again = pool.acquire();
+  check( again == e && pool.inUse() == 1 && pool.created() == 2, "pool recycles" );
+  fillPooled( *again, 2, payload, 100 );
+  check( again->meta.configuration() == config && again->meta.keys() == keys &&
+         again->meta.gammaFilter() == gamma && again->meta.gammaFilter()->rsd() == rsd &&
+         again->ebf.get( length ) == buffer && length == 100, "pool keeps capacity" );
+  check( again->meta.configuration()->castToLpaConfig()->hardwareKey() == 2 &&
+         again->meta.keys()->LATC_master() == 2 && again->meta.gammaFilter()->masterKey() == 2 &&
+         again->meta.gammaFilter()->rsd()->status() == 2 && again->ebf.getSequence() == 2,
+         "pool refilled values" );
+
+  // a different configuration type cannot reuse the LPA one
+  again->meta.setConfiguration( lsfData::LciCalConfiguration() );
+  check( again->meta.configuration()->type() == enums::Lsf::CalLCI, "pool config type change" );
+
+  // copies are deep, and handlers added twice replace the first
+  lsfData::MetaEvent copy;
+  copy = again->meta;
+  copy.addGammaHandler( *again->meta.gammaFilter() );
+  check( copy.gammaFilter() != again->meta.gammaFilter() &&
+         copy.gammaFilter()->rsd() != again->meta.gammaFilter()->rsd() &&
+         copy.configuration() != again->meta.configuration(), "meta event deep copy" );
+  lsfData::Ebf ebf( again->ebf );
+  check( ebf.get( length ) != buffer && length == 100 && ebf.getSequence() == 2, "ebf deep copy" );
+
+  lsfData::QueuedEvent* other = pool.acquire();
+  lsfData::QueuedEvent* fresh = pool.acquire();
+  check( other != again && fresh != again && pool.created() == 3 && pool.available() == 0,
+         "pool grows" );
+  // reserve counts the free events, not the ones created
+  pool.reserve( 2 );
+  check( pool.available() == 2 && pool.created() == 5, "pool reserve free events" );
+  pool.release( other );
+  pool.release( again );
+  // fresh is never released; the pool deletes it
+}
+
+#ifndef _WIN32
+namespace {
+  // an event source with only a header
+  class HeaderSource : public lsfData::EventSource {
+  public:
+    HeaderSource( unsigned int runid, unsigned int beg, unsigned int end )
+      : m_runid(runid), m_beg(beg), m_end(end) {}
+    virtual bool read( eventFile::LSE_Context&, eventFile::EBF_Data&, eventFile::LSE_Info::InfoType&,
+                       eventFile::LPA_Info&, eventFile::LCI_ACD_Info&, eventFile::LCI_CAL_Info&,
+                       eventFile::LCI_TKR_Info&, eventFile::LSE_Keys::KeysType&,
+                       eventFile::LPA_Keys&, eventFile::LCI_Keys& ) { return false; }
+    virtual unsigned long long evtcnt() const { return m_end - m_beg; }
+    virtual unsigned int runid() const { return m_runid; }
+    virtual unsigned int begSec() const { return m_beg; }
+    virtual unsigned int endSec() const { return m_end; }
+    virtual unsigned long long begGEM() const { return 0; }
+    virtual unsigned long long endGEM() const { return 0; }
+    virtual std::pair< unsigned, unsigned > seqErr( int ) const { return std::make_pair( 0u, 0u ); }
+    virtual std::pair< unsigned, unsigned > dfiErr( int ) const { return std::make_pair( 0u, 0u ); }
+  private:
+    unsigned int m_runid, m_beg, m_end;
+  };
+
+  // the test files hold "runid begSec endSec" as text
+  struct TextOpener : public lsfData::RunCatalog::Opener {
+    virtual lsfData::EventSource* open( const std::string& filename ) const {
+      FILE* f = fopen( filename.c_str(), "r" );
+      if ( !f ) return 0;
+      unsigned int runid, beg, end;
+      const bool ok = fscanf( f, "%u %u %u", &runid, &beg, &end ) == 3;
+      fclose( f );
+      return ok ? new HeaderSource( runid, beg, end ) : 0;
+    }
+  };
+
+  void writeText( const std::string& filename, const char* text )
+  {
+    FILE* f = fopen( filename.c_str(), "w" );
+    if ( !f ) return;
+    fputs( text, f );
+    fclose( f );
+  }
+}
+#endif
+
+static void testRunCatalog()
+{
+#ifndef _WIN32
+  char dir[] = "/tmp/lsfDataCatalogXXXXXX";
+  if ( !mkdtemp( dir ) ) return;
+  const std::string d( dir );
+  writeText( d + "/a.lsf", "10 100 199" );
+  writeText( d + "/b.lsf", "10 200 299" );
+  writeText( d + "/c.lsf", "11 300 399" );
+  writeText( d + "/d.lsf", "12 150 450" );
+  writeText( d + "/bad.lsf", "not a header" );
+  writeText( d + "/notes.txt", "13 0 1000" );
+
+  TextOpener opener;
+  lsfData::RunCatalog catalog( &opener );
+  check( catalog.refresh( d, 3 ) == 4 && catalog.size() == 4 && catalog.failed() == 1,
+         "catalog refresh" );
+
+  std::vector< const lsfData::RunCatalog::Entry* > found;
+  catalog.covering( 250, 320, found );
+  check( found.size() == 3 && catalog.file( *found[0] ) == d + "/d.lsf" &&
+         catalog.file( *found[1] ) == d + "/b.lsf" && catalog.file( *found[2] ) == d + "/c.lsf",
+         "catalog covering" );
+  catalog.covering( 460, 500, found );
+  check( found.empty(), "catalog covering nothing" );
+  catalog.covering( 199, 199, found );
+  check( found.size() == 2 && found[0]->endSec == 199 && found[1]->begSec == 150, "catalog covering edge" );
+  catalog.forRun( 10, found );
+  check( found.size() == 2 && found[0]->begSec == 100 && found[1]->begSec == 200 &&
+         found[1]->evtcnt == 99, "catalog run" );
+  catalog.forRun( 99, found );
+  check( found.empty(), "catalog unknown run" );
+
+  const std::string saved = d + "/catalog.idx";
+  check( catalog.save( saved ), "catalog save" );
+  struct stat st;
+  check( stat( ( saved + ".tmp" ).c_str(), &st ) != 0, "catalog save renames" );
+  lsfData::RunCatalog loaded( &opener );
+  check( loaded.load( saved ) && loaded.size() == 4, "catalog load" );
+  loaded.forRun( 11, found );
+  check( found.size() == 1 && loaded.file( *found[0] ) == d + "/c.lsf", "catalog loaded run" );
+
+  // only new and changed files are read again, and deleted ones go
+  writeText( d + "/e.lsf", "12 500 599" );
+  writeText( d + "/b.lsf", "10 200 249 " );
+  unlink( ( d + "/a.lsf" ).c_str() );
+  check( loaded.refresh( d, 2 ) == 2 && loaded.size() == 4, "catalog incremental refresh" );
+  loaded.forRun( 10, found );
+  check( found.size() == 1 && found[0]->endSec == 249, "catalog changed file" );
+  loaded.forRun( 12, found );
+  check( found.size() == 2 && found[1]->begSec == 500, "catalog new file" );
+  check( loaded.remove( d + "/e.lsf" ) && !loaded.remove( d + "/e.lsf" ) && loaded.size() == 3,
+         "catalog remove" );
+
+  check( !loaded.load( d + "/b.lsf" ) && loaded.size() == 0, "catalog load rejects" );
+  // a failed save leaves the old catalog alone
+  check( !catalog.save( d + "/missing/catalog.idx" ) && loaded.load( saved ) && loaded.size() == 4,
+         "catalog failed save" );
+
+  const char* names[] = { "a.lsf", "b.lsf", "c.lsf", "d.lsf", "e.lsf", "bad.lsf", "notes.txt", "catalog.idx" };
+  for ( unsigned int i=0; i<sizeof(names)/sizeof(names[0]); i++ ) unlink( ( d + "/" + names[i] ).c_str() );
+  rmdir( dir );
+#endif
+}
+
+#ifndef _WIN32
+namespace {
+  // the test files hold "firstSec count [late]": count events 0.1 s apart
+  // from firstSec on, each sent 0.5 s later, but for event late, which
+  // swaps times with the one before
+  struct ArchiveOpener : public lsfData::RunCatalog::Opener {
+    virtual lsfData::EventSource* open( const std::string& filename ) const {
+      FILE* f = fopen( filename.c_str(), "r" );
+      if ( !f ) return 0;
+      unsigned int first, count, late = 0;
+      const bool ok = fscanf( f, "%u %u %u", &first, &count, &late ) >= 2;
+      fclose( f );
+      if ( !ok ) return 0;
+      const unsigned int tps = lsfData::Time::TICKS_PER_SECOND, mask = lsfData::Time::TICKS_MASK;
+      lsfData::MemoryEventSource* source = new lsfData::MemoryEventSource( 77 );
+      lsfData::MemoryEventSource::Record rec;
+      memset( &rec.ctx, 0, sizeof(rec.ctx) );
+      rec.infotype = eventFile::LSE_Info::LPA;
+      rec.ktype = eventFile::LSE_Keys::LPA;
+      for ( unsigned int n=0; n<count; n++ ) {
+        const unsigned int i = late == 0 ? n : n == late ? late - 1 : n == late - 1 ? late : n;
+        const unsigned int secs = first + i / 10;
+        const unsigned long long ticks = static_cast< unsigned long long >( first ) * tps + i * ( tps / 10ULL );
+        rec.ctx.current.timeSecs = secs;
+        rec.ctx.current.timeHack.tics = static_cast< unsigned int >( static_cast< unsigned long long >( secs ) * tps ) & mask;
+        rec.ctx.previous.timeSecs = secs - 1;
+        rec.ctx.previous.timeHack.tics = ( rec.ctx.current.timeHack.tics - tps ) & mask;
+        rec.pinfo.timeTics = static_cast< unsigned int >( ticks ) & mask;
+        rec.ctx.ccsds.utc = first + i * 0.1 + 0.5;
+        rec.ctx.scalers.sequence = n;
+        source->add( rec );
+      }
+      return source;
+    }
+  };
+
+  // the same events behind a source that can only read, as a file is
+  class SequentialSource : public lsfData::EventSource {
+  public:
+    explicit SequentialSource( lsfData::EventSource* source ) : m_source(source) {}
+    virtual ~SequentialSource() { delete m_source; }
+    virtual bool read( eventFile::LSE_Context& ctx, eventFile::EBF_Data& ebf,
+                       eventFile::LSE_Info::InfoType& infotype, eventFile::LPA_Info& pinfo,
+                       eventFile::LCI_ACD_Info& ainfo, eventFile::LCI_CAL_Info& cinfo,
+                       eventFile::LCI_TKR_Info& tinfo, eventFile::LSE_Keys::KeysType& ktype,
+                       eventFile::LPA_Keys& pakeys, eventFile::LCI_Keys& cikeys ) {
+      return m_source->read( ctx, ebf, infotype, pinfo, ainfo, cinfo, tinfo, ktype, pakeys, cikeys );
+    }
+    virtual unsigned long long evtcnt() const { return m_source->evtcnt(); }
+    virtual unsigned int runid() const { return m_source->runid(); }
+    virtual unsigned int begSec() const { return m_source->begSec(); }
+    virtual unsigned int endSec() const { return m_source->endSec(); }
+    virtual unsigned long long begGEM() const { return m_source->begGEM(); }
+    virtual unsigned long long endGEM() const { return m_source->endGEM(); }
+    virtual std::pair< unsigned, unsigned > seqErr( int i ) const { return m_source->seqErr( i ); }
+    virtual std::pair< unsigned, unsigned > dfiErr( int i ) const { return m_source->dfiErr( i ); }
+  private:
+    lsfData::EventSource* m_source;
+  };
+
+  struct SequentialOpener : public lsfData::RunCatalog::Opener {
+    virtual lsfData::EventSource* open( const std::string& filename ) const {
+      lsfData::EventSource* source = m_archive.open( filename );
+      return source ? new SequentialSource( source ) : 0;
+    }
+    ArchiveOpener m_archive;
+  };
+
+  // one that can tell() and seek() forward, as a file with LSFDATA_LSE_SEEK
+  class MarkedSource : public SequentialSource {
+  public:
+    explicit MarkedSource( lsfData::MemoryEventSource* source )
+      : SequentialSource(source), m_memory(source) {}
+    virtual long long tell() const { return static_cast< long long >( m_memory->position() ); }
+    virtual bool seek( long long position ) {
+      const unsigned long long at = m_memory->position();
+      if ( position < 0 || static_cast< unsigned long long >( position ) < at ) return false;
+      m_memory->skip( position - at );
+      return true;
+    }
+  private:
+    lsfData::MemoryEventSource* m_memory;
+  };
+
+  struct MarkedOpener : public lsfData::RunCatalog::Opener {
+    virtual lsfData::EventSource* open( const std::string& filename ) const {
+      lsfData::EventSource* source = m_archive.open( filename );
+      return source ? new MarkedSource( static_cast< lsfData::MemoryEventSource* >( source ) ) : 0;
+    }
+    ArchiveOpener m_archive;
+  };
+}
+#endif
+
+static void testTimeWindowQuery()
+{
+  lsfData::Time t( lsfData::TimeTone( 0, 100, 0, 0, lsfData::GemTime( 5, 1000 ) ),
+                   lsfData::TimeTone( 0, 99, 0, 0, lsfData::GemTime( 4, 1000 - 20000000 + ( 1 << 25 ) ) ),
+                   lsfData::GemTime( 5, 1000 ), 1000 + 5000000 );
+  check( std::fabs( t.met() - 100.25 ) < 1e-9, "event met" );
+
+#ifndef _WIN32
+  char dir[] = "/tmp/lsfDataQueryXXXXXX";
+  if ( !mkdtemp( dir ) ) return;
+  const std::string d( dir );
+  writeText( d + "/f1.lsf", "1000 1000" );
+  writeText( d + "/f2.lsf", "1100 1000" );
+  writeText( d + "/f3.lsf", "5000 1000" );
+  writeText( d + "/f4.lsf", "7000 100 51" );
+
+  ArchiveOpener opener;
+  lsfData::RunCatalog catalog( &opener );
+  catalog.refresh( d, 2 );
+  check( catalog.size() == 4 && catalog.entries()[0].marks == 0, "query catalog" );
+
+  {
+    lsfData::TimeWindowQuery query( catalog, 1050., 1120.05, lsfData::TimeWindowQuery::Met, 1., &opener );
+    lsfData::MemoryEventSource::Record rec;
+    unsigned int n = 0;
+    bool inside = true, ordered = true;
+    double first = 0., last = 0.;
+    while ( query.readRecord( rec ) ) {
+      const double tm = query.time( rec );
+      inside = inside && tm >= 1050. && tm <= 1120.05;
+      ordered = ordered && ( n == 0 || tm > last );
+      if ( n == 0 ) first = tm;
+      last = tm;
+      n++;
+    }
+    check( n == 701 && inside && ordered && std::fabs( first - 1050. ) < 1e-6, "query met window" );
+    check( query.files() == 2 && query.skipped() > 0 && query.examined() < 1000, "query seeks" );
+  }
+
+  {
+    // 1050.5 to 1050.75 in packet time is 1050.0 to 1050.25 in event time
+    lsfData::TimeWindowQuery query( catalog, 1050.5, 1050.75, lsfData::TimeWindowQuery::Utc, 1., &opener );
+    lsfData::LsfCcsds ccsds;
+    lsfData::MetaEvent meta;
+    eventFile::EBF_Data ebf;
+    unsigned int n = 0;
+    bool decoded = true;
+    while ( query.read( ccsds, meta, ebf ) ) {
+      decoded = decoded && std::fabs( meta.time().met() + 0.5 - ccsds.getUtc() ) < 1e-6;
+      n++;
+    }
+    check( n == 3 && decoded && query.files() == 1 && query.opened() == 1, "query utc window" );
+  }
+
+  {
+    lsfData::TimeWindowQuery query( catalog, 5000., 5000.35, lsfData::TimeWindowQuery::Met, 0., &opener );
+    lsfData::MemoryEventSource::Record rec;
+    unsigned int n = 0;
+    while ( query.readRecord( rec ) ) n++;
+    check( n == 4 && query.opened() == 1 && query.examined() == 5, "query window at file start" );
+  }
+
+  {
+    // a source that cannot seek is read once from the start, never reopened
+    SequentialOpener sequential;
+    lsfData::TimeWindowQuery query( catalog, 1050., 1120.05, lsfData::TimeWindowQuery::Met, 1., &sequential );
+    lsfData::MemoryEventSource::Record rec;
+    unsigned int n = 0;
+    while ( query.readRecord( rec ) ) n++;
+    check( n == 701 && query.files() == 2 && query.opened() == query.files() && query.skipped() == 0,
+           "query without seeking" );
+  }
+
+  {
+    // a source that can tell() is marked by the catalog and seeks to a mark
+    MarkedOpener marked;
+    lsfData::RunCatalog markedCatalog( &marked );
+    markedCatalog.refresh( d, 2 );
+    const lsfData::RunCatalog::Entry& e = markedCatalog.entries()[0];
+    check( e.marks == lsfData::RunCatalog::MARKS && e.markAt[0] == 0 && e.markSec[0] == 1000 &&
+           e.markAt[1] == 64 && e.markSec[1] == 1006, "catalog marks" );
+    lsfData::TimeWindowQuery query( markedCatalog, 1050., 1120.05, lsfData::TimeWindowQuery::Met, 1., &marked );
+    lsfData::MemoryEventSource::Record rec;
+    unsigned int n = 0;
+    while ( query.readRecord( rec ) ) n++;
+    check( n == 701 && query.opened() == query.files() && query.skipped() == 0 && query.examined() < 800,
+           "query seeks to marks" );
+  }
+
+  {
+    // an event late by less than the margin is still found
+    lsfData::TimeWindowQuery query( catalog, 7000., 7005.05, lsfData::TimeWindowQuery::Met, 1., &opener );
+    lsfData::MemoryEventSource::Record rec;
+    unsigned int n = 0;
+    bool late = false;
+    while ( query.readRecord( rec ) ) {
+      late = late || rec.ctx.scalers.sequence == 51;
+      n++;
+    }
+    check( n == 51 && late, "query event out of order" );
+  }
+
+  {
+    lsfData::TimeWindowQuery query( catalog, 3000., 4000., lsfData::TimeWindowQuery::Met, 1., &opener );
+    lsfData::MemoryEventSource::Record rec;
+    check( query.files() == 0 && !query.readRecord( rec ) && query.opened() == 0, "query empty window" );
+  }
+
+  const char* names[] = { "f1.lsf", "f2.lsf", "f3.lsf", "f4.lsf" };
+  for ( unsigned int i=0; i<4; i++ ) unlink( ( d + "/" + names[i] ).c_str() );
+  rmdir( dir );
+#endif
+}
+
+static lsfData::GemScalers exposureScalers( double elapsed, double livetime,
+                                             unsigned long long deadzone, unsigned long long discarded )
+{
+  const double tps = lsfData::Time::TICKS_PER_SECOND;
+  return lsfData::GemScalers( static_cast< unsigned long long >( elapsed * tps + 0.5 ),
+                              static_cast< unsigned long long >( livetime * tps + 0.5 ),
+                              0, discarded, 0, deadzone );
+}
+
+static bool near( double a, double b ) { return std::fabs( a - b ) < 1e-6; }
+
+static void testExposureBinner()
+{
+  {
+    // a bin boundary halfway between two events splits the interval
+    lsfData::ExposureBinner binner( 10. );
+    binner.add( 5., exposureScalers( 100., 90., 10, 20 ) );
+    binner.add( 15., exposureScalers( 110., 99., 14, 22 ) );
+    check( binner.size() == 2 && near( binner.start( 0 ), 0. ) && near( binner.start( 1 ), 10. ),
+           "exposure bins" );
+    check( near( binner[0].elapsed, 5. ) && near( binner[0].livetime, 4.5 ) &&
+           near( binner[0].deadzone, 2. ) && near( binner[0].discarded, 1. ) && binner[0].events == 1 &&
+           near( binner[1].elapsed, 5. ) && near( binner[1].livetime, 4.5 ) && binner[1].events == 1,
+           "exposure split" );
+
+    // an event far earlier than the first grows the bins at the front
+    binner.restart();
+    binner.add( -25., exposureScalers( 0., 0., 0, 0 ) );
+    check( binner.size() == 5 && near( binner.start( 0 ), -30. ) && binner[0].events == 1 &&
+           binner[4].events == 1, "exposure bins before" );
+  }
+
+  {
+    // 32 bit scalers rolling over between two events
+    lsfData::ExposureBinner binner( 30., 0., 32 );
+    const unsigned long long top = 1ULL << 32;
+    binner.add( 100., lsfData::GemScalers( top - 100000000, top - 50000000, 0, 0, 0, 0 ) );
+    binner.add( 110., lsfData::GemScalers( 100000000, 120000000, 0, 0, 0, 0 ) );
+    const lsfData::ExposureBinner::Bin t = binner.total();
+    check( near( t.elapsed, 10. ) && near( t.livetime, 8.5 ) && binner.rejected() == 0, "exposure rollover" );
+
+    // scalers reset at a new run do not agree with the event times
+    binner.add( 111., lsfData::GemScalers( 0, 0, 0, 0, 0, 0 ) );
+    binner.add( 112., exposureScalers( 1., 0.5, 0, 0 ) );
+    check( binner.rejected() == 1 && binner.intervals() == 2 && near( binner.total().elapsed, 11. ),
+           "exposure reset" );
+  }
+
+  {
+    // two halves of a stream, the second started at the last event of the
+    // first, merge to the whole
+    lsfData::ExposureBinner whole( 30., 1000. ), first( 30., 1000. ), second( 30., 1000. );
+    double t = 1000., elapsed = 0., live = 0.;
+    unsigned long long dead = 0, discarded = 0;
+    const unsigned int n = 20000;
+    unsigned int state = 12345;
+    for ( unsigned int i=0; i<n; i++ ) {
+      state = state * 1103515245u + 12345u;
+      const double dt = 0.001 + ( state >> 16 ) % 1000 * 1.e-5;
+      t += dt;
+      elapsed += dt;
+      live += dt * 0.9;
+      dead += ( state >> 8 ) & 1;
+      discarded += ( state >> 9 ) & 1;
+      const lsfData::GemScalers s = exposureScalers( elapsed, live, dead, discarded );
+      whole.add( t, s );
+      if ( i < n / 2 ) first.add( t, s );
+      else second.add( t, s );
+      if ( i == n / 2 - 1 ) second.restart( t, s );
+    }
+    check( first.merge( second ), "exposure merge" );
+    bool same = first.size() == whole.size();
+    for ( size_t i=0; same && i<whole.size(); i++ ) {
+      same = near( first[i].elapsed, whole[i].elapsed ) && near( first[i].livetime, whole[i].livetime ) &&
+        near( first[i].deadzone, whole[i].deadzone ) && near( first[i].discarded, whole[i].discarded );
+    }
+    check( same && first.total().events == n && whole.total().events == n &&
+           first.intervals() == whole.intervals(), "exposure merged bins" );
+    const lsfData::ExposureBinner::Bin total = whole.total();
+    check( std::fabs( total.elapsed - ( t - 1000. - 0.001 ) ) < 0.01 &&
+           std::fabs( total.deadzone - dead ) < 2. && whole.intervals() == n - 1, "exposure totals" );
+
+    lsfData::ExposureBinner other( 60., 1000. );
+    check( !first.merge( other ), "exposure merge mismatch" );
+  }
+
+  {
+    // a zero or garbled time among real ones touches no bin
+    lsfData::ExposureBinner binner( 30. );
+    const double met = 3.e8;
+    binner.add( met, exposureScalers( 100., 90., 0, 0 ) );
+    binner.add( 0., exposureScalers( 0., 0., 0, 0 ) );
+    binner.add( std::log( -1. ), exposureScalers( 0., 0., 0, 0 ) );
+    binner.add( 1.e300, exposureScalers( 0., 0., 0, 0 ) );
+    binner.add( met + 10., exposureScalers( 110., 99., 0, 0 ) );
+    check( binner.size() == 1 && binner.outside() == 3 && binner.total().events == 2 &&
+           binner.intervals() == 1 && binner.rejected() == 0 && near( binner.total().elapsed, 10. ),
+           "exposure times outside" );
+  }
+}
+
+int main() {
+  testSequenceMonitor();
+  testDiagnostics();
+  testMemoryEventSource();
+  testTimeToneCache();
+  testContextObserver();
+  testEventRange();
+  testFormatter();
+  testEventExporter();
+  testEbfIndex();
+  testPackedMetaEvent();
+  testReadAhead();
+  testDecompressor();
+  testMetaEventSnapshot();
+  testEventQueue();
+  testEventPool();
+  testRunCatalog();
+  testTimeWindowQuery();
+  testExposureBinner();
+  testBufferArena();
+  testNuma();
+
+  if ( failures ) {
+    printf( "%d check(s) failed\n", failures );
+    return 1;
+  }
+  printf( "all checks passed\n" );
+  return 0;
 }